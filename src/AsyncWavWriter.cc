@@ -0,0 +1,215 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "AsyncWavWriter.hh"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <limits>
+
+using namespace fmsynth;
+
+
+AsyncWavWriter::AsyncWavWriter()
+  : _is_open(false),
+    _channels(1),
+    _written(0),
+    _submitted(0),
+    _writer_channels(1),
+    _filename(""),
+    _read(0),
+    _samples(Capacity),
+    _commands(64),
+    _high_water_mark(0),
+    _dropped_blocks(0),
+    _failed_files(0),
+    _handled(0),
+    _notifications(0),
+    _thread([this](std::stop_token stop) { Run(stop); })
+{
+}
+
+
+AsyncWavWriter::~AsyncWavWriter()
+{
+  _thread.request_stop();
+  Notify();
+  _thread.join();
+}
+
+
+void AsyncWavWriter::Open(const std::string & filename, unsigned int samples_per_second, unsigned int channels, WavWriter::Format format)
+{
+  assert(channels > 0);
+  if(_is_open)
+    Close();
+
+  if(!_commands.Push(Command { Command::Type::Open, _written, filename, samples_per_second, channels, format }))
+    {
+      _failed_files++;
+      return;
+    }
+  _submitted++;
+  _is_open = true;
+  _channels = channels;
+  Notify();
+}
+
+
+bool AsyncWavWriter::IsOpen() const
+{
+  return _is_open;
+}
+
+
+void AsyncWavWriter::Write(const double * samples, size_t frames)
+{
+  assert(_is_open);
+  auto count = frames * _channels;
+  if(!_samples.Push(samples, count))
+    {
+      _dropped_blocks.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  _written += count;
+  _submitted += count;
+
+  auto waiting = _samples.GetSize();
+  if(waiting > _high_water_mark.load(std::memory_order_relaxed))
+    _high_water_mark.store(waiting, std::memory_order_relaxed);
+}
+
+
+void AsyncWavWriter::Close()
+{
+  assert(_is_open);
+  _is_open = false;
+  if(!_commands.Push(Command { Command::Type::Close, _written, "", 0, 0, WavWriter::Format::PCM16 }))
+    {
+      _failed_files++;
+      return;
+    }
+  _submitted++;
+  Notify();
+}
+
+
+void AsyncWavWriter::Wait()
+{
+  Notify();
+  while(_handled.load(std::memory_order_acquire) < _submitted)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+
+size_t AsyncWavWriter::GetHighWaterMark() const
+{
+  return _high_water_mark;
+}
+
+
+size_t AsyncWavWriter::GetDroppedBlocks() const
+{
+  return _dropped_blocks;
+}
+
+
+size_t AsyncWavWriter::GetFailedFiles() const
+{
+  return _failed_files;
+}
+
+
+void AsyncWavWriter::Notify()
+{
+  _notifications.fetch_add(1, std::memory_order_release);
+  _notifications.notify_one();
+}
+
+
+void AsyncWavWriter::Run(std::stop_token stop)
+{
+  while(true)
+    {
+      auto notifications = _notifications.load(std::memory_order_acquire);
+      if(stop.stop_requested())
+        break;
+      Drain();
+
+      // While a file is open the samples keep coming, they are written every now and then. Otherwise
+      // there is nothing to do until the next file is opened:
+      if(_writer.IsOpen())
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      else
+        _notifications.wait(notifications, std::memory_order_acquire);
+    }
+  Drain();
+  if(_writer.IsOpen() && !_writer.Close())
+    {
+      std::cerr << "Error, failed to write '" << _filename << "'." << std::endl;
+      _failed_files++;
+    }
+}
+
+
+void AsyncWavWriter::Drain()
+{
+  double buffer[1024];
+  while(true)
+    {
+      // The samples are written up to the position of the next command:
+      auto command = _commands.GetFront();
+      auto end = command ? command->position : std::numeric_limits<size_t>::max();
+      while(_read < end)
+        {
+          auto count = _samples.Pop(buffer, std::min(std::size(buffer) - std::size(buffer) % _writer_channels, end - _read));
+          if(count == 0)
+            break;
+          if(_writer.IsOpen())
+            _writer.Write(buffer, count / _writer_channels);
+          _read += count;
+          _handled.fetch_add(count, std::memory_order_release);
+        }
+      if(!command || _read < command->position)
+        return;
+
+      switch(command->type)
+        {
+        case Command::Type::Open:
+          if(_writer.IsOpen() && !_writer.Close())
+            {
+              std::cerr << "Error, failed to write '" << _filename << "'." << std::endl;
+              _failed_files++;
+            }
+          std::cout << "Writing " << command->filename << std::endl;
+          _filename = command->filename;
+          _writer_channels = command->channels;
+          if(!_writer.Open(command->filename, command->samples_per_second, command->channels, command->format))
+            {
+              std::cerr << "Error, failed to open '" << command->filename << "' for writing." << std::endl;
+              _failed_files++;
+            }
+          break;
+        case Command::Type::Close:
+          if(_writer.IsOpen() && !_writer.Close())
+            {
+              std::cerr << "Error, failed to write '" << _filename << "'." << std::endl;
+              _failed_files++;
+            }
+          break;
+        }
+      _commands.PopFront();
+      _handled.fetch_add(1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef ASYNC_WAV_WRITER_HH_
+#define ASYNC_WAV_WRITER_HH_
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "RingBuffer.hh"
+#include "WavWriter.hh"
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace fmsynth
+{
+  // Writes WAV files in a thread of its own.
+  //
+  // The samples and the requests to open and close the files are queued in lock-free ring buffers,
+  // which the writer thread drains. None of the calls wait for the file I/O, so they can be made
+  // from the audio thread. When the writer thread falls behind and the samples do not fit in the
+  // ring buffer, the whole block is dropped and counted.
+  class AsyncWavWriter
+  {
+  public:
+    static constexpr size_t Capacity = 256 * 1024; // Samples, about 5 seconds of 48kHz mono.
+
+    AsyncWavWriter();
+    AsyncWavWriter(const AsyncWavWriter & src)             = delete;
+    AsyncWavWriter(AsyncWavWriter && src)                  = delete;
+    ~AsyncWavWriter(); // Writes the queued samples and closes the file.
+
+    AsyncWavWriter & operator=(const AsyncWavWriter & rhs) = delete;
+    AsyncWavWriter & operator=(AsyncWavWriter && rhs)      = delete;
+
+    // Open() copies the filename, the rest of the calls do not allocate memory.
+    void               Open(const std::string & filename, unsigned int samples_per_second, unsigned int channels = 1, WavWriter::Format format = WavWriter::Format::PCM16);
+    [[nodiscard]] bool IsOpen() const; // Whether Open() has been called without Close(), the file may not be open yet.
+    void               Write(const double * samples, size_t frames);
+    void               Close();
+    void               Wait(); // Blocks until the writer thread has handled all the calls made so far.
+
+    [[nodiscard]] size_t GetHighWaterMark() const; // The most samples that have been waiting to be written.
+    [[nodiscard]] size_t GetDroppedBlocks() const;
+    [[nodiscard]] size_t GetFailedFiles() const;   // The files which could not be opened or written.
+
+  private:
+    struct Command
+    {
+      enum class Type { Open, Close };
+      Type              type;
+      size_t            position; // The command is handled after this many samples have been written.
+      std::string       filename;
+      unsigned int      samples_per_second;
+      unsigned int      channels;
+      WavWriter::Format format;
+    };
+
+    // Caller thread data:
+    bool                _is_open;
+    unsigned int        _channels;
+    size_t              _written;   // The samples queued.
+    size_t              _submitted; // The samples and the commands queued.
+
+    // Writer thread data:
+    WavWriter           _writer;
+    unsigned int        _writer_channels;
+    std::string         _filename;
+    size_t              _read;
+
+    // Communication between threads:
+    RingBuffer<double>  _samples;
+    RingBuffer<Command> _commands;
+    std::atomic<size_t> _high_water_mark;
+    std::atomic<size_t> _dropped_blocks;
+    std::atomic<size_t> _failed_files;
+    std::atomic<size_t> _handled;       // The samples written and the commands handled by the writer thread.
+    std::atomic<size_t> _notifications; // Wakes up the writer thread when it waits for a file to be opened.
+    std::jthread        _thread;
+
+    void Run(std::stop_token stop);
+    void Drain();
+    void Notify();
+  };
+}
+
+#endif
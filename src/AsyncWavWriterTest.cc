@@ -0,0 +1,116 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "AsyncWavWriter.hh"
+#include "Test.hh"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+
+static std::vector<unsigned char> ReadFile(const std::string & filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+
+// The samples of a 16 bit mono file:
+static std::vector<int16_t> GetSamples(const std::vector<unsigned char> & data)
+{
+  std::vector<int16_t> rv;
+  for(size_t i = 44; i + 1 < data.size(); i += 2)
+    rv.push_back(static_cast<int16_t>(data[i] | data[i + 1] << 8));
+  return rv;
+}
+
+
+static void Test()
+{
+  auto directory = std::filesystem::temp_directory_path();
+  auto filename1 = (directory / "AsyncWavWriterTest1.wav").string();
+  auto filename2 = (directory / "AsyncWavWriterTest2.wav").string();
+
+  {
+    // Two files written one after the other, without waiting for the first one to be written:
+    fmsynth::AsyncWavWriter writer;
+    std::vector<double> block(256);
+    writer.Open(filename1, 48000);
+    for(unsigned int i = 0; i < 100; i++)
+      {
+        std::fill(block.begin(), block.end(), (i % 10) * 0.1);
+        writer.Write(block.data(), block.size());
+      }
+    writer.Close();
+    testAssert("The file is closed without waiting.", !writer.IsOpen());
+
+    writer.Open(filename2, 48000);
+    std::fill(block.begin(), block.end(), -0.5);
+    writer.Write(block.data(), 100);
+    writer.Close();
+    writer.Wait();
+
+    auto samples1 = GetSamples(ReadFile(filename1));
+    auto samples2 = GetSamples(ReadFile(filename2));
+    bool ok = samples1.size() == 100 * 256 && samples2.size() == 100;
+    for(size_t i = 0; ok && i < samples1.size(); i++)
+      ok = samples1[i] == std::lround(static_cast<double>(i / 256 % 10) * 0.1 * 32767.0);
+    for(size_t i = 0; ok && i < samples2.size(); i++)
+      ok = samples2[i] == std::lround(-0.5 * 32767.0);
+    testComment << "samples: " << samples1.size() << ", " << samples2.size() << ", high water mark: " << writer.GetHighWaterMark() << "\n";
+    testAssert("The samples are written to the files they were queued for.", ok);
+    testAssert("No blocks are dropped.", writer.GetDroppedBlocks() == 0 && writer.GetFailedFiles() == 0);
+    testAssert("High water mark is set.", writer.GetHighWaterMark() >= 100 && writer.GetHighWaterMark() <= 100 * 256 + 100);
+  }
+
+  {
+    // A block which does not fit in the ring buffer is dropped, the blocks around it are written:
+    fmsynth::AsyncWavWriter writer;
+    std::vector<double> block(fmsynth::AsyncWavWriter::Capacity + 1, 0.25);
+    writer.Open(filename1, 48000);
+    writer.Write(block.data(), 10);
+    writer.Write(block.data(), block.size());
+    writer.Write(block.data(), 10);
+    writer.Close();
+    writer.Wait();
+    testAssert("Block which does not fit is dropped.", writer.GetDroppedBlocks() == 1 && GetSamples(ReadFile(filename1)).size() == 20);
+  }
+
+  {
+    fmsynth::AsyncWavWriter writer;
+    writer.Open("/nonexistent/directory/AsyncWavWriterTest.wav", 48000);
+    double sample = 0;
+    writer.Write(&sample, 1);
+    writer.Close();
+    writer.Wait();
+    testAssert("File which can not be created is counted as failed.", writer.GetFailedFiles() == 1);
+  }
+
+  {
+    // The destructor writes what is queued:
+    {
+      fmsynth::AsyncWavWriter writer;
+      std::vector<double> block(1000, 0.5);
+      writer.Open(filename1, 48000);
+      writer.Write(block.data(), block.size());
+    }
+    testAssert("Queued samples are written when the writer is destroyed.", GetSamples(ReadFile(filename1)).size() == 1000);
+  }
+
+  std::filesystem::remove(filename1);
+  std::filesystem::remove(filename2);
+}
@@ -14,6 +14,8 @@
 #include "Blueprint.hh"
 #include "NodeAudioDeviceOutput.hh"
 #include "RtAudio.hh"
+#include <algorithm>
+#include <cassert>
 #include <print>
 
 
@@ -34,8 +36,15 @@ static RtAudio * GetSystemDAC()
 
 AudioDevice::AudioDevice(int device_id)
   : _on_post_tick(nullptr),
-    _current_sample(0),
-    _blueprint(nullptr)    
+    _blueprint(nullptr),
+    _stream_samples_per_second(0),
+    _current(nullptr),
+    _fading(nullptr),
+    _fade_position(0),
+    _fade_buffer(1024),
+    _next(nullptr),
+    _retired(64),
+    _crossfade_frames(0)
 {
   _dac = GetSystemDAC();
   UpdateDeviceNames();
@@ -59,6 +68,7 @@ void AudioDevice::SetDeviceId(int device_id)
 
 AudioDevice::~AudioDevice()
 {
+  Stop();
   delete _dac;
 }
 
@@ -71,20 +81,94 @@ const std::vector<unsigned int> & AudioDevice::GetSampleRates() const
 
 void AudioDevice::Playback(double * output_buffer, unsigned int frame_count)
 {
-  if(!_blueprint || _nodes.empty())
-    return;
-  
-  std::lock_guard lock(_blueprint->GetLockMutex());
-  
-  for(unsigned i = 0; !_blueprint->IsFinished() && i < frame_count; i++)
+  // Switch to the next program. The previous programs are passed back, unless there is no room for them:
+  if(_next.load(std::memory_order_relaxed) && _retired.GetSize() + 2 <= _retired.GetCapacity())
     {
-      _current_sample = 0;
-      _blueprint->Tick(1);
-      *output_buffer++ = _current_sample;
+      auto next = _next.exchange(nullptr, std::memory_order_acquire);
+      if(next)
+        {
+          if(_fading)
+            Retire(_fading);
+          _fading = nullptr;
+
+          bool crossfade = _crossfade_frames.load(std::memory_order_relaxed) > 0 && _current && _current->blueprint && next->blueprint != _current->blueprint;
+          if(crossfade)
+            {
+              _fading = _current;
+              _fade_position = 0;
+            }
+          else if(_current)
+            Retire(_current);
+          _current = next;
+        }
+    }
 
-      if(_on_post_tick)
-        _on_post_tick(_current_sample);
+  for(unsigned int done = 0; done < frame_count;)
+    {
+      auto output = output_buffer + done;
+      auto frames = static_cast<unsigned int>(std::min(static_cast<size_t>(frame_count - done), _fade_buffer.size()));
+      auto rendered = Render(_current, output, frames);
+
+      if(_fading)
+        {
+          rendered = std::max(rendered, Render(_fading, _fade_buffer.data(), frames));
+          auto length = static_cast<double>(_crossfade_frames.load(std::memory_order_relaxed));
+          for(unsigned int i = 0; i < frames; i++)
+            {
+              double gain = std::min(static_cast<double>(_fade_position + i) / length, 1.0);
+              output[i] = gain * output[i] + (1.0 - gain) * _fade_buffer[i];
+            }
+          _fade_position += frames;
+          if(_fade_position >= length || _fading->blueprint->IsFinished())
+            {
+              Retire(_fading);
+              _fading = nullptr;
+            }
+        }
+
+      if(_on_post_tick && rendered > 0)
+        _on_post_tick(output, rendered);
+      done += frames;
+    }
+}
+
+
+unsigned int AudioDevice::Render(Program * program, double * output, unsigned int frame_count)
+{
+  // The audio thread does not wait for the editor, silence is played while the editor holds the lock, and
+  // until the editor has compiled the program after changing the links:
+  unsigned int frames = 0;
+  if(program && program->blueprint)
+    {
+      std::unique_lock lock(program->blueprint->GetLockMutex(), std::try_to_lock);
+      if(lock.owns_lock() && program->blueprint->HasProgram())
+        {
+          if(program->reset_time)
+            {
+              program->blueprint->ResetTime();
+              program->reset_time = false;
+            }
+          frames = static_cast<unsigned int>(program->blueprint->Render(output, frame_count));
+        }
     }
+  std::fill(output + frames, output + frame_count, 0.0);
+  return frames;
+}
+
+
+void AudioDevice::Retire(Program * program)
+{
+  [[maybe_unused]] bool ok = _retired.Push(program);
+  assert(ok); // Playback() does not switch programs unless there is room.
+}
+
+
+void AudioDevice::CollectGarbage()
+{
+  std::lock_guard lock(_garbage_mutex);
+  Program * program;
+  while(_retired.Pop(&program, 1) > 0)
+    delete program;
 }
 
 
@@ -106,40 +190,60 @@ void AudioDevice::SetOnPostTick(on_post_tick_t callback)
 }
 
 
+void AudioDevice::SetCrossfadeFrames(unsigned int frames)
+{
+  _crossfade_frames = frames;
+}
+
+
 void AudioDevice::Play(std::shared_ptr<fmsynth::Blueprint> blueprint)
 {
   _blueprint = blueprint;
   UpdateInputNodes();
 
-  if(!_blueprint)
-    return;
-  
-  _blueprint->ResetTime();
-  
+  if(blueprint)
+    { // Compile the program here instead of in the audio thread:
+      std::lock_guard lock(blueprint->GetLockMutex());
+      blueprint->UpdateProgram();
+    }
+
+  if(blueprint && _dac->isStreamOpen() && _stream_samples_per_second != blueprint->GetSamplesPerSecond())
+    Stop();
+  if(!_dac->isStreamOpen())
+    {
+      if(!blueprint)
+        return;
+      OpenStream(blueprint->GetSamplesPerSecond());
+    }
+
+  // A program which the audio thread has not picked up yet is replaced:
+  delete _next.exchange(new Program { blueprint }, std::memory_order_acq_rel);
+}
+
+
+void AudioDevice::OpenStream(unsigned int samples_per_second)
+{
   RtAudio::StreamParameters parameters;
   parameters.nChannels    = 1;
   parameters.firstChannel = 0;
   parameters.deviceId     = _device_id;
 
   unsigned int bframes = 1024;
-  auto rc = _dac->openStream(&parameters, nullptr, RTAUDIO_FLOAT64, _blueprint->GetSamplesPerSecond(), &bframes,
-                             [](void *                  outputBuffer,
-                                [[maybe_unused]] void * inputBuffer,
-                                unsigned int            nBufferFrames,
-                                [[maybe_unused]] double streamTime,
-                                RtAudioStreamStatus     status,
-                                void *                  userData) -> int
+  auto rc = _dac->openStream(&parameters, nullptr, RTAUDIO_FLOAT64, samples_per_second, &bframes,
+                             [](void *                                outputBuffer,
+                                [[maybe_unused]] void *               inputBuffer,
+                                unsigned int                          nBufferFrames,
+                                [[maybe_unused]] double               streamTime,
+                                [[maybe_unused]] RtAudioStreamStatus  status,
+                                void *                                userData) -> int
                              {
-                               if(status)
-                                 return 1;
-
                                auto * self = reinterpret_cast<AudioDevice *>(userData);
                                self->Playback(static_cast<double *>(outputBuffer), nBufferFrames);
-                               if(self->GetBlueprint()->IsFinished())
-                                 return 1;
                                return 0;
                              },
                              this);
+  _stream_samples_per_second = samples_per_second;
+  _fade_buffer.resize(std::max(bframes, static_cast<unsigned int>(_fade_buffer.size())));
   if(rc == RTAUDIO_NO_ERROR)
     rc = _dac->startStream();
 
@@ -148,12 +252,17 @@ void AudioDevice::Play(std::shared_ptr<fmsynth::Blueprint> blueprint)
 }
 
 
-
-
 void AudioDevice::Stop()
 {
   if(_dac->isStreamOpen())
     _dac->closeStream();
+
+  // The audio thread is stopped, release everything:
+  for(auto program : { _current, _fading, _next.exchange(nullptr) })
+    delete program;
+  _current = nullptr;
+  _fading = nullptr;
+  CollectGarbage();
 }
 
 
@@ -167,14 +276,6 @@ void AudioDevice::UpdateInputNodes()
   auto ados = _blueprint->GetNodesByType("AudioDeviceOutput");
   for(auto n : ados)
     _nodes.push_back(dynamic_cast<fmsynth::NodeAudioDeviceOutput *>(n));
-
-  for(auto n : _nodes)
-    n->SetOnPlaySample(
-                       [this](double sample)
-                       {
-                         _current_sample += sample;
-                       }
-                       );
 }
 
 
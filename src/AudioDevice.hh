@@ -12,8 +12,11 @@
   Complete license can be found in the LICENSE file.
 */
 
+#include "RingBuffer.hh"
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -29,15 +32,19 @@ class RtAudio;
 class AudioDevice
 {
 public:
-  typedef std::function<void(double sample)> on_post_tick_t;
+  typedef std::function<void(const double * samples, unsigned int frame_count)> on_post_tick_t; // Called once for each rendered block.
 
   AudioDevice(int device_id);
   ~AudioDevice();
 
   void SetDeviceId(int device_id); // -1 for the default device
   void SetOnPostTick(on_post_tick_t callback);
+  // The stream is kept open, the audio thread switches to the blueprint at the start of the next buffer.
+  // nullptr plays silence. The stream is reopened only if the sample rate of the blueprint differs.
   void Play(std::shared_ptr<fmsynth::Blueprint> blueprint);
-  void Stop();
+  void Stop(); // Closes the stream.
+  void SetCrossfadeFrames(unsigned int frames); // The length of the crossfade from one blueprint to another, 0 to switch immediately.
+  void CollectGarbage(); // Frees the blueprints which the audio thread is done with, call it every now and then.
 
   [[nodiscard]] std::string                                         GetDeviceName()      const;
   [[nodiscard]] std::string                                         GetDeviceName(unsigned int device_id) const;
@@ -51,17 +58,41 @@ public:
   void Playback(double * output_buffer, unsigned int frame_count);
  
 private:
+  // The blueprints are passed to the audio thread in these, the audio thread does not release the blueprints
+  // but passes them back through _retired:
+  struct Program
+  {
+    std::shared_ptr<fmsynth::Blueprint> blueprint;
+    bool                                reset_time = true; // The time is reset when the audio thread first gets the lock.
+  };
+
+  // Caller thread data:
   RtAudio *                 _dac;
   unsigned int              _device_id;
   std::vector<unsigned int> _device_ids;
   std::vector<unsigned int> _sample_rates;
   on_post_tick_t            _on_post_tick;
-  double                    _current_sample;
   std::shared_ptr<fmsynth::Blueprint>           _blueprint;
   std::vector<fmsynth::NodeAudioDeviceOutput *> _nodes;
+  unsigned int              _stream_samples_per_second;
+  std::mutex                _garbage_mutex;
+
+  // Audio thread data:
+  Program *                 _current;
+  Program *                 _fading;        // The previous program while it is faded out.
+  unsigned int              _fade_position;
+  std::vector<double>       _fade_buffer;
+
+  // Communication between threads:
+  std::atomic<Program *>        _next;
+  fmsynth::RingBuffer<Program *> _retired;
+  std::atomic<unsigned int>     _crossfade_frames;
 
   void UpdateInputNodes();
   void UpdateDeviceNames();
+  void OpenStream(unsigned int samples_per_second);
+  void Retire(Program * program);
+  [[nodiscard]] unsigned int Render(Program * program, double * output, unsigned int frame_count);
 };
 
 #endif
@@ -11,28 +11,43 @@
 */
 
 #include "Blueprint.hh"
+#include "NodeAudioDeviceOutput.hh"
 #include "NodeConstant.hh"
 #include "NodeGrowth.hh"
 #include <algorithm>
 #include <cassert>
 #include <queue>
+#include <unordered_set>
 
 using namespace fmsynth;
 
 
 Blueprint::Blueprint()
   : _root(new NodeConstant),
+    _nodes_sorted(false),
+    _removed_node(nullptr),
     _time_index(0),
-    _samples_per_second(44100)
+    _samples_per_second(44100),
+    _block_size(256),
+    _control_period(1),
+    _thread_pool(nullptr),
+    _graph_revision(1),
+    _program_graph_revision(0),
+    _slots_graph_revision(0),
+    _parameter_changes(1024)
 {
-  _root->GetValue() = ConstantValue(1, ConstantValue::Unit::Absolute);
+  _root->SetValue(ConstantValue(1, ConstantValue::Unit::Absolute));
   ConnectNodes(Node::Channel::Form, nullptr, Node::Channel::Form, _root);
   _root->SetSamplesPerSecond(_samples_per_second);
+  _root->SetEOFDeferred(true);
 }
 
 
 Blueprint::~Blueprint()
 {
+  for(auto n : _nodes)
+    if(n)
+      n->SetBlueprint(nullptr); // The shared nodes can outlive the blueprint.
   delete _root;
 }
 
@@ -44,16 +59,23 @@ void Blueprint::AddNode(std::shared_ptr<Node> node)
   
   _shared_nodes.push_back(node);
   _nodes.push_back(node.get());
+  _nodes_by_id.try_emplace(node->GetId(), node.get());
+  node->SetBlueprint(this);
 
   if(dynamic_cast<NodeConstant *>(node.get()) || dynamic_cast<NodeGrowth *>(node.get()))
     ConnectNodes(Node::Channel::Form, _root, Node::Channel::Form, node.get());
 
   node->SetSamplesPerSecond(_samples_per_second);
+  node->SetEOFDeferred(true);
 }
 
 
 void Blueprint::RemoveNode(Node * node)
 {
+  ApplyParameterChanges(); // The queued changes may refer to the node.
+  node->SetEOFDeferred(false);
+
+  _removed_node = node;
   {
     std::vector<Node::Channel> channels
       {
@@ -65,30 +87,31 @@ void Blueprint::RemoveNode(Node * node)
       {
         auto inp = node->GetInput(channel);
         if(inp)
-          for(auto n : inp->GetInputNodes())
+          for(auto n : std::vector(inp->GetInputNodes())) // Copy, disconnecting modifies the list.
             if(n)
               for(auto nc : channels)
                 DisconnectNodes(nc, n, channel, node);
         auto out = node->GetOutput(channel);
         if(out)
-          for(auto n : out->GetOutputNodes())
+          for(auto n : std::vector(out->GetOutputNodes()))
             if(n)
               for(auto nc : channels)
                 DisconnectNodes(channel, node, nc, n);
       }
   }
-  
+  _removed_node = nullptr;
   
   auto it = std::find(_nodes.cbegin(), _nodes.cend(), node);
   if(it != _nodes.cend())
     _nodes.erase(it);
+  node->SetBlueprint(nullptr);
+  OnNodeIdChanged(node, node->GetId());
+  UpdateExecutionOrderOnRemove(node);
 
   for(unsigned int i = 0; i < _shared_nodes.size(); i++)
     if(_shared_nodes[i])
       if(_shared_nodes[i].get() == node)
         _shared_nodes[i].reset();
-
-  ResetExecutionOrder();
 }
 
 
@@ -106,6 +129,14 @@ void Blueprint::ResetTime()
 void Blueprint::ResetExecutionOrder()
 {
   _nodes_sorted = false;
+  ResetProgram();
+}
+
+
+void Blueprint::ResetProgram()
+{
+  _program.reset();
+  _program_nodes.clear();
 }
 
 
@@ -115,15 +146,52 @@ Node * Blueprint::GetRoot() const
 }
 
 
+void Blueprint::SetNodeId(Node * node, const std::string & id)
+{
+  assert(HasNode(node));
+  node->SetId(id);
+}
+
+
+void Blueprint::OnNodeIdChanged(Node * node, const std::string & old_id)
+{
+  // The index has the first node of each id, another node may have the old id:
+  auto it = _nodes_by_id.find(old_id);
+  if(it != _nodes_by_id.end() && it->second == node)
+    {
+      _nodes_by_id.erase(it);
+      for(auto n : _nodes)
+        if(n && n != node && n->GetId() == old_id)
+          {
+            _nodes_by_id.try_emplace(old_id, n);
+            break;
+          }
+    }
+  if(node->GetBlueprint() == this)
+    _nodes_by_id.try_emplace(node->GetId(), node);
+}
+
+
 Node * Blueprint::GetNode(const std::string & id) const
 {
-  for(auto n : _nodes)
-    if(n && n->GetId() == id)
-      return n;
+  auto it = _nodes_by_id.find(id);
+  if(it != _nodes_by_id.cend())
+    return it->second;
   return nullptr;
 }
 
 
+bool Blueprint::HasNode(const Node * node) const
+{
+  if(!node)
+    return false;
+  if(GetNode(node->GetId()) == node)
+    return true;
+  // Only the first of the nodes with the same id is in the index:
+  return std::find(_nodes.cbegin(), _nodes.cend(), node) != _nodes.cend();
+}
+
+
 std::vector<Node *> Blueprint::GetAllNodes() const
 {
   std::vector<Node *> nodes;
@@ -150,13 +218,48 @@ std::vector<Node *> Blueprint::GetNodesByType(const std::string & type) const
 
 void Blueprint::SetIsFinished()
 {
-  _root->SetIsFinished();
+  _root->SetIsFinished(_time_index - 1); // No more frames are rendered.
+  FlushEOF();
+}
+
+
+void Blueprint::FlushEOF()
+{
+  _root->FlushEOF();
+  for(auto n : _nodes)
+    if(n)
+      n->FlushEOF();
 }
 
 
 bool Blueprint::IsFinished() const
 {
-  return _root->IsFinished();
+  // The control rate steps are run up to a period ahead of the frames being rendered, the end raised
+  // by one of them is reached when the frames get to it:
+  return _root->IsFinished() && _root->GetFinishedTimeIndex() < _time_index;
+}
+
+
+long Blueprint::GetHistoryLength()
+{
+  // The history of a node adds up with the longest history of its inputs:
+  SortNodesToExecutionOrder();
+  std::unordered_map<const Node *, long> histories;
+  long rv = 0;
+  for(auto node : _exec_nodes)
+    {
+      auto history = node->GetHistoryLength();
+      if(history < 0)
+        return -1;
+      long longest = 0;
+      for(auto channel : Node::AllChannels)
+        for(auto source : node->GetInput(channel)->GetInputNodes())
+          if(auto it = histories.find(source); it != histories.cend())
+            longest = std::max(longest, it->second);
+      histories[node] = history + longest;
+      rv = std::max(rv, history + longest);
+    }
+  return rv;
 }
 
 
@@ -166,9 +269,40 @@ std::mutex & Blueprint::GetLockMutex()
 }
 
 
+bool Blueprint::PostParameterChange(const ParameterChange & change)
+{
+  return _parameter_changes.Push(change);
+}
+
+
+void Blueprint::ApplyParameterChanges()
+{
+  for(auto change = _parameter_changes.GetFront(); change; change = _parameter_changes.GetFront())
+    {
+      change->Apply();
+      _parameter_changes.PopFront();
+    }
+}
+
+
+bool Blueprint::HasParameterChanges() const
+{
+  return _parameter_changes.GetSize() > 0;
+}
+
+
+void Blueprint::Seek(long time_index)
+{
+  assert(time_index >= 0);
+  ResetTime();
+  _time_index = time_index;
+}
+
+
 void Blueprint::Tick(long samples)
 {
   assert(samples > 0);
+  ApplyParameterChanges();
   SortNodesToExecutionOrder();
   for(int i = 0; !IsFinished() && i < samples; i++)
     {
@@ -180,6 +314,214 @@ void Blueprint::Tick(long samples)
       
       _time_index++;
     }
+
+  if(IsFinished())
+    FlushEOF();
+}
+
+
+size_t Blueprint::Render(double * output, size_t frames)
+{
+  Blueprint * voice = this;
+  size_t done = 0;
+  RenderVoices(&voice, 1, &output, &done, frames);
+  return done;
+}
+
+
+void Blueprint::RenderVoices(Blueprint * const * voices, unsigned int count, double * const * outputs, size_t * rendered, size_t frames)
+{
+  assert(count > 0);
+  auto block_size = voices[0]->_block_size;
+  thread_local std::vector<unsigned int>  running;
+  thread_local std::vector<Node * const *> nodes;
+  thread_local std::vector<long>          times;
+  thread_local std::vector<sample_t *>    slots;
+
+  std::fill_n(rendered, count, 0);
+  for(size_t done = 0; done < frames; done += block_size)
+    {
+      auto blockframes = static_cast<unsigned int>(std::min(frames - done, static_cast<size_t>(block_size)));
+
+      // The changes to the parameters can change the values of the folded nodes:
+      running.clear();
+      for(unsigned int v = 0; v < count; v++)
+        {
+          auto voice = voices[v];
+          assert(voice->_block_size == block_size);
+          if(voice->IsFinished())
+            continue;
+          voice->ApplyParameterChanges();
+          if(!voice->_program)
+            voice->UpdateProgram();
+          else if(voice->_slots_graph_revision != voice->_graph_revision)
+            { // The program itself is checked by UpdateProgram() in the editing thread:
+              voice->_slots_graph_revision = voice->_graph_revision;
+              voice->_program->UpdateFoldedSlots(voice->_program_nodes.data(), voice->_program_slots.data(), block_size);
+            }
+          assert(voice->_program);
+          running.push_back(v);
+        }
+      if(running.empty())
+        break;
+
+      // The voices which share a program are run together:
+      for(size_t first = 0; first < running.size();)
+        {
+          auto program = voices[running[first]]->_program.get();
+          auto end = first;
+          for(auto i = first; i < running.size(); i++)
+            if(voices[running[i]]->_program.get() == program)
+              std::swap(running[i], running[end++]);
+
+          nodes.clear();
+          times.clear();
+          slots.clear();
+          for(auto i = first; i < end; i++)
+            {
+              auto voice = voices[running[i]];
+              nodes.push_back(voice->_program_nodes.data());
+              times.push_back(voice->_time_index);
+              slots.push_back(voice->_program_slots.data());
+            }
+          program->RunVoices(nodes.data(), times.data(), static_cast<unsigned int>(nodes.size()), blockframes, slots.data(), block_size, voices[running[first]]->_thread_pool);
+          first = end;
+        }
+
+      for(auto v : running)
+        {
+          auto voice = voices[v];
+          auto voiceframes = blockframes;
+          // The frames after the frame where the blueprint finished are discarded:
+          if(voice->_root->IsFinished())
+            voiceframes = static_cast<unsigned int>(std::clamp(voice->_root->GetFinishedTimeIndex() - voice->_time_index + 1, 0l, static_cast<long>(blockframes)));
+
+          auto out = outputs[v] + done;
+          std::fill_n(out, voiceframes, 0.0);
+          for(auto [node, slot] : voice->_program->GetAudioOutputs())
+            {
+              auto volume = static_cast<NodeAudioDeviceOutput *>(voice->_program_nodes[node])->GetVolume();
+              auto samples = voice->_program_slots.data() + slot * block_size;
+              for(unsigned int i = 0; i < voiceframes; i++)
+                out[i] += volume * ToDouble(samples[i]);
+            }
+
+          voice->_time_index += voiceframes;
+          rendered[v] += voiceframes;
+        }
+    }
+
+  for(unsigned int v = 0; v < count; v++)
+    if(voices[v]->IsFinished())
+      voices[v]->FlushEOF();
+}
+
+
+void Blueprint::UpdateProgram()
+{
+  SortNodesToExecutionOrder();
+  if(_program && _program_graph_revision != _graph_revision)
+    {
+      _program_graph_revision = _graph_revision;
+      if(!_program->IsCurrent(_program_nodes.data()))
+        ResetProgram();
+    }
+  if(!_program)
+    {
+      [[maybe_unused]] auto ok = UseProgram(std::make_shared<BlueprintProgram>(_root, _exec_nodes, _control_period, _thread_pool != nullptr));
+      assert(ok);
+    }
+}
+
+
+std::shared_ptr<const BlueprintProgram> Blueprint::GetProgram()
+{
+  UpdateProgram();
+  return _program;
+}
+
+
+bool Blueprint::HasProgram() const
+{
+  return _program != nullptr;
+}
+
+
+bool Blueprint::UseProgram(std::shared_ptr<const BlueprintProgram> program)
+{
+  assert(program);
+
+  std::vector<Node *> nodes { _root };
+  for(unsigned int i = 1; i < program->GetNodeCount(); i++)
+    {
+      auto node = GetNode(program->GetNodeId(i));
+      if(!node || node->GetNodeType() != program->GetNodeType(i))
+        return false;
+      nodes.push_back(node);
+    }
+  if(program->GetControlPeriod() != _control_period || !program->IsCurrent(nodes.data()))
+    return false;
+
+  _program = program;
+  _program_nodes = nodes;
+  _program_graph_revision = _graph_revision;
+  _slots_graph_revision = _graph_revision;
+  _program_slots.resize(_program->GetSlotCount() * _block_size);
+  _program->PrepareSlots(_program_slots.data(), _block_size);
+  _program->UpdateFoldedSlots(_program_nodes.data(), _program_slots.data(), _block_size); // The program can come from another blueprint.
+
+  return true;
+}
+
+
+void Blueprint::SetBlockSize(unsigned int frames)
+{
+  assert(frames > 0);
+  _block_size = std::min(frames, MaxBlockSize);
+
+  if(_program)
+    {
+      _program_slots.resize(_program->GetSlotCount() * _block_size);
+      _program->PrepareSlots(_program_slots.data(), _block_size);
+      _slots_graph_revision = 0; // The folded slots are updated by the next Render().
+    }
+}
+
+
+unsigned int Blueprint::GetBlockSize() const
+{
+  return _block_size;
+}
+
+
+void Blueprint::SetControlPeriod(unsigned int frames)
+{
+  assert(frames > 0);
+  if(frames == _control_period)
+    return;
+
+  _control_period = frames;
+  ResetProgram();
+}
+
+
+unsigned int Blueprint::GetControlPeriod() const
+{
+  return _control_period;
+}
+
+
+void Blueprint::SetThreadPool(ThreadPool * pool)
+{
+  if((pool != nullptr) != (_thread_pool != nullptr))
+    ResetProgram(); // The slots of a parallel program are laid out differently.
+  _thread_pool = pool;
+}
+
+
+ThreadPool * Blueprint::GetThreadPool() const
+{
+  return _thread_pool;
 }
 
 
@@ -199,21 +541,10 @@ bool Blueprint::Load(const json11::Json & json)
 
   if(json["links"].is_array())
     {
-      auto links = json["links"].array_items();
-
-      auto FindNodeById = [this](const std::string & node_id) -> Node *
-      {
-        for(auto n : _nodes)
-          if(n)
-            if(n->GetId() == node_id)
-              return n;
-        return nullptr;
-      };
-      
-      for(auto l : links)
+      for(const auto & l : json["links"].array_items())
         {
-          auto from_node = FindNodeById(l["from"].string_value());
-          auto to_node   = FindNodeById(l["to"].string_value());
+          auto from_node = GetNode(l["from"].string_value());
+          auto to_node   = GetNode(l["to"].string_value());
           if(from_node && to_node)
             ConnectNodes(Node::Channel::Form,                                   from_node,
                          Node::StringToChannel(l["to_channel"].string_value()), to_node);
@@ -224,6 +555,37 @@ bool Blueprint::Load(const json11::Json & json)
 }
 
 
+bool Blueprint::LoadCopy(const Blueprint & source)
+{
+  std::unordered_map<const Node *, Node *> copies { { nullptr, nullptr }, { source._root, _root } };
+  std::vector<std::shared_ptr<Node>> nodes;
+  for(auto node : source._nodes)
+    if(node)
+      {
+        auto copy = node->Clone();
+        if(!copy)
+          return false;
+        copies[node] = copy.get();
+        nodes.push_back(copy);
+      }
+  for(const auto & node : nodes)
+    AddNode(node);
+
+  // The inputs are linked in the same order as in the source. AddNode() has already made the first links, from the root:
+  for(auto node : source._nodes)
+    if(node)
+      for(auto channel : Node::AllChannels)
+        {
+          auto to_node = copies.at(node);
+          const auto & from_nodes = node->GetInput(channel)->GetInputNodes();
+          for(auto i = to_node->GetInput(channel)->GetInputNodes().size(); i < from_nodes.size(); i++)
+            ConnectNodes(Node::Channel::Form, copies.at(from_nodes[i]), channel, to_node);
+        }
+
+  return true;
+}
+
+
 
 void Blueprint::SetSamplesPerSecond(unsigned int samples_per_second)
 {
@@ -251,48 +613,218 @@ void Blueprint::SortNodesToExecutionOrder()
     return;
 
   _exec_nodes.clear();
+  _exec_positions.clear();
+  _unscheduled_nodes.clear();
 
   // Topological sort using Kahn's algorithm (https://en.wikipedia.org/wiki/Topological_sorting#Kahn's_algorithm).
-  std::vector<int> nodes_input_counts; // Index in this vector match with _nodes index.
+  // The links are followed from the output lists of the nodes, so the sort is linear in the number of links.
+  std::unordered_map<Node *, size_t> input_counts;
   for(auto node : _nodes)
-    {
-      auto c =
-        node->GetInput(Node::Channel::Amplitude)->GetInputNodes().size() +
-        node->GetInput(Node::Channel::Form)->GetInputNodes().size()      +
-        node->GetInput(Node::Channel::Aux)->GetInputNodes().size();
-      nodes_input_counts.push_back(static_cast<int>(c));
-    }
-  
+    if(node)
+      {
+        size_t c = 0;
+        for(auto channel : Node::AllChannels)
+          for(auto n : node->GetInput(channel)->GetInputNodes())
+            if(n)
+              c++;
+        input_counts[node] = c;
+      }
+
   std::queue<Node *> work;
-  
-  for(auto node : _root->GetAllOutputNodes())
-    work.push(node);
+  auto ReleaseOutputNodes = [&input_counts, &work](Node * node)
+  {
+    for(auto channel : Node::AllChannels)
+      for(auto n : node->GetOutput(channel)->GetOutputNodes())
+        {
+          auto it = input_counts.find(n);
+          if(it != input_counts.end())
+            {
+              assert(it->second > 0);
+              if(--it->second == 0)
+                work.push(n);
+            }
+        }
+  };
 
+  ReleaseOutputNodes(_root);
   while(!work.empty())
     {
       auto node = work.front();
       work.pop();
 
+      _exec_positions[node] = _exec_nodes.size();
       _exec_nodes.push_back(node);
+      ReleaseOutputNodes(node);
+    }
 
-      for(unsigned int i = 0; i < _nodes.size(); i++)
-        {
-          auto cur = _nodes[i];
-          auto all = node->GetAllOutputNodes();
-          auto edge_exists = std::find(all.cbegin(), all.cend(), cur) != all.cend();
+  // The nodes which are not connected to the root are silent, but the connected ones which are left are in a cycle or after one:
+  std::unordered_set<Node *> connected;
+  std::vector<Node *> stack { _root };
+  while(!stack.empty())
+    {
+      auto node = stack.back();
+      stack.pop_back();
+      for(auto channel : Node::AllChannels)
+        for(auto n : node->GetOutput(channel)->GetOutputNodes())
+          if(connected.insert(n).second)
+            stack.push_back(n);
+    }
+  for(auto node : _nodes)
+    if(node && connected.contains(node) && !_exec_positions.contains(node))
+      _unscheduled_nodes.push_back(node);
 
-          if(edge_exists)
-            {
-              nodes_input_counts[i]--;
-              assert(nodes_input_counts[i] >= 0);
+  _nodes_sorted = true;
+}
 
-              if(nodes_input_counts[i] == 0)
-                work.push(cur);
-            }
-        }
+
+const std::vector<Node *> & Blueprint::GetUnscheduledNodes()
+{
+  SortNodesToExecutionOrder();
+  return _unscheduled_nodes;
+}
+
+
+void Blueprint::UpdateExecutionOrderOnConnect(Node * from_node, Node * to_node)
+{
+  ResetProgram();
+  if(!_nodes_sorted)
+    return;
+
+  // Changes in the set of the executed nodes need the full sort, the order of the executed nodes can be fixed locally:
+  auto to = _exec_positions.find(to_node);
+  if(to == _exec_positions.end())
+    {
+      ResetExecutionOrder();
+      return;
+    }
+  if(from_node == _root)
+    return;
+  auto from = _exec_positions.find(from_node);
+  if(from == _exec_positions.end())
+    {
+      ResetExecutionOrder();
+      return;
     }
+  if(from->second > to->second)
+    if(!ReorderForLink(from_node, to_node))
+      ResetExecutionOrder();
+}
 
-  _nodes_sorted = true;
+
+void Blueprint::UpdateExecutionOrderOnDisconnect(Node * from_node, Node * to_node)
+{
+  ResetProgram();
+  if(!_nodes_sorted)
+    return;
+
+  if(to_node == _removed_node)
+    return;
+
+  // Removing a link keeps the order valid, unless the set of the executed nodes changes:
+  bool to_is_executed = _exec_positions.contains(to_node);
+  bool from_is_executed = from_node == _root || _exec_positions.contains(from_node);
+  if(!to_is_executed || !from_is_executed)
+    {
+      ResetExecutionOrder();
+      return;
+    }
+
+  bool has_inputs = false;
+  for(auto channel : Node::AllChannels)
+    for(auto n : to_node->GetInput(channel)->GetInputNodes())
+      if(n)
+        has_inputs = true;
+  if(!has_inputs)
+    ResetExecutionOrder();
+}
+
+
+void Blueprint::UpdateExecutionOrderOnRemove(Node * node)
+{
+  ResetProgram();
+  if(!_nodes_sorted)
+    return;
+
+  // The links are removed already, so the node affects only the positions of the nodes after it:
+  auto it = _exec_positions.find(node);
+  if(it == _exec_positions.end())
+    {
+      std::erase(_unscheduled_nodes, node);
+      return;
+    }
+
+  auto position = it->second;
+  _exec_positions.erase(it);
+  _exec_nodes.erase(_exec_nodes.begin() + static_cast<long>(position));
+  for(auto i = position; i < _exec_nodes.size(); i++)
+    _exec_positions[_exec_nodes[i]] = i;
+}
+
+
+bool Blueprint::ReorderForLink(Node * from_node, Node * to_node)
+{
+  // The link goes backwards in the execution order. Following Pearce and Kelly, the nodes between the two
+  // positions which depend on to_node and the nodes which from_node depends on are collected, and their
+  // positions are reassigned, with the dependencies first. The rest of the order is not touched.
+  auto lower = _exec_positions.at(to_node);
+  auto upper = _exec_positions.at(from_node);
+  std::unordered_set<Node *> visited;
+
+  std::vector<Node *> forward;
+  std::vector<Node *> stack { to_node };
+  visited.insert(to_node);
+  while(!stack.empty())
+    {
+      auto node = stack.back();
+      stack.pop_back();
+      forward.push_back(node);
+      for(auto channel : Node::AllChannels)
+        for(auto n : node->GetOutput(channel)->GetOutputNodes())
+          {
+            if(n == from_node)
+              return false; // Cycle.
+            auto it = _exec_positions.find(n);
+            if(it != _exec_positions.end() && it->second < upper && visited.insert(n).second)
+              stack.push_back(n);
+          }
+    }
+
+  std::vector<Node *> backward;
+  stack.push_back(from_node);
+  visited.insert(from_node);
+  while(!stack.empty())
+    {
+      auto node = stack.back();
+      stack.pop_back();
+      backward.push_back(node);
+      for(auto channel : Node::AllChannels)
+        for(auto n : node->GetInput(channel)->GetInputNodes())
+          {
+            auto it = _exec_positions.find(n);
+            if(it != _exec_positions.end() && it->second > lower && visited.insert(n).second)
+              stack.push_back(n);
+          }
+    }
+
+  auto ByPosition = [this](Node * a, Node * b) { return _exec_positions.at(a) < _exec_positions.at(b); };
+  std::sort(forward.begin(), forward.end(), ByPosition);
+  std::sort(backward.begin(), backward.end(), ByPosition);
+
+  std::vector<size_t> positions;
+  for(auto list : { &backward, &forward })
+    for(auto n : *list)
+      positions.push_back(_exec_positions.at(n));
+  std::sort(positions.begin(), positions.end());
+
+  auto position = positions.cbegin();
+  for(auto list : { &backward, &forward })
+    for(auto n : *list)
+      {
+        _exec_nodes[*position] = n;
+        _exec_positions[n] = *position;
+        position++;
+      }
+  return true;
 }
 
 
@@ -300,15 +832,18 @@ void Blueprint::ConnectNodes(Node::Channel from_channel, Node * from_node, Node:
 {
   assert(from_channel == Node::Channel::Form);
   if(from_node && from_node != _root)
-    assert(std::find(_nodes.cbegin(), _nodes.cend(), from_node) != _nodes.cend());
+    assert(HasNode(from_node));
   if(to_node != _root)
-    assert(std::find(_nodes.cbegin(), _nodes.cend(), to_node) != _nodes.cend());
+    assert(HasNode(to_node));
 
   to_node->AddInputNode(to_channel, from_node);
   if(from_node)
     from_node->AddOutputNode(to_channel, to_node);
 
-  ResetExecutionOrder();
+  if(from_node && to_node != _root)
+    UpdateExecutionOrderOnConnect(from_node, to_node);
+  else
+    ResetExecutionOrder();
 }
 
 
@@ -316,13 +851,16 @@ void Blueprint::DisconnectNodes([[maybe_unused]] Node::Channel from_channel, Nod
 {
   //  assert(from_channel == Node::Channel::Form);
   if(from_node && from_node != _root)
-    assert(std::find(_nodes.cbegin(), _nodes.cend(), from_node) != _nodes.cend());
+    assert(HasNode(from_node));
   if(to_node != _root)
-    assert(std::find(_nodes.cbegin(), _nodes.cend(), to_node) != _nodes.cend());
+    assert(HasNode(to_node));
 
   to_node->RemoveInputNode(to_channel, from_node);
   if(from_node)
     from_node->RemoveOutputNode(to_channel, to_node);
 
-  ResetExecutionOrder();
+  if(from_node && to_node != _root)
+    UpdateExecutionOrderOnDisconnect(from_node, to_node);
+  else
+    ResetExecutionOrder();
 }
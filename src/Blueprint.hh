@@ -12,13 +12,18 @@
   Complete license can be found in the LICENSE file.
 */
 
+#include "BlueprintProgram.hh"
 #include "Node.hh"
+#include "ParameterChange.hh"
+#include "RingBuffer.hh"
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace fmsynth
 {
   class NodeConstant;
+  class ThreadPool;
 
 
   class Blueprint
@@ -34,17 +39,58 @@ namespace fmsynth
     
     void Clear();
     [[nodiscard]] bool Load(const json11::Json & json);
+    // Load() the copies of the nodes and the links of another blueprint, fails if a node type can not be copied:
+    [[nodiscard]] bool LoadCopy(const Blueprint & source);
     
     void AddNode(std::shared_ptr<Node> node);
     void RemoveNode(Node * node);
+    void SetNodeId(Node * node, const std::string & id); // Same as node->SetId(id).
 
     void ConnectNodes(Node::Channel from_channel, Node * from_node, Node::Channel to_channel, Node * to_node);
     void DisconnectNodes(Node::Channel from_channel, Node * from_node, Node::Channel to_channel, Node * to_node);
     
     void ResetTime();
+    void Seek(long time_index); // ResetTime(), and continue from the given frame.
     void Tick(long samples);
+
+    // Render the mix of all AudioDeviceOutput nodes into output, processing the nodes one block at a time.
+    // Returns the number of frames rendered, which is less than frames if the blueprint finishes.
+    [[nodiscard]] size_t Render(double * output, size_t frames);
+    // Render() for several blueprints loaded from the same file, each into its own output. The blueprints which share
+    // a program are run together, one block at a time. The frames rendered for each blueprint are stored in rendered.
+    static void RenderVoices(Blueprint * const * voices, unsigned int count, double * const * outputs, size_t * rendered, size_t frames);
+
+    static constexpr unsigned int MaxBlockSize = 1024;
+    void                       SetBlockSize(unsigned int frames);
+    [[nodiscard]] unsigned int GetBlockSize() const;
+    // The slowly varying nodes which modulate other nodes are run once every this many frames by Render(), 1 runs them every frame:
+    void                       SetControlPeriod(unsigned int frames);
+    [[nodiscard]] unsigned int GetControlPeriod() const;
+    // Render() runs the independent nodes in the threads of the pool, nullptr runs all the nodes in the calling thread.
+    // The output is the same. The pool is not owned by the blueprint.
+    void                       SetThreadPool(ThreadPool * pool);
+    [[nodiscard]] ThreadPool * GetThreadPool() const;
+
+    // The program used by Render(), it can be shared with other blueprints loaded from the same file. Using a program
+    // fails if the node ids or types, or the control periods do not match. UpdateProgram() checks the program after
+    // the edits, and compiles a new one if needed. It is called by the thread editing the blueprint: Render() follows
+    // only the changes of the parameters of the folded nodes, and compiles a program only if there is none.
+    void                                                  UpdateProgram();
+    [[nodiscard]] std::shared_ptr<const BlueprintProgram> GetProgram(); // UpdateProgram(), and return the program.
+    [[nodiscard]] bool                                    UseProgram(std::shared_ptr<const BlueprintProgram> program);
+    [[nodiscard]] bool                                    HasProgram() const; // Render() does not need to compile one.
     void SetIsFinished();
     [[nodiscard]] bool IsFinished() const;
+    // How many frames back the output depends on, -1 if there is no limit. Rendering can start from any frame
+    // after Seek(), and it produces the same output as rendering from the start after this many frames.
+    [[nodiscard]] long GetHistoryLength();
+
+    // The changes to the parameters of the nodes are queued by the editor while the blueprint is played, and applied
+    // at the start of the next block by Render() and Tick(). ApplyParameterChanges() is called only by the thread
+    // holding GetLockMutex(), so that the audio thread does not need to wait for the editor to set the parameters.
+    [[nodiscard]] bool PostParameterChange(const ParameterChange & change); // Fails if the queue is full.
+    void               ApplyParameterChanges();
+    [[nodiscard]] bool HasParameterChanges() const;
     
     void                       SetSamplesPerSecond(unsigned int samples_per_second);
     [[nodiscard]] unsigned int GetSamplesPerSecond() const;
@@ -52,23 +98,49 @@ namespace fmsynth
     [[nodiscard]] std::mutex & GetLockMutex();
     [[nodiscard]] Node *       GetRoot() const;
     [[nodiscard]] Node *       GetNode(const std::string & id) const;
+    [[nodiscard]] bool         HasNode(const Node * node) const;
     [[nodiscard]] std::vector<Node *> GetAllNodes() const;
     [[nodiscard]] std::vector<Node *> GetNodesByType(const std::string & type) const;
+    // The nodes which are connected to the root but are not executed, because they are in a cycle or get input from one:
+    [[nodiscard]] const std::vector<Node *> & GetUnscheduledNodes();
     
   protected:
     void SortNodesToExecutionOrder();
 
   private:
+    friend class Node; // For OnNodeIdChanged() and _graph_revision.
+
     NodeConstant *      _root;
     std::vector<std::shared_ptr<Node>> _shared_nodes; // Both _nodes and _shared_nodes contain the same pointers.
     std::vector<Node *> _nodes;
+    std::unordered_map<std::string, Node *> _nodes_by_id; // Updated by Node::SetId() through OnNodeIdChanged().
     std::vector<Node *> _exec_nodes;
+    std::unordered_map<Node *, size_t> _exec_positions; // Index of the node in _exec_nodes.
+    std::vector<Node *> _unscheduled_nodes;
     bool                _nodes_sorted;
+    Node *              _removed_node; // The node being removed by RemoveNode(), its own links do not change the execution order.
     std::mutex          _lock_mutex;
     long                _time_index;
     unsigned int        _samples_per_second;
+    unsigned int        _block_size;
+    unsigned int        _control_period;
+    ThreadPool *        _thread_pool;
+    std::shared_ptr<const BlueprintProgram> _program;
+    std::vector<Node *>                     _program_nodes;  // The nodes in the order of the program node indices.
+    std::vector<sample_t>                   _program_slots;
+    unsigned long                           _graph_revision;         // Changed by Node::InvalidateGraph() of the nodes of the blueprint.
+    unsigned long                           _program_graph_revision; // _graph_revision when the program was last checked.
+    unsigned long                           _slots_graph_revision;   // _graph_revision when the folded slots were last updated.
+    RingBuffer<ParameterChange>             _parameter_changes;
 
     void ResetExecutionOrder();
+    void ResetProgram();
+    void UpdateExecutionOrderOnConnect(Node * from_node, Node * to_node);
+    void UpdateExecutionOrderOnDisconnect(Node * from_node, Node * to_node);
+    void UpdateExecutionOrderOnRemove(Node * node);
+    [[nodiscard]] bool ReorderForLink(Node * from_node, Node * to_node);
+    void OnNodeIdChanged(Node * node, const std::string & old_id);
+    void FlushEOF();
   };
 }
 
@@ -0,0 +1,716 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "BlueprintProgram.hh"
+#include "NodeAudioDeviceOutput.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstring>
+#include <unordered_map>
+
+using namespace fmsynth;
+
+
+BlueprintProgram::BlueprintProgram(Node * root, const std::vector<Node *> & exec_nodes, unsigned int control_period, bool parallel)
+  : _control_period(std::max(control_period, 1u)),
+    _control_time_slot(0),
+    _zero_slot(0),
+    _slot_count(0),
+    _parallel(parallel)
+{
+  std::vector<Node *> nodes { root };
+  nodes.insert(nodes.end(), exec_nodes.cbegin(), exec_nodes.cend());
+
+  std::unordered_map<const Node *, unsigned int> indices;
+  for(unsigned int i = 0; i < nodes.size(); i++)
+    {
+      indices[nodes[i]] = i;
+      _node_ids.push_back(nodes[i]->GetId());
+      _node_types.push_back(nodes[i]->GetNodeType());
+    }
+
+  // Only the nodes which have side effects, and the nodes they get input from, need to be run.
+  // Disabled nodes do not accept input, so they do not keep their inputs alive:
+  std::vector<bool> live(nodes.size(), false);
+  std::vector<unsigned int> pending;
+  for(unsigned int i = 0; i < nodes.size(); i++)
+    if(nodes[i]->HasSideEffects())
+      {
+        live[i] = true;
+        pending.push_back(i);
+      }
+  while(!pending.empty())
+    {
+      auto node = nodes[pending.back()];
+      pending.pop_back();
+      if(node->IsEnabled())
+        for(auto channel : Node::AllChannels)
+          for(auto source : node->GetInput(channel)->GetInputNodes())
+            if(auto it = indices.find(source); it != indices.cend() && !live[it->second])
+              {
+                live[it->second] = true;
+                pending.push_back(it->second);
+              }
+    }
+
+  // The stateless nodes whose inputs are all constant produce a constant, they are folded into constant slots:
+  std::vector<bool> folded(nodes.size(), false);
+  for(unsigned int i = 0; i < nodes.size(); i++)
+    if(live[i] && nodes[i]->IsStateless())
+      {
+        folded[i] = true;
+        if(nodes[i]->IsEnabled())
+          for(auto channel : Node::AllChannels)
+            for(auto source : nodes[i]->GetInput(channel)->GetInputNodes())
+              if(auto it = indices.find(source); it != indices.cend() && !folded[it->second])
+                folded[i] = false;
+      }
+
+  // The slowly varying nodes, and the stateless nodes computing from them, run at the control rate if their
+  // inputs do, except when they feed an audio output directly:
+  std::vector<bool> feeds_output(nodes.size(), false);
+  for(unsigned int i = 0; i < nodes.size(); i++)
+    if(live[i] && nodes[i]->HasSideEffects() && !nodes[i]->CanRunAtControlRate() && nodes[i]->IsEnabled())
+      for(auto channel : Node::AllChannels)
+        for(auto source : nodes[i]->GetInput(channel)->GetInputNodes())
+          if(auto it = indices.find(source); it != indices.cend())
+            feeds_output[it->second] = true;
+
+  std::vector<bool> control(nodes.size(), false);
+  for(unsigned int i = 0; i < nodes.size(); i++)
+    if(_control_period > 1 && live[i] && !folded[i] && !feeds_output[i] && (nodes[i]->CanRunAtControlRate() || nodes[i]->IsStateless()))
+      {
+        control[i] = true;
+        if(nodes[i]->IsEnabled())
+          for(auto channel : Node::AllChannels)
+            for(auto source : nodes[i]->GetInput(channel)->GetInputNodes())
+              if(auto it = indices.find(source); it != indices.cend() && !control[it->second] && !folded[it->second])
+                control[i] = false;
+      }
+
+  // The control rate nodes read by the nodes running at the audio rate are interpolated for them:
+  std::vector<bool> interpolated(nodes.size(), false);
+  for(unsigned int i = 0; i < nodes.size(); i++)
+    if(live[i] && !folded[i] && !control[i] && nodes[i]->IsEnabled())
+      for(auto channel : Node::AllChannels)
+        for(auto source : nodes[i]->GetInput(channel)->GetInputNodes())
+          if(auto it = indices.find(source); it != indices.cend() && control[it->second])
+            interpolated[it->second] = true;
+
+  for(unsigned int i = 0; i < nodes.size(); i++)
+    {
+      _enabled.push_back(nodes[i]->IsEnabled());
+      if(i == 0) // The root node is not reported.
+        continue;
+      if(!live[i])
+        _dead_nodes.push_back(i);
+      else if(folded[i])
+        _folded_nodes.push_back(i);
+    }
+
+  // The output slot of a node is released after the last step reading it, except for
+  // the audio outputs which are read after the program has been run, and for the
+  // folded and control rate nodes whose slots hold values between the runs.
+  // The slots of a parallel program are not reused, the steps of a level run at the same time:
+  std::vector<unsigned int> last_use(nodes.size());
+  for(unsigned int i = 0; i < nodes.size(); i++)
+    {
+      last_use[i] = i;
+      if(dynamic_cast<NodeAudioDeviceOutput *>(nodes[i]) || folded[i] || control[i])
+        last_use[i] = UINT_MAX;
+    }
+  for(unsigned int i = 0; i < nodes.size(); i++)
+    if(live[i] && !folded[i] && !control[i] && nodes[i]->IsEnabled())
+      for(auto channel : Node::AllChannels)
+        for(auto source : nodes[i]->GetInput(channel)->GetInputNodes())
+          if(auto it = indices.find(source); it != indices.cend() && last_use[it->second] != UINT_MAX)
+            last_use[it->second] = std::max(last_use[it->second], i);
+
+  std::vector<std::vector<unsigned int>> release_after(nodes.size());
+  for(unsigned int i = 0; i < nodes.size(); i++)
+    if(live[i] && last_use[i] != UINT_MAX && !_parallel)
+      release_after[last_use[i]].push_back(i);
+
+  std::vector<unsigned int> free_slots;
+  auto AllocateSlot = [this, &free_slots]() -> unsigned int
+  {
+    if(free_slots.empty())
+      return _slot_count++;
+    auto slot = free_slots.back();
+    free_slots.pop_back();
+    return slot;
+  };
+  auto ConstantSlot = [this](double value) -> unsigned int
+  {
+    for(auto [slot, v] : _constants)
+      if(!(v < value) && !(v > value))
+        return slot;
+    _constants.push_back({ _slot_count, value });
+    return _slot_count++;
+  };
+
+  std::array<unsigned int, Node::AllChannels.size()> scratch_slots;
+  for(auto & slot : scratch_slots)
+    slot = _slot_count++;
+  if(_control_period > 1)
+    { // The time is a long, which takes the room of two float samples in the slots of one frame:
+      _control_time_slot = _slot_count;
+      _slot_count += 2;
+    }
+  _zero_slot = ConstantSlot(0);
+
+  std::vector<unsigned int> output_slots(nodes.size());  // The slots read by the nodes running at the audio rate.
+  std::vector<unsigned int> control_slots(nodes.size()); // The slots read by the nodes running at the control rate.
+  std::vector<unsigned int> steps(nodes.size(), NoStep); // The index of the step of the node in _steps.
+  for(unsigned int i = 0; i < nodes.size(); i++)
+    {
+      if(!live[i])
+        continue;
+
+      auto node = nodes[i];
+      Step step;
+      step.node = i;
+
+      for(auto channel : Node::AllChannels)
+        {
+          auto ind = static_cast<unsigned int>(channel);
+          auto input = node->GetInput(channel);
+          auto & stepinput = step.inputs[ind];
+          stepinput.multiply = channel == Node::Channel::Amplitude;
+          stepinput.step = NoStep;
+
+          if(input->GetInputNodes().empty())
+            {
+              stepinput.slot = ConstantSlot(input->GetDefaultValue());
+              continue;
+            }
+          if(!node->IsEnabled())
+            { // Disabled nodes do not accept input.
+              stepinput.slot = ConstantSlot(0);
+              continue;
+            }
+
+          // The sources are combined in the execution order to match the order the values are pushed in Node::FinishFrame():
+          std::vector<std::tuple<unsigned int, const Node *>> sources;
+          for(auto source : input->GetInputNodes())
+            if(auto it = indices.find(source); it != indices.cend())
+              sources.push_back({ it->second, source });
+          std::stable_sort(sources.begin(), sources.end(),
+                           [](const auto & a, const auto & b) { return std::get<0>(a) < std::get<0>(b); });
+
+          for(auto [sourceind, source] : sources)
+            {
+              auto [scale, offset] = input->GetNormalization(source);
+              _normalizations.push_back({ i, channel, sourceind, scale, offset });
+            }
+
+          auto & source_slots = control[i] ? control_slots : output_slots;
+          if(sources.empty())
+            stepinput.slot = ConstantSlot(0);
+          else if(sources.size() == 1 && input->IsNormalizationIdentity(std::get<1>(sources[0])))
+            {
+              stepinput.slot = source_slots[std::get<0>(sources[0])];
+              stepinput.step = steps[std::get<0>(sources[0])];
+            }
+          else
+            {
+              stepinput.slot = _parallel && !control[i] && !folded[i] ? _slot_count++ : scratch_slots[ind];
+              for(auto [sourceind, source] : sources)
+                {
+                  auto [scale, offset] = input->GetNormalization(source);
+                  stepinput.sources.push_back({ source_slots[sourceind], scale, offset, steps[sourceind] });
+                }
+            }
+        }
+
+      if(folded[i])
+        {
+          step.output_slot = _slot_count++;
+          output_slots[i] = step.output_slot;
+          control_slots[i] = step.output_slot;
+          _folded_steps.push_back(step);
+          continue;
+        }
+      if(control[i])
+        {
+          step.output_slot = _slot_count++;
+          control_slots[i] = step.output_slot;
+          _control_steps.push_back(step);
+          if(interpolated[i])
+            {
+              ControlOutput output { _slot_count, step.output_slot, _slot_count + 1 };
+              _slot_count += 2;
+              output_slots[i] = output.output_slot;
+              _control_outputs.push_back(output);
+            }
+          continue;
+        }
+
+      step.output_slot = AllocateSlot();
+      output_slots[i] = step.output_slot;
+      if(dynamic_cast<NodeAudioDeviceOutput *>(node))
+        _audio_outputs.push_back({ i, step.output_slot });
+
+      steps[i] = static_cast<unsigned int>(_steps.size());
+      _steps.push_back(step);
+
+      for(auto released : release_after[i])
+        free_slots.push_back(output_slots[released]);
+    }
+
+  // The level of a step is one more than the highest level of the steps it reads from:
+  std::vector<unsigned int> levels(_steps.size(), 0);
+  for(unsigned int s = 0; s < _steps.size(); s++)
+    {
+      for(const auto & input : _steps[s].inputs)
+        {
+          if(input.step != NoStep)
+            levels[s] = std::max(levels[s], levels[input.step] + 1);
+          for(const auto & source : input.sources)
+            if(source.step != NoStep)
+              levels[s] = std::max(levels[s], levels[source.step] + 1);
+        }
+      if(levels[s] >= _levels.size())
+        _levels.resize(levels[s] + 1);
+      _levels[levels[s]].push_back(s);
+    }
+
+  auto values = EvaluateFoldedSteps(nodes.data());
+  for(unsigned int i = 0; i < _folded_steps.size(); i++)
+    _constants.push_back({ _folded_steps[i].output_slot, values[i] });
+}
+
+
+const std::vector<BlueprintProgram::Step> & BlueprintProgram::GetSteps() const
+{
+  return _steps;
+}
+
+
+const std::vector<BlueprintProgram::AudioOutput> & BlueprintProgram::GetAudioOutputs() const
+{
+  return _audio_outputs;
+}
+
+
+unsigned int BlueprintProgram::GetSlotCount() const
+{
+  return _slot_count;
+}
+
+
+unsigned int BlueprintProgram::GetNodeCount() const
+{
+  return static_cast<unsigned int>(_node_ids.size());
+}
+
+
+const std::string & BlueprintProgram::GetNodeId(unsigned int node) const
+{
+  assert(node < _node_ids.size());
+  return _node_ids[node];
+}
+
+
+const std::string & BlueprintProgram::GetNodeType(unsigned int node) const
+{
+  assert(node < _node_types.size());
+  return _node_types[node];
+}
+
+
+const std::vector<unsigned int> & BlueprintProgram::GetFoldedNodes() const
+{
+  return _folded_nodes;
+}
+
+
+const std::vector<unsigned int> & BlueprintProgram::GetDeadNodes() const
+{
+  return _dead_nodes;
+}
+
+
+bool BlueprintProgram::IsCurrent(Node * const * nodes) const
+{
+  for(unsigned int i = 0; i < _enabled.size(); i++)
+    if(nodes[i]->IsEnabled() != _enabled[i])
+      return false;
+
+  for(const auto & n : _normalizations)
+    {
+      auto [scale, offset] = nodes[n.node]->GetInput(n.channel)->GetNormalization(nodes[n.source]);
+      if(scale < n.scale || scale > n.scale || offset < n.offset || offset > n.offset)
+        return false;
+    }
+
+  // The values of the folded nodes are not compiled into the steps, UpdateFoldedSlots() follows their changes.
+  return true;
+}
+
+
+std::vector<double> BlueprintProgram::EvaluateFoldedSteps(Node * const * nodes) const
+{
+  // The folded steps are run once, for a single frame:
+  std::vector<sample_t> slots(_slot_count);
+  PrepareSlots(slots.data(), 1);
+  for(const auto & step : _folded_steps)
+    RunStep(nodes, step, 0, 1, slots.data(), 1);
+
+  std::vector<double> values;
+  for(const auto & step : _folded_steps)
+    values.push_back(ToDouble(slots[step.output_slot]));
+  return values;
+}
+
+
+unsigned int BlueprintProgram::GetControlPeriod() const
+{
+  return _control_period;
+}
+
+
+bool BlueprintProgram::IsParallel() const
+{
+  return _parallel;
+}
+
+
+const std::vector<std::vector<unsigned int>> & BlueprintProgram::GetLevels() const
+{
+  return _levels;
+}
+
+
+const std::vector<BlueprintProgram::Step> & BlueprintProgram::GetControlSteps() const
+{
+  return _control_steps;
+}
+
+
+void BlueprintProgram::PrepareSlots(sample_t * slots, unsigned int stride) const
+{
+  for(auto [slot, value] : _constants)
+    std::fill_n(slots + slot * stride, stride, ToSample(value));
+  if(_control_period > 1)
+    { // No control point has been evaluated:
+      long none = -1;
+      std::memcpy(slots + _control_time_slot * stride, &none, sizeof none);
+    }
+}
+
+
+void BlueprintProgram::UpdateFoldedSlots(Node * const * nodes, sample_t * slots, unsigned int stride) const
+{
+  // The folded steps read only the constant slots, the scratch slots and the outputs of the earlier folded steps:
+  for(const auto & step : _folded_steps)
+    {
+      RunStep(nodes, step, 0, 1, slots, stride);
+      auto output = slots + step.output_slot * stride;
+      std::fill_n(output + 1, stride - 1, output[0]);
+    }
+}
+
+
+void BlueprintProgram::Run(Node * const * nodes, long time_index, unsigned int frames, sample_t * slots, unsigned int stride, ThreadPool * pool) const
+{
+  RunVoices(&nodes, &time_index, 1, frames, &slots, stride, pool);
+}
+
+
+void BlueprintProgram::RunVoices(Node * const * const * nodes, const long * time_indices, unsigned int voices, unsigned int frames, sample_t * const * slots, unsigned int stride,
+                                 ThreadPool * pool) const
+{
+  assert(frames <= stride);
+
+  auto step_count = _steps.size();
+  thread_local std::vector<unsigned char> states;
+  states.assign(voices * step_count, 0);
+  for(unsigned int v = 0; v < voices; v++)
+    {
+      if(!_control_steps.empty())
+        RunControlSteps(nodes[v], time_indices[v], frames, slots[v], stride);
+      FindNeededSteps(nodes[v], frames, slots[v], stride, states.data() + v * step_count);
+    }
+
+  if(!_parallel || !pool || pool->GetThreadCount() < 2)
+    {
+      for(unsigned int s = 0; s < step_count; s++)
+        RunStepForVoices(nodes, s, states.data(), time_indices, voices, frames, slots, stride);
+      return;
+    }
+
+  // The steps of a level do not read each other's output, nor share slots. Only the steps which can
+  // finish the blueprint touch the other nodes, they are run after the others:
+  thread_local std::vector<unsigned int> parallel;
+  thread_local std::vector<unsigned int> serial;
+  const unsigned char * step_states = states.data();
+  for(const auto & level : _levels)
+    {
+      parallel.clear();
+      serial.clear();
+      for(auto s : level)
+        {
+          bool can_finish = false;
+          for(unsigned int v = 0; v < voices && !can_finish; v++)
+            can_finish = nodes[v][_steps[s].node]->CanFinish();
+          (can_finish ? serial : parallel).push_back(s);
+        }
+
+      if(parallel.size() > 1 && static_cast<size_t>(frames) * voices * parallel.size() >= ParallelMinWork)
+        {
+          const unsigned int * tasks = parallel.data();
+          pool->Run(static_cast<unsigned int>(parallel.size()), [&, tasks](unsigned int i)
+          {
+            RunStepForVoices(nodes, tasks[i], step_states, time_indices, voices, frames, slots, stride);
+          });
+        }
+      else
+        for(auto s : parallel)
+          RunStepForVoices(nodes, s, step_states, time_indices, voices, frames, slots, stride);
+
+      for(auto s : serial)
+        RunStepForVoices(nodes, s, step_states, time_indices, voices, frames, slots, stride);
+    }
+}
+
+
+void BlueprintProgram::RunStepForVoices(Node * const * const * nodes, unsigned int step_index, const unsigned char * states, const long * time_indices, unsigned int voices,
+                                        unsigned int frames, sample_t * const * slots, unsigned int stride) const
+{
+  // The node of the step is run for all the voices together:
+  const auto & step = _steps[step_index];
+  auto step_count = _steps.size();
+  thread_local std::vector<unsigned int> running;
+  running.clear();
+  for(unsigned int v = 0; v < voices; v++)
+    {
+      auto state = states[v * step_count + step_index];
+      auto node = nodes[v][step.node];
+      if(!(state & Needed))
+        node->SkipBlock();
+      else if(!(state & Silent))
+        running.push_back(v);
+      else if(node->HasSideEffects())
+        RunStep(nodes[v], step, time_indices[v], frames, slots[v], stride, true);
+      else
+        {
+          node->SkipBlock();
+          std::fill_n(slots[v] + step.output_slot * stride, frames, sample_t(0));
+        }
+    }
+
+  if(running.size() == 1)
+    RunStep(nodes[running[0]], step, time_indices[running[0]], frames, slots[running[0]], stride);
+  else if(running.size() > 1)
+    RunStepVoices(nodes, step, running, time_indices, frames, slots, stride);
+}
+
+
+void BlueprintProgram::FindNeededSteps(Node * const * nodes, unsigned int frames, const sample_t * slots, unsigned int stride, unsigned char * states) const
+{
+  // Find the silent steps, and then the steps whose output is needed, in reverse order:
+  for(unsigned int s = 0; s < _steps.size(); s++)
+    {
+      const auto & step = _steps[s];
+      if(nodes[step.node]->IsSilent() || IsSilent(step.inputs[static_cast<unsigned int>(Node::Channel::Amplitude)], states, frames, slots, stride))
+        states[s] |= Silent;
+    }
+
+  for(unsigned int s = static_cast<unsigned int>(_steps.size()); s-- > 0;)
+    {
+      const auto & step = _steps[s];
+      auto node = nodes[step.node];
+      if(node->HasSideEffects())
+        states[s] |= Needed;
+      if(!(states[s] & Needed) || ((states[s] & Silent) && !node->HasSideEffects()))
+        continue;
+
+      for(auto channel : Node::AllChannels)
+        if(channel == Node::Channel::Amplitude || !(states[s] & Silent))
+          {
+            const auto & input = step.inputs[static_cast<unsigned int>(channel)];
+            if(input.step != NoStep)
+              states[input.step] |= Needed;
+            for(const auto & source : input.sources)
+              if(source.step != NoStep)
+                states[source.step] |= Needed;
+          }
+    }
+}
+
+
+bool BlueprintProgram::IsSilent(const StepInput & input, const unsigned char * states, unsigned int frames, const sample_t * slots, unsigned int stride) const
+{
+  // The values of the slots written by the steps are not known yet, except when the step is silent:
+  auto IsKnownZero = [states](unsigned int step) { return step != NoStep && (states[step] & Silent); };
+
+  if(input.sources.empty())
+    {
+      if(input.step != NoStep)
+        return IsKnownZero(input.step);
+      auto values = slots + input.slot * stride;
+      return std::all_of(values, values + frames, [](sample_t v) { return !(v < 0) && !(v > 0); });
+    }
+
+  for(const auto & source : input.sources)
+    if(source.step != NoStep && !IsKnownZero(source.step))
+      return false;
+
+  for(unsigned int i = 0; i < frames; i++)
+    {
+      double value = input.multiply ? 1 : 0;
+      for(const auto & source : input.sources)
+        {
+          double v = source.step != NoStep ? 0 : ToDouble(slots[source.slot * stride + i]);
+          if(input.multiply)
+            value *= v * source.scale + source.offset;
+          else
+            value += v * source.scale + source.offset;
+        }
+      if(value < 0 || value > 0)
+        return false;
+    }
+  return true;
+}
+
+
+void BlueprintProgram::RunControlSteps(Node * const * nodes, long time_index, unsigned int frames, sample_t * slots, unsigned int stride) const
+{
+  // The control steps are run at the times which are multiples of the period, one period ahead of the frames
+  // being rendered, and the values of the frames between two control points are interpolated:
+  auto period = static_cast<long>(_control_period);
+  long point; // The time of the previous control point.
+  std::memcpy(&point, slots + _control_time_slot * stride, sizeof point);
+  auto EvaluatePoint = [&](long time)
+  {
+    for(const auto & output : _control_outputs)
+      slots[output.previous_slot * stride] = slots[output.next_slot * stride];
+    for(const auto & step : _control_steps)
+      RunStep(nodes, step, time, 1, slots, stride);
+  };
+
+  for(unsigned int i = 0; i < frames;)
+    {
+      auto time = time_index + i;
+      auto previous = point;
+      if(point < 0 || time < previous || time >= previous + 2 * period)
+        { // Start, or the time has jumped:
+          previous = time - time % period;
+          EvaluatePoint(previous);
+          EvaluatePoint(previous + period);
+        }
+      else if(time >= previous + period)
+        {
+          previous += period;
+          EvaluatePoint(previous + period);
+        }
+      point = previous;
+
+      auto end = static_cast<unsigned int>(std::min(static_cast<long>(frames), static_cast<long>(i) + previous + period - time));
+      auto step = 1.0 / static_cast<double>(period);
+      auto position = static_cast<double>(time - previous) * step;
+      for(const auto & output : _control_outputs)
+        {
+          auto a = ToDouble(slots[output.previous_slot * stride]);
+          auto b = ToDouble(slots[output.next_slot * stride]);
+          auto values = slots + output.output_slot * stride;
+          for(unsigned int j = i; j < end; j++)
+            values[j] = ToSample(a + (b - a) * (position + static_cast<double>(j - i) * step));
+        }
+      i = end;
+    }
+  std::memcpy(slots + _control_time_slot * stride, &point, sizeof point);
+}
+
+
+void BlueprintProgram::RunStep(Node * const * nodes, const Step & step, long time_index, unsigned int frames, sample_t * slots, unsigned int stride, bool silent) const
+{
+  auto inputs = PrepareInputs(step, frames, slots, stride, silent);
+  nodes[step.node]->RenderBlock(time_index, frames,
+                                inputs[static_cast<unsigned int>(Node::Channel::Amplitude)],
+                                inputs[static_cast<unsigned int>(Node::Channel::Form)],
+                                inputs[static_cast<unsigned int>(Node::Channel::Aux)],
+                                slots + step.output_slot * stride);
+}
+
+
+void BlueprintProgram::RunStepVoices(Node * const * const * nodes, const Step & step, const std::vector<unsigned int> & voices, const long * time_indices,
+                                     unsigned int frames, sample_t * const * slots, unsigned int stride) const
+{
+  thread_local std::vector<Node *>           step_nodes;
+  thread_local std::vector<long>             times;
+  thread_local std::vector<const sample_t *> amplitude, form, aux;
+  thread_local std::vector<sample_t *>       output;
+  step_nodes.clear();
+  times.clear();
+  amplitude.clear();
+  form.clear();
+  aux.clear();
+  output.clear();
+  for(auto v : voices)
+    {
+      auto inputs = PrepareInputs(step, frames, slots[v], stride, false);
+      step_nodes.push_back(nodes[v][step.node]);
+      times.push_back(time_indices[v]);
+      amplitude.push_back(inputs[static_cast<unsigned int>(Node::Channel::Amplitude)]);
+      form.push_back(inputs[static_cast<unsigned int>(Node::Channel::Form)]);
+      aux.push_back(inputs[static_cast<unsigned int>(Node::Channel::Aux)]);
+      output.push_back(slots[v] + step.output_slot * stride);
+    }
+  step_nodes[0]->RenderVoices(step_nodes.data(), static_cast<unsigned int>(voices.size()), times.data(), frames, amplitude.data(), form.data(), aux.data(), output.data());
+}
+
+
+std::array<const sample_t *, Node::AllChannels.size()> BlueprintProgram::PrepareInputs(const Step & step, unsigned int frames, sample_t * slots, unsigned int stride, bool silent) const
+{
+  std::array<const sample_t *, Node::AllChannels.size()> inputs;
+  for(unsigned int c = 0; c < inputs.size(); c++)
+    {
+      if(silent && c != static_cast<unsigned int>(Node::Channel::Amplitude))
+        { // The Form and Aux inputs of a silent step are not computed.
+          inputs[c] = slots + _zero_slot * stride;
+          continue;
+        }
+
+      const auto & input = step.inputs[c];
+      auto buffer = slots + input.slot * stride;
+
+      if(!input.sources.empty())
+        {
+          const auto & first = input.sources[0];
+          auto values = slots + first.slot * stride;
+          auto scale  = static_cast<sample_t>(first.scale);
+          auto offset = static_cast<sample_t>(first.offset);
+          for(unsigned int i = 0; i < frames; i++)
+            buffer[i] = values[i] * scale + offset;
+
+          for(unsigned int s = 1; s < input.sources.size(); s++)
+            {
+              const auto & source = input.sources[s];
+              values = slots + source.slot * stride;
+              scale  = static_cast<sample_t>(source.scale);
+              offset = static_cast<sample_t>(source.offset);
+              if(input.multiply)
+                for(unsigned int i = 0; i < frames; i++)
+                  buffer[i] *= values[i] * scale + offset;
+              else
+                for(unsigned int i = 0; i < frames; i++)
+                  buffer[i] += values[i] * scale + offset;
+            }
+        }
+      inputs[c] = buffer;
+    }
+  return inputs;
+}
@@ -0,0 +1,168 @@
+#ifndef BLUEPRINT_PROGRAM_HH_
+#define BLUEPRINT_PROGRAM_HH_
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "Node.hh"
+#include <array>
+#include <climits>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace fmsynth
+{
+  class ThreadPool;
+
+
+  // Immutable, flat execution plan of the nodes of a blueprint.
+  //
+  // Each node in the execution order becomes a step. The steps read their inputs from,
+  // and write their output to, integer addressed slots of a buffer owned by the caller.
+  // The fan-ins and the range normalizations are resolved when the program is compiled.
+  // The compiler leaves out the nodes whose output does not reach a node with side effects,
+  // and folds the stateless nodes whose inputs are all constant into constant slots.
+  //
+  // With a control period of more than one frame, the slowly varying nodes which only modulate
+  // other nodes are run once per period, and their output is linearly interpolated between the
+  // runs. Their values then differ from the full rate values by the error of the interpolation,
+  // which is zero for linear segments and spreads a jump over one period, and the events of these
+  // nodes (such as an envelope ending the blueprint) can move by up to one period.
+  //
+  // The steps whose Amplitude input is known to be zero for a whole block, before the block is run,
+  // output silence. They are skipped, as are the steps whose output is read only by silent steps.
+  // The steps with side effects are run with silent input instead. See Node::OnSkip() for what
+  // happens to the state of the skipped nodes.
+  // The program does not refer to the nodes directly, but by their index in the node
+  // list, so the same program can be run on all the blueprints loaded from the same file.
+  //
+  // The steps are grouped into levels, the steps of a level read only the outputs of the steps of the
+  // previous levels. A program compiled for parallel execution gives each step slots of its own, and runs
+  // the steps of a level in the threads of a ThreadPool when the level has enough work to pay for waking
+  // the threads. The steps which can finish the blueprint are run by the calling thread after the others.
+  // The output is the same as when the steps are run one by one.
+  class BlueprintProgram
+  {
+  public:
+    static constexpr unsigned int NoStep          = UINT_MAX;
+    static constexpr unsigned int ParallelMinWork = 4096; // The frames of the steps of a level needed to run the level in parallel.
+    struct Source
+    {
+      unsigned int slot;
+      double       scale;
+      double       offset;
+      unsigned int step; // The step writing the slot, NoStep if the slot is written before the steps are run.
+    };
+    struct StepInput
+    {
+      unsigned int        slot;     // The slot the input is read from.
+      bool                multiply; // Combine the sources by multiplying instead of adding them.
+      std::vector<Source> sources;  // The sources to combine into the slot, empty if the slot is read as is.
+      unsigned int        step;     // The step writing the slot when it is read as is, or NoStep.
+    };
+    struct Step
+    {
+      unsigned int node;
+      unsigned int output_slot;
+      std::array<StepInput, Node::AllChannels.size()> inputs;
+    };
+    struct AudioOutput
+    {
+      unsigned int node;
+      unsigned int slot;
+    };
+    struct ControlOutput // The output of a control rate node, interpolated for the nodes running at the audio rate.
+    {
+      unsigned int previous_slot; // The value at the previous control point.
+      unsigned int next_slot;     // The value at the next control point, written by the control step.
+      unsigned int output_slot;   // The interpolated values.
+    };
+    struct Normalization // The range normalization of a link, resolved when the program was compiled.
+    {
+      unsigned int  node;
+      Node::Channel channel;
+      unsigned int  source;
+      double        scale;
+      double        offset;
+    };
+
+    // The root node becomes the node number 0:
+    BlueprintProgram(Node * root, const std::vector<Node *> & exec_nodes, unsigned int control_period = 1, bool parallel = false);
+
+    [[nodiscard]] const std::vector<Step> &        GetSteps()        const;
+    [[nodiscard]] const std::vector<Step> &        GetControlSteps() const; // The steps run once per control period.
+    [[nodiscard]] unsigned int                     GetControlPeriod() const;
+    [[nodiscard]] bool                             IsParallel()      const;
+    [[nodiscard]] const std::vector<std::vector<unsigned int>> & GetLevels() const; // The indices of the steps of each level.
+    [[nodiscard]] const std::vector<AudioOutput> & GetAudioOutputs() const;
+    [[nodiscard]] unsigned int                     GetSlotCount()    const;
+    [[nodiscard]] unsigned int                     GetNodeCount()    const;
+    [[nodiscard]] const std::string &              GetNodeId(unsigned int node)   const;
+    [[nodiscard]] const std::string &              GetNodeType(unsigned int node) const;
+    [[nodiscard]] const std::vector<unsigned int> & GetFoldedNodes() const; // The nodes folded into constants.
+    [[nodiscard]] const std::vector<unsigned int> & GetDeadNodes()   const; // The nodes left out because they can not affect the output.
+    // Returns false if the enabled states or the output ranges of the nodes have changed so that the
+    // program needs to be recompiled:
+    [[nodiscard]] bool                             IsCurrent(Node * const * nodes) const;
+
+    // The slots buffer holds GetSlotCount() slots of stride values each, and is prepared once before running.
+    void PrepareSlots(sample_t * slots, unsigned int stride) const;
+    // Runs the folded steps again into prepared slots, after the parameters of the folded nodes have changed.
+    // Does not allocate memory. The changes of the enabled states and of the ranges need a new program.
+    void UpdateFoldedSlots(Node * const * nodes, sample_t * slots, unsigned int stride) const;
+    // The steps of a parallel program are run in the threads of the pool, if one is given:
+    void Run(Node * const * nodes, long time_index, unsigned int frames, sample_t * slots, unsigned int stride, ThreadPool * pool = nullptr) const;
+    // Runs the program for several voices, each with its own nodes, time and slots. The voices are advanced
+    // one step at a time, so that the voices of a step are rendered together by Node::RenderVoices():
+    void RunVoices(Node * const * const * nodes, const long * time_indices, unsigned int voices, unsigned int frames, sample_t * const * slots, unsigned int stride,
+                   ThreadPool * pool = nullptr) const;
+
+  private:
+    std::vector<Step>                          _steps;
+    std::vector<Step>                          _control_steps;
+    std::vector<ControlOutput>                 _control_outputs;
+    unsigned int                               _control_period;
+    unsigned int                               _control_time_slot; // Two slots holding the long time of the previous control point, -1 before the first one.
+    unsigned int                               _zero_slot;
+    std::vector<Step>                          _folded_steps; // Run once when compiling, the values of their output slots are constants.
+    std::vector<unsigned int>                  _folded_nodes;
+    std::vector<unsigned int>                  _dead_nodes;
+    std::vector<bool>                          _enabled;
+    std::vector<AudioOutput>                   _audio_outputs;
+    std::vector<Normalization>                 _normalizations;
+    std::vector<std::tuple<unsigned int, double>> _constants; // Slots holding constant values, the outputs of the folded steps are the last ones.
+    std::vector<std::string>                   _node_ids;
+    std::vector<std::string>                   _node_types;
+    unsigned int                               _slot_count;
+    bool                                       _parallel;
+    std::vector<std::vector<unsigned int>>     _levels;
+
+    enum StepState : unsigned char // The flags of a step for the block being run.
+      {
+        Silent = 1,
+        Needed = 2
+      };
+
+    void RunControlSteps(Node * const * nodes, long time_index, unsigned int frames, sample_t * slots, unsigned int stride) const;
+    void RunStepForVoices(Node * const * const * nodes, unsigned int step_index, const unsigned char * states, const long * time_indices, unsigned int voices,
+                          unsigned int frames, sample_t * const * slots, unsigned int stride) const;
+    void FindNeededSteps(Node * const * nodes, unsigned int frames, const sample_t * slots, unsigned int stride, unsigned char * states) const;
+    void RunStep(Node * const * nodes, const Step & step, long time_index, unsigned int frames, sample_t * slots, unsigned int stride, bool silent = false) const;
+    void RunStepVoices(Node * const * const * nodes, const Step & step, const std::vector<unsigned int> & voices, const long * time_indices,
+                       unsigned int frames, sample_t * const * slots, unsigned int stride) const;
+    [[nodiscard]] std::array<const sample_t *, Node::AllChannels.size()> PrepareInputs(const Step & step, unsigned int frames, sample_t * slots, unsigned int stride, bool silent) const;
+    [[nodiscard]] bool IsSilent(const StepInput & input, const unsigned char * states, unsigned int frames, const sample_t * slots, unsigned int stride) const;
+    [[nodiscard]] std::vector<double> EvaluateFoldedSteps(Node * const * nodes) const;
+  };
+}
+
+#endif
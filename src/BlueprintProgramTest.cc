@@ -0,0 +1,447 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "Blueprint.hh"
+#include "BlueprintProgram.hh"
+#include "NodeADHSR.hh"
+#include "NodeAudioDeviceOutput.hh"
+#include "NodeClamp.hh"
+#include "NodeConstant.hh"
+#include "NodeInverse.hh"
+#include "NodeMultiply.hh"
+#include "NodeOscillator.hh"
+#include "NodeRangeConvert.hh"
+#include "NodeReciprocal.hh"
+#include "Test.hh"
+#include "ThreadPool.hh"
+#include "Util.hh"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <tuple>
+#include <vector>
+
+
+// Passes the input through, and counts the blocks it is run for:
+class CountingNode : public fmsynth::Node
+{
+public:
+  CountingNode()
+    : Node("Counting"),
+      blocks(0)
+  {
+  }
+
+  unsigned int blocks;
+
+protected:
+  double ProcessInput([[maybe_unused]] double time, double form) override
+  {
+    return form;
+  }
+
+  void ProcessBlock(long time_index, unsigned int frames, const fmsynth::sample_t * amplitude, const fmsynth::sample_t * form, const fmsynth::sample_t * aux, fmsynth::sample_t * output) override
+  {
+    blocks++;
+    Node::ProcessBlock(time_index, frames, amplitude, form, aux, output);
+  }
+};
+
+
+// Branches of an oscillator, a filter and an envelope, mixed into one output. The first envelope stops the blueprint after 0.5 seconds:
+static json11::Json WideBlueprint(unsigned int branches)
+{
+  json11::Json::array nodes;
+  json11::Json::array links;
+  auto Link = [&links](const std::string & from, const std::string & to)
+  {
+    links.push_back(json11::Json::object { { "from", from }, { "to", to }, { "to_channel", "Form" } });
+  };
+
+  nodes.push_back(json11::Json::object {
+      { "node_id", "out" }, { "node_type", "AudioDeviceOutput" }, { "enabled", true }, { "audiodeviceoutput_volume", 0.1 }, { "audiodeviceoutput_muted", false }
+    });
+  for(unsigned int i = 0; i < branches; i++)
+    {
+      auto id = std::to_string(i);
+      nodes.push_back(json11::Json::object {
+          { "node_id", "c" + id }, { "node_type", "Constant" }, { "enabled", true },
+          { "constant", json11::Json::object { { "value", 110.0 * (i + 1) }, { "unit", 1 } } }
+        });
+      nodes.push_back(json11::Json::object {
+          { "node_id", "o" + id }, { "node_type", "Oscillator" }, { "enabled", true },
+          { "oscillator_type", i % 2 ? "Noise" : "Sawtooth" }, { "oscillator_pulse_duty_cycle", 0.5 }
+        });
+      nodes.push_back(json11::Json::object {
+          { "node_id", "f" + id }, { "node_type", "Filter" }, { "enabled", true }, { "filter_type", 2 }, { "filter_value", 0.5 }
+        });
+      nodes.push_back(json11::Json::object {
+          { "node_id", "e" + id }, { "node_type", "ADHSR" }, { "enabled", true },
+          { "adhsr_attack", 0.1 }, { "adhsr_decay", 0.1 }, { "adhsr_hold", 0.2 }, { "adhsr_sustain", 0.5 }, { "adhsr_release", 0.1 + 0.1 * i },
+          { "adhsr_max_time_range", 2 }, { "adhsr_end_action", i == 0 ? 0 : 2 }
+        });
+      Link("c" + id, "o" + id);
+      Link("o" + id, "f" + id);
+      Link("f" + id, "e" + id);
+      Link("e" + id, "out");
+    }
+  return json11::Json::object { { "nodes", nodes }, { "links", links } };
+}
+
+
+static void Test()
+{
+  {
+    fmsynth::Blueprint bp;
+    auto c1 = std::make_shared<fmsynth::NodeConstant>();
+    auto c2 = std::make_shared<fmsynth::NodeConstant>();
+    auto output = std::make_shared<fmsynth::NodeAudioDeviceOutput>();
+    c1->SetValue(fmsynth::ConstantValue(0.25, fmsynth::ConstantValue::Unit::Absolute));
+    c2->SetValue(fmsynth::ConstantValue(0.5,  fmsynth::ConstantValue::Unit::Absolute));
+    bp.AddNode(c1);
+    bp.AddNode(c2);
+    bp.AddNode(output);
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, c1.get(), fmsynth::Node::Channel::Form, output.get());
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, c2.get(), fmsynth::Node::Channel::Form, output.get());
+
+    auto program = bp.GetProgram();
+    testAssert("Constant nodes are folded.", program->GetFoldedNodes().size() == 2);
+    testAssert("Program has a step only for the output.", program->GetSteps().size() == 1);
+    testAssert("Program has one audio output.", program->GetAudioOutputs().size() == 1);
+
+    auto & form = program->GetSteps().back().inputs[static_cast<unsigned int>(fmsynth::Node::Channel::Form)];
+    testAssert("Fan-in of two nodes is resolved into two sources.", form.sources.size() == 2);
+
+    std::vector<double> buffer(10);
+    auto frames = bp.Render(buffer.data(), buffer.size());
+    // The constants are in range [0, 1], and they are normalized to the range [-1, 1] of the audio device output:
+    double expected = (0.25 * 2.0 - 1.0) + (0.5 * 2.0 - 1.0);
+    testComment << "output=" << buffer[0] << ", expected=" << expected << "\n";
+    testAssert("Rendering renders all the frames.", frames == buffer.size());
+    testAssert("Fan-in sums the normalized values.", FloatEqual(buffer[0], expected, 0.00001) && FloatEqual(buffer[9], expected, 0.00001));
+  }
+
+  {
+    const unsigned int count = 100;
+    fmsynth::Blueprint bp;
+    auto constant = std::make_shared<fmsynth::NodeConstant>();
+    auto oscillator = std::make_shared<fmsynth::NodeOscillator>();
+    bp.AddNode(constant);
+    bp.AddNode(oscillator);
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, constant.get(), fmsynth::Node::Channel::Form, oscillator.get());
+    fmsynth::Node * previous = oscillator.get();
+    for(unsigned int i = 0; i < count; i++)
+      {
+        auto multiply = std::make_shared<fmsynth::NodeMultiply>();
+        bp.AddNode(multiply);
+        bp.ConnectNodes(fmsynth::Node::Channel::Form, previous, fmsynth::Node::Channel::Form, multiply.get());
+        previous = multiply.get();
+      }
+    auto output = std::make_shared<fmsynth::NodeAudioDeviceOutput>();
+    bp.AddNode(output);
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, previous, fmsynth::Node::Channel::Form, output.get());
+    auto program = bp.GetProgram();
+    testAssert("Program has a step for each node of a long chain of nodes.", program->GetSteps().size() == count + 2);
+    testComment << "steps=" << program->GetSteps().size() << ", slots=" << program->GetSlotCount() << "\n";
+    testAssert("Program reuses the slots of a long chain of nodes.", program->GetSlotCount() < 10);
+  }
+
+  {
+    // The output range of the inverse comes from the clamp, through the chain:
+    fmsynth::Blueprint bp;
+    auto constant = std::make_shared<fmsynth::NodeConstant>();
+    auto clamp = std::make_shared<fmsynth::NodeClamp>();
+    auto inverse = std::make_shared<fmsynth::NodeInverse>();
+    auto output = std::make_shared<fmsynth::NodeAudioDeviceOutput>();
+    constant->SetValue(fmsynth::ConstantValue(0.25, fmsynth::ConstantValue::Unit::Absolute));
+    bp.AddNode(constant);
+    bp.AddNode(clamp);
+    bp.AddNode(inverse);
+    bp.AddNode(output);
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, constant.get(), fmsynth::Node::Channel::Form, clamp.get());
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, clamp.get(),    fmsynth::Node::Channel::Form, inverse.get());
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, inverse.get(),  fmsynth::Node::Channel::Form, output.get());
+
+    std::vector<double> buffer(10);
+    auto program = bp.GetProgram();
+    [[maybe_unused]] auto frames = bp.Render(buffer.data(), buffer.size());
+    testComment << "output=" << buffer[0] << "\n";
+    testAssert("Range of [0, 1] is normalized through a chain of nodes.", FloatEqual(buffer[9], 0.5, 0.00001));
+
+    fmsynth::NodeClamp unrelated;
+    unrelated.SetMin(-1);
+    testAssert("Program is kept if the normalizations do not change.", bp.GetProgram() == program);
+
+    fmsynth::Blueprint other;
+    auto other_clamp = std::make_shared<fmsynth::NodeClamp>();
+    other.AddNode(other_clamp);
+    auto revision = clamp->GetGraphRevision();
+    other_clamp->SetMin(-1);
+    testAssert("Edits in another blueprint do not change the graph revision.", clamp->GetGraphRevision() == revision);
+
+    clamp->SetMin(-1);
+    testAssert("Edit in the blueprint changes the graph revision.", clamp->GetGraphRevision() != revision);
+    bp.UpdateProgram();
+    frames = bp.Render(buffer.data(), buffer.size());
+    testComment << "output=" << buffer[0] << "\n";
+    testAssert("Program is recompiled when the range of a node changes.", bp.GetProgram() != program);
+    testAssert("Range change of a node is normalized through a chain of nodes.", FloatEqual(buffer[9], -0.25, 0.00001));
+  }
+
+  {
+    fmsynth::Blueprint bp;
+    auto constant = std::make_shared<fmsynth::NodeConstant>();
+    auto convert = std::make_shared<fmsynth::NodeRangeConvert>();
+    auto multiply = std::make_shared<fmsynth::NodeMultiply>();
+    auto reciprocal = std::make_shared<fmsynth::NodeReciprocal>();
+    auto unused = std::make_shared<fmsynth::NodeOscillator>();
+    auto output = std::make_shared<fmsynth::NodeAudioDeviceOutput>();
+    constant->SetValue(fmsynth::ConstantValue(0.5, fmsynth::ConstantValue::Unit::Absolute));
+    convert->SetTo(fmsynth::Range(1, 3));
+    multiply->SetMultiplier(0.25);
+    for(auto node : std::vector<std::shared_ptr<fmsynth::Node>> { constant, convert, multiply, reciprocal, unused, output })
+      bp.AddNode(node);
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, constant.get(),   fmsynth::Node::Channel::Form, convert.get());
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, convert.get(),    fmsynth::Node::Channel::Form, multiply.get());
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, multiply.get(),   fmsynth::Node::Channel::Form, reciprocal.get());
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, reciprocal.get(), fmsynth::Node::Channel::Form, output.get());
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, constant.get(),   fmsynth::Node::Channel::Form, unused.get());
+
+    auto program = bp.GetProgram();
+    testComment << "steps=" << program->GetSteps().size() << ", folded=" << program->GetFoldedNodes().size() << ", dead=" << program->GetDeadNodes().size() << "\n";
+    testAssert("Chain of constant nodes is folded.", program->GetFoldedNodes().size() == 4);
+    testAssert("Node which does not reach an output is left out.",
+               program->GetDeadNodes().size() == 1 && program->GetNodeId(program->GetDeadNodes()[0]) == unused->GetId());
+    testAssert("Program has a step only for the output.", program->GetSteps().size() == 1);
+
+    std::vector<double> buffer(10);
+    [[maybe_unused]] auto frames = bp.Render(buffer.data(), buffer.size());
+    testComment << "output=" << buffer[9] << "\n";
+    testAssert("Folded chain produces the value of the chain.", FloatEqual(buffer[9], 1.0 / (2.0 * 0.25), 0.00001));
+
+    multiply->SetMultiplier(0.5);
+    frames = bp.Render(buffer.data(), buffer.size());
+    testAssert("Folded chain follows the parameter changes.", FloatEqual(buffer[9], 1.0, 0.00001));
+    testAssert("Program is kept when only the values of the folded nodes change.", bp.GetProgram() == program);
+
+    multiply->SetEnabled(bp.GetRoot(), false);
+    program = bp.GetProgram();
+    testAssert("Inputs of a disabled node are left out.", program->GetDeadNodes().size() == 3);
+    frames = bp.Render(buffer.data(), buffer.size());
+    testComment << "output=" << buffer[9] << "\n";
+    testAssert("Disabled node does not accept input.", std::isinf(buffer[9]));
+  }
+
+  {
+    // An envelope modulating the amplitude of an oscillator, and directly the volume of an output:
+    auto Build = [](fmsynth::Blueprint & bp, unsigned int control_period, bool envelope_to_output)
+    {
+      auto one = std::make_shared<fmsynth::NodeConstant>();
+      auto frequency = std::make_shared<fmsynth::NodeConstant>();
+      auto envelope = std::make_shared<fmsynth::NodeADHSR>();
+      auto scale = std::make_shared<fmsynth::NodeMultiply>();
+      auto oscillator = std::make_shared<fmsynth::NodeOscillator>();
+      auto output = std::make_shared<fmsynth::NodeAudioDeviceOutput>();
+      one->SetValue(fmsynth::ConstantValue(1, fmsynth::ConstantValue::Unit::Absolute));
+      frequency->SetValue(fmsynth::ConstantValue(440, fmsynth::ConstantValue::Unit::Hertz));
+      envelope->Set(0.1, 0.1, 0.1, 0.5, 0.1, fmsynth::NodeADHSR::EndAction::NOP);
+      scale->SetMultiplier(0.8);
+      for(auto node : std::vector<std::shared_ptr<fmsynth::Node>> { one, frequency, envelope, scale, oscillator, output })
+        bp.AddNode(node);
+      bp.ConnectNodes(fmsynth::Node::Channel::Form, one.get(),        fmsynth::Node::Channel::Form,      envelope.get());
+      bp.ConnectNodes(fmsynth::Node::Channel::Form, envelope.get(),   fmsynth::Node::Channel::Form,      scale.get());
+      bp.ConnectNodes(fmsynth::Node::Channel::Form, scale.get(),      fmsynth::Node::Channel::Amplitude, oscillator.get());
+      bp.ConnectNodes(fmsynth::Node::Channel::Form, frequency.get(),  fmsynth::Node::Channel::Form,      oscillator.get());
+      bp.ConnectNodes(fmsynth::Node::Channel::Form, oscillator.get(), fmsynth::Node::Channel::Form,      output.get());
+      if(envelope_to_output)
+        bp.ConnectNodes(fmsynth::Node::Channel::Form, envelope.get(), fmsynth::Node::Channel::Amplitude, output.get());
+      bp.SetControlPeriod(control_period);
+    };
+
+    for(auto envelope_to_output : { false, true })
+      {
+        fmsynth::Blueprint full;
+        fmsynth::Blueprint control;
+        Build(full, 1, envelope_to_output);
+        Build(control, 32, envelope_to_output);
+
+        std::vector<double> expected(full.GetSamplesPerSecond() / 2);
+        std::vector<double> output(expected.size());
+        auto frames1 = full.Render(expected.data(), expected.size());
+        auto frames2 = control.Render(output.data(), output.size());
+        double maxdiff = 0;
+        for(unsigned int i = 0; i < output.size(); i++)
+          maxdiff = std::max(maxdiff, std::abs(output[i] - expected[i]));
+
+        auto program = control.GetProgram();
+        testComment << "steps=" << program->GetSteps().size() << ", control steps=" << program->GetControlSteps().size() << ", maxdiff=" << maxdiff << "\n";
+        if(!envelope_to_output)
+          {
+            testAssert("Envelope and the nodes computing from it run at the control rate.",
+                       program->GetControlSteps().size() == 2 && program->GetSteps().size() == 2);
+            testAssert("Control rate output is within 0.01 of the full rate output.", frames1 == frames2 && maxdiff < 0.01);
+          }
+        else
+          {
+            testAssert("Envelope feeding an output, and the nodes computing from it, run at the audio rate.", program->GetControlSteps().empty());
+            testAssert("Control rate output is the same as the full rate output.", frames1 == frames2 && maxdiff < 0.0000001);
+          }
+      }
+  }
+
+  {
+    // An envelope which stops the blueprint, modulating an oscillator at the control rate:
+    auto Build = [](fmsynth::Blueprint & bp, unsigned int control_period)
+    {
+      auto one = std::make_shared<fmsynth::NodeConstant>();
+      auto frequency = std::make_shared<fmsynth::NodeConstant>();
+      auto envelope = std::make_shared<fmsynth::NodeADHSR>();
+      auto oscillator = std::make_shared<fmsynth::NodeOscillator>();
+      auto output = std::make_shared<fmsynth::NodeAudioDeviceOutput>();
+      one->SetValue(fmsynth::ConstantValue(1, fmsynth::ConstantValue::Unit::Absolute));
+      frequency->SetValue(fmsynth::ConstantValue(440, fmsynth::ConstantValue::Unit::Hertz));
+      envelope->Set(0.01, 0.01, 0.01, 0.5, 0.01, fmsynth::NodeADHSR::EndAction::STOP);
+      for(auto node : std::vector<std::shared_ptr<fmsynth::Node>> { one, frequency, envelope, oscillator, output })
+        bp.AddNode(node);
+      bp.ConnectNodes(fmsynth::Node::Channel::Form, one.get(),        fmsynth::Node::Channel::Form,      envelope.get());
+      bp.ConnectNodes(fmsynth::Node::Channel::Form, envelope.get(),   fmsynth::Node::Channel::Amplitude, oscillator.get());
+      bp.ConnectNodes(fmsynth::Node::Channel::Form, frequency.get(),  fmsynth::Node::Channel::Form,      oscillator.get());
+      bp.ConnectNodes(fmsynth::Node::Channel::Form, oscillator.get(), fmsynth::Node::Channel::Form,      output.get());
+      bp.SetControlPeriod(control_period);
+      bp.SetBlockSize(80); // The control point where the envelope ends is evaluated during the block before it.
+    };
+
+    const unsigned int period = 64;
+    fmsynth::Blueprint full;
+    fmsynth::Blueprint control;
+    Build(full, 1);
+    Build(control, period);
+    std::vector<double> buffer(full.GetSamplesPerSecond());
+    auto frames1 = full.Render(buffer.data(), buffer.size());
+    auto frames2 = control.Render(buffer.data(), buffer.size());
+    testComment << "control steps=" << control.GetProgram()->GetControlSteps().size() << ", frames=" << frames1 << ", control rate frames=" << frames2 << "\n";
+    // The envelope stops at the first control point at or after the frame where it stops at the full rate:
+    auto expected = (frames1 - 1 + period - 1) / period * period + 1;
+    testAssert("Envelope stopping the blueprint at the control rate does not end it early.", full.IsFinished() && control.IsFinished() && frames2 == expected);
+  }
+
+  {
+    // An oscillator gated by an envelope which ends in silence, with its frequency computed by a counting node:
+    fmsynth::Blueprint bp;
+    auto one = std::make_shared<fmsynth::NodeConstant>();
+    auto frequency = std::make_shared<fmsynth::NodeConstant>();
+    auto counter = std::make_shared<CountingNode>();
+    auto envelope = std::make_shared<fmsynth::NodeADHSR>();
+    auto oscillator = std::make_shared<fmsynth::NodeOscillator>();
+    auto output = std::make_shared<fmsynth::NodeAudioDeviceOutput>();
+    one->SetValue(fmsynth::ConstantValue(1, fmsynth::ConstantValue::Unit::Absolute));
+    frequency->SetValue(fmsynth::ConstantValue(440, fmsynth::ConstantValue::Unit::Hertz));
+    envelope->Set(0.01, 0.01, 0.01, 0.5, 0.01, fmsynth::NodeADHSR::EndAction::NOP);
+    for(auto node : std::vector<std::shared_ptr<fmsynth::Node>> { one, frequency, counter, envelope, oscillator, output })
+      bp.AddNode(node);
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, frequency.get(),  fmsynth::Node::Channel::Form,      counter.get());
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, counter.get(),    fmsynth::Node::Channel::Form,      oscillator.get());
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, one.get(),        fmsynth::Node::Channel::Form,      envelope.get());
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, envelope.get(),   fmsynth::Node::Channel::Amplitude, oscillator.get());
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, oscillator.get(), fmsynth::Node::Channel::Form,      output.get());
+    bp.SetControlPeriod(16);
+    bp.SetBlockSize(100);
+
+    // The envelope ends at 0.04s, after 1764 frames:
+    std::vector<double> buffer(bp.GetSamplesPerSecond());
+    [[maybe_unused]] auto frames = bp.Render(buffer.data(), buffer.size());
+    testComment << "blocks=" << counter->blocks << "\n";
+    testAssert("Nodes gated by a silent envelope are skipped.", counter->blocks > 17 && counter->blocks < 20);
+    testAssert("Gated output is silent.", std::all_of(buffer.cbegin() + 1800, buffer.cend(), [](double v) { return !(std::abs(v) > 0); }));
+
+    output->SetMuted(true);
+    counter->blocks = 0;
+    envelope->Set(1, 0, 0, 1, 0, fmsynth::NodeADHSR::EndAction::NOP);
+    bp.ResetTime();
+    frames = bp.Render(buffer.data(), buffer.size());
+    testAssert("Inputs of a muted output are skipped.", counter->blocks == 0);
+  }
+
+  {
+    std::string testname = "Program compiled from one blueprint can be used by another blueprint loaded from the same file.";
+    auto [json, error] = fmsynth::util::LoadJsonFile(srcdir + "/../examples/Vibrato.sbp");
+    auto [json2, error2] = fmsynth::util::LoadJsonFile(srcdir + "/../examples/HelloWorld.sbp");
+    if(json && json2)
+      {
+        fmsynth::Blueprint bp1;
+        fmsynth::Blueprint bp2;
+        fmsynth::Blueprint other;
+        if(bp1.Load(*json) && bp2.Load(*json) && other.Load(*json2))
+          {
+            testAssert(testname, bp2.UseProgram(bp1.GetProgram()));
+            testAssert("The shared program is used.", bp1.GetProgram() == bp2.GetProgram());
+            testAssert("Program of a different blueprint can not be used.", !other.UseProgram(bp1.GetProgram()));
+
+            std::vector<double> buffer1(bp1.GetSamplesPerSecond());
+            std::vector<double> buffer2(bp2.GetSamplesPerSecond());
+            auto frames1 = bp1.Render(buffer1.data(), buffer1.size());
+            auto frames2 = bp2.Render(buffer2.data(), buffer2.size());
+            testAssert("Blueprints sharing a program produce the same output.", frames1 == frames2 && buffer1 == buffer2);
+          }
+        else
+          testSkip(testname, "Failed to load the examples.");
+      }
+    else
+      testSkip(testname, error + error2);
+    delete json;
+    delete json2;
+  }
+
+  {
+    // The examples, and a wide blueprint, are rendered once with all the nodes in one thread, and once in parallel:
+    std::vector<std::tuple<std::string, json11::Json>> blueprints;
+    for(auto filename : { "Echo.sbp", "HitExplosion.sbp", "Wind.sbp" })
+      {
+        auto [json, error] = fmsynth::util::LoadJsonFile(srcdir + "/../examples/" + filename);
+        if(json)
+          blueprints.push_back({ filename, *json });
+        else
+          testSkip(std::string("Load '") + filename + "'.", error);
+        delete json;
+      }
+    blueprints.push_back({ "wide", WideBlueprint(8) });
+
+    fmsynth::ThreadPool pool(4);
+    for(const auto & [name, json] : blueprints)
+      {
+        std::string testname = "Parallel program produces the same output for '" + name + "'.";
+        fmsynth::Blueprint sequential;
+        fmsynth::Blueprint parallel;
+        if(sequential.Load(json) && parallel.Load(json))
+          {
+            parallel.SetThreadPool(&pool);
+            for(auto bp : { &sequential, &parallel })
+              bp->SetBlockSize(fmsynth::Blueprint::MaxBlockSize);
+            auto program = parallel.GetProgram();
+            size_t widest = 0;
+            for(const auto & level : program->GetLevels())
+              widest = std::max(widest, level.size());
+            testComment << name << ": " << program->GetSteps().size() << " steps, " << program->GetLevels().size() << " levels, widest " << widest << "\n";
+
+            std::vector<double> buffer1(sequential.GetSamplesPerSecond() * 2);
+            std::vector<double> buffer2(parallel.GetSamplesPerSecond() * 2);
+            auto frames1 = sequential.Render(buffer1.data(), buffer1.size());
+            auto frames2 = parallel.Render(buffer2.data(), buffer2.size());
+            testAssert(testname, program->IsParallel() && !sequential.GetProgram()->IsParallel() && frames1 == frames2 && buffer1 == buffer2);
+            if(name == "wide")
+              testAssert("Envelope in a parallel level finishes the blueprint.", frames2 > 22000 && frames2 < 22100);
+          }
+        else
+          testSkip(testname, "Failed to load the blueprint.");
+      }
+  }
+}
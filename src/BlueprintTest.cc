@@ -11,13 +11,62 @@
 */
 
 #include "Blueprint.hh"
+#include "NodeAdd.hh"
+#include "NodeAudioDeviceOutput.hh"
 #include "NodeConstant.hh"
 #include "NodeInverse.hh"
 #include "Test.hh"
 #include "Util.hh"
+#include <algorithm>
+#include <map>
+#include <random>
 #include <vector>
 
 
+// The execution order is valid when it has exactly the nodes whose inputs are all executed, and every node is after its inputs:
+static bool IsValidExecutionOrder(fmsynth::Blueprint & bp, const std::vector<fmsynth::Node *> & nodes)
+{
+  [[maybe_unused]] auto & unscheduled = bp.GetUnscheduledNodes(); // Sorts the nodes if needed.
+  auto order = bp.GetAllNodes();
+  std::map<fmsynth::Node *, size_t> positions;
+  for(size_t i = 0; i < order.size(); i++)
+    positions[order[i]] = i;
+
+  std::map<fmsynth::Node *, bool> executable { { bp.GetRoot(), true } };
+  for(bool changed = true; changed;)
+    {
+      changed = false;
+      for(auto node : nodes)
+        if(!executable[node])
+          {
+            unsigned int inputs = 0;
+            bool ok = true;
+            for(auto channel : fmsynth::Node::AllChannels)
+              for(auto n : node->GetInput(channel)->GetInputNodes())
+                if(n)
+                  {
+                    inputs++;
+                    ok = ok && executable[n];
+                  }
+            if(inputs > 0 && ok)
+              executable[node] = changed = true;
+          }
+    }
+
+  for(auto node : nodes)
+    {
+      if(executable[node] != positions.contains(node))
+        return false;
+      if(executable[node])
+        for(auto channel : fmsynth::Node::AllChannels)
+          for(auto n : node->GetInput(channel)->GetInputNodes())
+            if(n != bp.GetRoot() && positions.at(n) > positions.at(node))
+              return false;
+    }
+  return order.size() == positions.size();
+}
+
+
 static void Test()
 {
   {
@@ -55,6 +104,122 @@ static void Test()
     testAssert("GetNode() returns added node.", bp.GetNode(node->GetId()));
   }
 
+  {
+    fmsynth::Blueprint bp;
+    auto node1 = std::make_shared<fmsynth::NodeConstant>();
+    auto node2 = std::make_shared<fmsynth::NodeConstant>();
+    node1->SetId("first");
+    node2->SetId("second");
+    bp.AddNode(node1);
+    bp.AddNode(node2);
+    bp.SetNodeId(node1.get(), "renamed");
+    testAssert("GetNode() finds the node by the id set with SetNodeId().", bp.GetNode("renamed") == node1.get() && !bp.GetNode("first"));
+    node2->SetId("changed");
+    testAssert("GetNode() finds the node by the id set with Node::SetId().", bp.GetNode("changed") == node2.get() && !bp.GetNode("second"));
+    bp.RemoveNode(node1.get());
+    testAssert("GetNode() does not return removed node.", !bp.GetNode("renamed") && bp.GetNode("changed") == node2.get());
+  }
+
+  {
+    auto node3 = std::make_shared<fmsynth::NodeConstant>();
+    {
+      fmsynth::Blueprint bp;
+      auto node1 = std::make_shared<fmsynth::NodeConstant>();
+      auto node2 = std::make_shared<fmsynth::NodeConstant>();
+      node1->SetId("same");
+      node2->SetId("same");
+      bp.AddNode(node1);
+      bp.AddNode(node2);
+      bp.AddNode(node3);
+      node1->SetId("other");
+      testAssert("GetNode() finds the other node with the same id after the first one is renamed.", bp.GetNode("same") == node2.get() && bp.GetNode("other") == node1.get());
+    }
+    node3->SetId("after");
+    testAssert("The id of a node can be changed after its blueprint is destroyed.", node3->GetId() == "after" && !node3->GetBlueprint());
+  }
+
+  {
+    // Random edits of a blueprint, the execution order is updated incrementally between the edits:
+    fmsynth::Blueprint bp;
+    std::vector<std::shared_ptr<fmsynth::Node>> shared;
+    std::vector<fmsynth::Node *> nodes;
+    for(unsigned int i = 0; i < 40; i++)
+      {
+        shared.push_back(i < 4 ? std::shared_ptr<fmsynth::Node>(std::make_shared<fmsynth::NodeConstant>()) : std::make_shared<fmsynth::NodeAdd>());
+        bp.AddNode(shared.back());
+        nodes.push_back(shared.back().get());
+      }
+    for(unsigned int i = 4; i < nodes.size(); i++)
+      bp.ConnectNodes(fmsynth::Node::Channel::Form, nodes[i % 4], fmsynth::Node::Channel::Aux, nodes[i]);
+
+    std::mt19937 random(1234);
+    auto Pick = [&random](const std::vector<fmsynth::Node *> & from) { return from[std::uniform_int_distribution<size_t>(0, from.size() - 1)(random)]; };
+    bool valid = true;
+    unsigned int cycles = 0;
+    for(unsigned int i = 0; valid && i < 2000; i++)
+      {
+        auto action = random() % 10;
+        if(action < 4)
+          { // Mostly links from the earlier added nodes to the later ones, which may go backwards in the execution order:
+            auto from = Pick(nodes);
+            auto to = Pick(nodes);
+            auto ifrom = std::find(nodes.cbegin(), nodes.cend(), from);
+            auto ito = std::find(nodes.cbegin(), nodes.cend(), to);
+            if(ifrom > ito && random() % 8 > 0)
+              std::swap(from, to);
+            auto channel = random() % 2 ? fmsynth::Node::Channel::Form : fmsynth::Node::Channel::Aux;
+            if(from != to)
+              {
+                bp.ConnectNodes(fmsynth::Node::Channel::Form, from, channel, to);
+                if(!bp.GetUnscheduledNodes().empty())
+                  { // Keep the blueprint mostly free of cycles:
+                    cycles++;
+                    valid = IsValidExecutionOrder(bp, nodes);
+                    bp.DisconnectNodes(fmsynth::Node::Channel::Form, from, channel, to);
+                  }
+              }
+          }
+        else if(action < 9)
+          {
+            auto to = Pick(nodes);
+            auto channel = random() % 2 ? fmsynth::Node::Channel::Form : fmsynth::Node::Channel::Aux;
+            auto & inputs = to->GetInput(channel)->GetInputNodes();
+            if(!inputs.empty() && inputs.front() != bp.GetRoot())
+              bp.DisconnectNodes(fmsynth::Node::Channel::Form, inputs.front(), channel, to);
+          }
+        else if(nodes.size() > 10)
+          {
+            auto node = Pick(nodes);
+            bp.RemoveNode(node);
+            std::erase(nodes, node);
+          }
+
+        valid = valid && IsValidExecutionOrder(bp, nodes);
+      }
+    testComment << "links which made a cycle: " << cycles << "\n";
+    testAssert("Execution order stays valid over random edits.", valid);
+  }
+
+  {
+    fmsynth::Blueprint bp;
+    auto constant = std::make_shared<fmsynth::NodeConstant>();
+    auto add1 = std::make_shared<fmsynth::NodeAdd>();
+    auto add2 = std::make_shared<fmsynth::NodeAdd>();
+    auto add3 = std::make_shared<fmsynth::NodeAdd>();
+    bp.AddNode(constant);
+    for(auto n : { add1, add2, add3 })
+      bp.AddNode(n);
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, constant.get(), fmsynth::Node::Channel::Form, add1.get());
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, add1.get(),     fmsynth::Node::Channel::Form, add2.get());
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, add2.get(),     fmsynth::Node::Channel::Form, add3.get());
+    testAssert("Blueprint without cycles has no unscheduled nodes.", bp.GetUnscheduledNodes().empty());
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, add3.get(),     fmsynth::Node::Channel::Aux,  add2.get());
+    auto unscheduled = bp.GetUnscheduledNodes();
+    testAssert("Nodes in and after a cycle are reported as unscheduled.", unscheduled.size() == 2 && std::ranges::count(unscheduled, add2.get()) == 1 && std::ranges::count(unscheduled, add3.get()) == 1);
+    bp.DisconnectNodes(fmsynth::Node::Channel::Form, add3.get(),  fmsynth::Node::Channel::Aux,  add2.get());
+    testAssert("Breaking the cycle schedules the nodes.", bp.GetUnscheduledNodes().empty() && bp.GetAllNodes().size() == 4);
+  }
+
   {
     struct OrderingInstruction
     {
@@ -194,6 +359,78 @@ static void Test()
           else
             testSkip(testname, "Failed to load '" + e.filename + "'.");
         }
+        {
+          testname = "Rendering example '" + e.filename + "' in blocks produces the same output as ticking one frame at a time.";
+
+          fmsynth::Blueprint ticked;
+          fmsynth::Blueprint rendered;
+          if(ticked.Load(*json) && rendered.Load(*json))
+            {
+              double current_sample = 0;
+              for(auto n : ticked.GetNodesByType("AudioDeviceOutput"))
+                dynamic_cast<fmsynth::NodeAudioDeviceOutput *>(n)->SetOnPlaySample([&current_sample](double sample)
+                {
+                  current_sample += sample;
+                });
+
+              std::vector<double> expected;
+              for(unsigned int i = 0; !ticked.IsFinished() && i < 3 * ticked.GetSamplesPerSecond(); i++)
+                {
+                  current_sample = 0;
+                  ticked.Tick(1);
+                  expected.push_back(current_sample);
+                }
+
+              std::vector<double> output(expected.size());
+              rendered.SetBlockSize(100);
+              auto count = rendered.Render(output.data(), output.size());
+
+              bool same = count == expected.size() && rendered.IsFinished() == ticked.IsFinished();
+              double maxdiff = 0;
+              for(unsigned int i = 0; i < count && i < expected.size(); i++)
+                {
+                  if(same && !FloatEqual(output[i], expected[i], SampleTolerance))
+                    {
+                      testComment << "frame " << i << ": rendered=" << output[i] << ", ticked=" << expected[i] << "\n";
+                      same = false;
+                    }
+                  maxdiff = std::max(maxdiff, std::abs(output[i] - expected[i]));
+                }
+              testComment << "ticked frames=" << expected.size() << ", rendered frames=" << count << ", maxdiff=" << maxdiff << "\n";
+              testAssert(testname, same);
+            }
+          else
+            testSkip(testname, "Failed to load '" + e.filename + "'.");
+        }
+        {
+          testname = "A copy of example '" + e.filename + "' has the same nodes and renders the same output.";
+
+          fmsynth::Blueprint loaded;
+          fmsynth::Blueprint copy;
+          if(loaded.Load(*json) && copy.LoadCopy(loaded))
+            {
+              bool same = loaded.GetAllNodes().size() == copy.GetAllNodes().size();
+              for(auto n : loaded.GetAllNodes())
+                {
+                  auto c = copy.GetNode(n->GetId());
+                  if(!c || c == n || c->to_json().dump() != n->to_json().dump())
+                    {
+                      testComment << "node " << n->GetId() << " differs\n";
+                      same = false;
+                    }
+                }
+
+              std::vector<double> expected(loaded.GetSamplesPerSecond());
+              std::vector<double> output(expected.size());
+              auto expected_count = loaded.Render(expected.data(), expected.size());
+              auto count = copy.Render(output.data(), output.size());
+              same = same && count == expected_count && std::equal(output.cbegin(), output.cbegin() + static_cast<long>(count), expected.cbegin(),
+                                                                   [](double a, double b) { return FloatEqual(a, b, 0.0); });
+              testAssert(testname, same);
+            }
+          else
+            testSkip(testname, "Failed to load '" + e.filename + "'.");
+        }
         {
           testname = "Sorting the nodes of example '" + e.filename + "' produces the correct order.";
 
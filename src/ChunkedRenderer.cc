@@ -0,0 +1,106 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "ChunkedRenderer.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <cassert>
+
+using namespace fmsynth;
+
+
+ChunkedRenderer::ChunkedRenderer(ThreadPool & pool)
+  : _pool(pool),
+    _history(-1),
+    _position(0),
+    _finished(false)
+{
+}
+
+
+bool ChunkedRenderer::Load(const json11::Json & json, unsigned int samples_per_second)
+{
+  _blueprints.clear();
+  _history  = -1;
+  _position = 0;
+  _finished = false;
+
+  for(unsigned int i = 0; i < _pool.GetThreadCount(); i++)
+    {
+      auto blueprint = std::make_unique<Blueprint>();
+      if(!blueprint->Load(json))
+        return false;
+      blueprint->SetSamplesPerSecond(samples_per_second);
+      blueprint->SetBlockSize(Blueprint::MaxBlockSize);
+      if(i > 0 && !blueprint->UseProgram(_blueprints[0]->GetProgram()))
+        return false;
+      _blueprints.push_back(std::move(blueprint));
+    }
+  _rendered.resize(_blueprints.size());
+
+  _history = _blueprints[0]->GetHistoryLength();
+  return _history >= 0;
+}
+
+
+long ChunkedRenderer::GetHistoryLength() const
+{
+  return _history;
+}
+
+
+size_t ChunkedRenderer::GetChunkFrames() const
+{
+  return std::max(MinChunkFrames, 4 * static_cast<size_t>(std::max(_history, 0l)));
+}
+
+
+size_t ChunkedRenderer::Render(double * output, size_t frames)
+{
+  assert(_history >= 0);
+  if(_finished || frames == 0)
+    return 0;
+
+  auto chunks = static_cast<unsigned int>(std::clamp(frames / GetChunkFrames(), static_cast<size_t>(1), _blueprints.size()));
+  auto length = frames / chunks; // The last chunk gets the remainder.
+  auto ChunkLength = [&](unsigned int chunk) { return chunk + 1 < chunks ? length : frames - chunk * length; };
+
+  _pool.Run(chunks, [&](unsigned int chunk)
+  {
+    auto blueprint = _blueprints[chunk].get();
+    auto start = _position + static_cast<long>(chunk * length);
+    auto warmup = std::min(_history, start);
+    blueprint->Seek(start - warmup);
+
+    // The history before the chunk is rendered into the output of the chunk, and overwritten:
+    auto out = output + chunk * length;
+    auto count = ChunkLength(chunk);
+    for(long done = 0; done < warmup && !blueprint->IsFinished();)
+      done += static_cast<long>(blueprint->Render(out, static_cast<size_t>(std::min(warmup - done, static_cast<long>(count)))));
+    _rendered[chunk] = blueprint->IsFinished() ? 0 : blueprint->Render(out, count);
+  });
+
+  size_t rendered = 0;
+  for(unsigned int chunk = 0; chunk < chunks && !_finished; chunk++)
+    {
+      rendered += _rendered[chunk];
+      _finished = _rendered[chunk] < ChunkLength(chunk);
+    }
+  _position += static_cast<long>(rendered);
+  return rendered;
+}
+
+
+bool ChunkedRenderer::IsFinished() const
+{
+  return _finished;
+}
@@ -0,0 +1,58 @@
+#ifndef CHUNKED_RENDERER_HH_
+#define CHUNKED_RENDERER_HH_
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "Blueprint.hh"
+#include <memory>
+#include <vector>
+
+namespace fmsynth
+{
+  class ThreadPool;
+
+
+  // Renders a blueprint whose output depends on a limited history, see Blueprint::GetHistoryLength(),
+  // in chunks of time which the threads of a pool render at the same time.
+  //
+  // Each thread has its own copy of the blueprint. A chunk is rendered by seeking the copy to the history
+  // length before the start of the chunk, and rendering the history, which is discarded, and the chunk.
+  // The chunks are then joined in order, up to the chunk where the blueprint finishes. The output is the
+  // same as when the blueprint is rendered from the start, except for the decay of the filters which is
+  // cut at -240dB, and the rounding of the running sums of the smoothing.
+  class ChunkedRenderer
+  {
+  public:
+    static constexpr size_t MinChunkFrames = 65536; // The chunks are also at least four times the history, to keep the overhead low.
+
+    explicit ChunkedRenderer(ThreadPool & pool);
+
+    // Fails if the blueprint can not be loaded, or if its history is not limited:
+    [[nodiscard]] bool   Load(const json11::Json & json, unsigned int samples_per_second);
+    [[nodiscard]] long   GetHistoryLength() const;
+    [[nodiscard]] size_t GetChunkFrames() const; // Render() keeps all the threads busy when given this many frames per thread.
+
+    // Renders the next frames, returns the number of frames rendered, which is less than frames if the blueprint finishes:
+    [[nodiscard]] size_t Render(double * output, size_t frames);
+    [[nodiscard]] bool   IsFinished() const;
+
+  private:
+    ThreadPool &                            _pool;
+    std::vector<std::unique_ptr<Blueprint>> _blueprints; // One per thread.
+    std::vector<size_t>                     _rendered;   // The frames rendered of each chunk.
+    long                                    _history;
+    long                                    _position;
+    bool                                    _finished;
+  };
+}
+
+#endif
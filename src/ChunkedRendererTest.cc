@@ -0,0 +1,83 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "Blueprint.hh"
+#include "ChunkedRenderer.hh"
+#include "Test.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+// A filtered sine mixed with its echo, and an envelope which stops the blueprint after 6.1 seconds:
+static const char * const FilteredEcho = R"({"links": [
+  {"from": "c", "to": "o", "to_channel": "Form"},
+  {"from": "o", "to": "f", "to_channel": "Form"},
+  {"from": "f", "to": "d", "to_channel": "Form"},
+  {"from": "f", "to": "a", "to_channel": "Form"},
+  {"from": "d", "to": "a", "to_channel": "Form"},
+  {"from": "a", "to": "e", "to_channel": "Form"},
+  {"from": "e", "to": "out", "to_channel": "Form"}],
+ "nodes": [
+  {"constant": {"unit": 1, "value": 440}, "enabled": true, "node_id": "c", "node_type": "Constant"},
+  {"enabled": true, "node_id": "o", "node_type": "Oscillator", "oscillator_pulse_duty_cycle": 0.5, "oscillator_type": "Sawtooth"},
+  {"enabled": true, "filter_type": 0, "filter_value": 0.4, "node_id": "f", "node_type": "Filter"},
+  {"delay_time": 0.1, "enabled": true, "node_id": "d", "node_type": "Delay"},
+  {"add_value": 0, "enabled": true, "node_id": "a", "node_type": "Add"},
+  {"adhsr_attack": 0.01, "adhsr_decay": 0, "adhsr_end_action": 0, "adhsr_hold": 6, "adhsr_max_time_range": 10, "adhsr_release": 0.09, "adhsr_sustain": 1, "enabled": true, "node_id": "e", "node_type": "ADHSR"},
+  {"audiodeviceoutput_muted": false, "audiodeviceoutput_volume": 0.5, "enabled": true, "node_id": "out", "node_type": "AudioDeviceOutput"}]})";
+
+
+static void Test()
+{
+  std::string error;
+  auto json = json11::Json::parse(FilteredEcho, error);
+  testAssert("Test blueprint is parsed.", error.empty());
+
+  fmsynth::Blueprint blueprint;
+  bool loaded = blueprint.Load(json);
+  blueprint.SetSamplesPerSecond(44100);
+  auto history = blueprint.GetHistoryLength();
+  testAssert("History is the delay and the decay of the filter.", loaded && history > 4410 + 50 && history < 4410 + 70);
+
+  std::vector<double> expected(44100 * 7);
+  auto length = blueprint.Render(expected.data(), expected.size());
+  testAssert("The test blueprint finishes.", blueprint.IsFinished() && length > 44100 * 6 && length < 44100 * 6 + 5000);
+
+  {
+    std::vector<double> output(10000);
+    blueprint.Seek(100000 - history);
+    bool rendered = blueprint.Render(output.data(), static_cast<size_t>(history)) == static_cast<size_t>(history) && blueprint.Render(output.data(), output.size()) == output.size();
+    testAssert("Rendering after the history from a seek produces the same output as rendering from the start.", rendered &&
+               std::equal(output.cbegin(), output.cend(), expected.cbegin() + 100000, [](double a, double b) { return std::abs(a - b) < 0.000001; }));
+  }
+
+  fmsynth::ThreadPool pool(4);
+  fmsynth::ChunkedRenderer renderer(pool);
+  loaded = renderer.Load(json, 44100);
+  testAssert("Renderer is loaded.", loaded && renderer.GetHistoryLength() == history && renderer.GetChunkFrames() == fmsynth::ChunkedRenderer::MinChunkFrames);
+
+  std::vector<double> output(expected.size(), 0.0);
+  auto first = renderer.Render(output.data(), 1000);
+  auto rest = renderer.Render(output.data() + first, output.size() - first);
+  testAssert("Chunks are rendered until the blueprint finishes.", renderer.IsFinished() && first == 1000 && first + rest == length);
+  testAssert("Chunks produce the same output as rendering from the start.",
+             std::equal(output.cbegin(), output.cend(), expected.cbegin(), [](double a, double b) { return std::abs(a - b) < 0.000001; }));
+  testAssert("Finished renderer renders nothing.", renderer.Render(output.data(), output.size()) == 0);
+
+  auto unbounded = json11::Json::parse(R"({"links": [{"from": "c", "to": "o", "to_channel": "Form"}, {"from": "o", "to": "out", "to_channel": "Form"}], "nodes": [
+    {"constant": {"unit": 1, "value": 440}, "enabled": true, "node_id": "c", "node_type": "Constant"},
+    {"enabled": true, "node_id": "o", "node_type": "Oscillator", "oscillator_phase_accumulator": true, "oscillator_type": "Sine"},
+    {"audiodeviceoutput_muted": false, "audiodeviceoutput_volume": 0.5, "enabled": true, "node_id": "out", "node_type": "AudioDeviceOutput"}]})", error);
+  testAssert("Blueprint depending on all of its history is not loaded.", error.empty() && !renderer.Load(unbounded, 44100));
+}
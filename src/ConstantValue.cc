@@ -55,6 +55,12 @@ ConstantValue::Unit ConstantValue::GetUnit() const
 }
 
 
+bool ConstantValue::operator==(const ConstantValue & other) const
+{
+  return _unit == other._unit && !(_value < other._value) && !(_value > other._value);
+}
+
+
 json11::Json ConstantValue::to_json() const
 {
   return json11::Json::object {
@@ -35,6 +35,8 @@ namespace fmsynth
     [[nodiscard]] double GetUnitValue() const; // The value visible in API, UI and .sbp files.
     [[nodiscard]] Unit   GetUnit()      const;
 
+    [[nodiscard]] bool operator==(const ConstantValue & other) const; // Same value in the same unit.
+
     [[nodiscard]] json11::Json to_json() const;
     void                       SetFromJson(const json11::Json & json);
 
@@ -0,0 +1,126 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "FilterBank.hh"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+using namespace fmsynth;
+
+
+FilterBank::FilterBank(unsigned int channels)
+  : _channels(0)
+{
+  SetChannelCount(channels);
+}
+
+
+unsigned int FilterBank::GetChannelCount() const
+{
+  return _channels;
+}
+
+
+void FilterBank::SetChannelCount(unsigned int channels)
+{
+  _channels = channels;
+  _a1.resize(channels, 1);
+  _a2.resize(channels, 0);
+  _a3.resize(channels, 0);
+  _m0.resize(channels, 1);
+  _m1.resize(channels, 0);
+  _m2.resize(channels, 0);
+  _ic1eq.resize(channels, 0);
+  _ic2eq.resize(channels, 0);
+}
+
+
+void FilterBank::SetFilter(unsigned int channel, Mode mode, double cutoff, double resonance)
+{
+  assert(channel < _channels);
+  double g = std::tan(std::numbers::pi * std::clamp(cutoff, 0.00001, 0.49));
+  double k = 1.0 / std::max(resonance, 0.01);
+  double a1 = 1.0 / (1.0 + g * (g + k));
+  _a1[channel] = ToSample(a1);
+  _a2[channel] = ToSample(g * a1);
+  _a3[channel] = ToSample(g * g * a1);
+
+  auto m1 = ToSample(k);
+  switch(mode)
+    {
+    case Mode::LowPass:  _m0[channel] = 0; _m1[channel] = 0;   _m2[channel] = 1;  break;
+    case Mode::HighPass: _m0[channel] = 1; _m1[channel] = -m1; _m2[channel] = -1; break;
+    case Mode::BandPass: _m0[channel] = 0; _m1[channel] = m1;  _m2[channel] = 0;  break; // Unity gain at the cutoff.
+    case Mode::Notch:    _m0[channel] = 1; _m1[channel] = -m1; _m2[channel] = 0;  break;
+    }
+}
+
+
+void FilterBank::Reset()
+{
+  std::fill(_ic1eq.begin(), _ic1eq.end(), 0);
+  std::fill(_ic2eq.begin(), _ic2eq.end(), 0);
+}
+
+
+void FilterBank::Reset(unsigned int channel)
+{
+  assert(channel < _channels);
+  _ic1eq[channel] = 0;
+  _ic2eq[channel] = 0;
+}
+
+
+void FilterBank::CopyChannel(unsigned int channel, const FilterBank & source, unsigned int source_channel)
+{
+  assert(channel < _channels);
+  assert(source_channel < source._channels);
+  _a1[channel]    = source._a1[source_channel];
+  _a2[channel]    = source._a2[source_channel];
+  _a3[channel]    = source._a3[source_channel];
+  _m0[channel]    = source._m0[source_channel];
+  _m1[channel]    = source._m1[source_channel];
+  _m2[channel]    = source._m2[source_channel];
+  _ic1eq[channel] = source._ic1eq[source_channel];
+  _ic2eq[channel] = source._ic2eq[source_channel];
+}
+
+
+void FilterBank::Process(const sample_t * input, sample_t * output, unsigned int frames)
+{
+  auto a1 = _a1.data();
+  auto a2 = _a2.data();
+  auto a3 = _a3.data();
+  auto m0 = _m0.data();
+  auto m1 = _m1.data();
+  auto m2 = _m2.data();
+  auto ic1eq = _ic1eq.data();
+  auto ic2eq = _ic2eq.data();
+
+  for(unsigned int frame = 0; frame < frames; frame++)
+    {
+      auto in  = input  + frame * _channels;
+      auto out = output + frame * _channels;
+      for(unsigned int c = 0; c < _channels; c++)
+        {
+          sample_t v0 = in[c];
+          sample_t v3 = v0 - ic2eq[c];
+          sample_t v1 = a1[c] * ic1eq[c] + a2[c] * v3;
+          sample_t v2 = ic2eq[c] + a2[c] * ic1eq[c] + a3[c] * v3;
+          ic1eq[c] = 2 * v1 - ic1eq[c];
+          ic2eq[c] = 2 * v2 - ic2eq[c];
+          out[c] = m0[c] * v0 + m1[c] * v1 + m2[c] * v2;
+        }
+    }
+}
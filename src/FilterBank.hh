@@ -0,0 +1,66 @@
+#ifndef FILTER_BANK_HH_
+#define FILTER_BANK_HH_
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "Sample.hh"
+#include <vector>
+
+namespace fmsynth
+{
+  // Bank of state variable filters (trapezoidal integration), one filter per channel.
+  //
+  // A recursive filter can not be vectorized over time, so the bank advances all the channels
+  // one frame at a time. The coefficients and the state of the channels are stored in separate
+  // arrays (structure of arrays), so that the inner loop over the channels is vectorized.
+  // The filter mode is folded into the output mixing coefficients, so the loop does not branch.
+  class FilterBank
+  {
+  public:
+    enum class Mode
+      {
+        LowPass,
+        HighPass,
+        BandPass,
+        Notch
+      };
+
+    explicit FilterBank(unsigned int channels = 1);
+
+    [[nodiscard]] unsigned int GetChannelCount() const;
+    void                       SetChannelCount(unsigned int channels); // Added channels pass the input through until set.
+
+    // The cutoff is in cycles per frame (frequency / samples_per_second), the resonance is the Q factor.
+    void SetFilter(unsigned int channel, Mode mode, double cutoff, double resonance);
+    void Reset();
+    void Reset(unsigned int channel);
+    // Copies the coefficients and the state of a channel, for gathering the filters of several banks into one:
+    void CopyChannel(unsigned int channel, const FilterBank & source, unsigned int source_channel);
+
+    // The input and output are interleaved, the value of a channel of a frame is at [frame * channels + channel].
+    // The input and output may be the same array.
+    void Process(const sample_t * input, sample_t * output, unsigned int frames);
+
+  private:
+    unsigned int          _channels;
+    std::vector<sample_t> _a1;
+    std::vector<sample_t> _a2;
+    std::vector<sample_t> _a3;
+    std::vector<sample_t> _m0; // The output is _m0 * input + _m1 * band pass + _m2 * low pass.
+    std::vector<sample_t> _m1;
+    std::vector<sample_t> _m2;
+    std::vector<sample_t> _ic1eq;
+    std::vector<sample_t> _ic2eq;
+  };
+}
+
+#endif
@@ -0,0 +1,132 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "FilterBank.hh"
+#include "Test.hh"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+
+// The peak output of a sine wave input after the filter has settled:
+static double Gain(fmsynth::FilterBank::Mode mode, double cutoff, double frequency)
+{
+  fmsynth::FilterBank bank;
+  bank.SetFilter(0, mode, cutoff, std::numbers::sqrt2 / 2.0);
+
+  const unsigned int frames = 20000;
+  std::vector<fmsynth::sample_t> data(frames);
+  for(unsigned int i = 0; i < frames; i++)
+    data[i] = fmsynth::ToSample(std::cos(2.0 * std::numbers::pi * frequency * i));
+  bank.Process(data.data(), data.data(), frames);
+
+  double peak = 0;
+  for(unsigned int i = frames / 2; i < frames; i++)
+    peak = std::max(peak, std::abs(fmsynth::ToDouble(data[i])));
+  return peak;
+}
+
+
+static void Test()
+{
+  using Mode = fmsynth::FilterBank::Mode;
+
+  {
+    fmsynth::FilterBank bank(3);
+    std::vector<fmsynth::sample_t> input { 1, 2, 3, 4, 5, 6 };
+    std::vector<fmsynth::sample_t> output(input.size());
+    bank.Process(input.data(), output.data(), 2);
+    testAssert("Filters which are not set pass the input through.", output == input);
+  }
+
+  {
+    const double cutoff = 0.01;
+    double lp_dc   = Gain(Mode::LowPass,  cutoff, 0);
+    double lp_high = Gain(Mode::LowPass,  cutoff, 0.2);
+    double hp_dc   = Gain(Mode::HighPass, cutoff, 0);
+    double hp_high = Gain(Mode::HighPass, cutoff, 0.2);
+    double bp      = Gain(Mode::BandPass, cutoff, cutoff);
+    double notch   = Gain(Mode::Notch,    cutoff, cutoff);
+    double lp_cut  = Gain(Mode::LowPass,  cutoff, cutoff);
+    testComment << "low pass: dc=" << lp_dc << ", high=" << lp_high << ", cutoff=" << lp_cut << "\n";
+    testComment << "high pass: dc=" << hp_dc << ", high=" << hp_high << "\n";
+    testComment << "band pass=" << bp << ", notch=" << notch << "\n";
+    testAssert("Low pass passes DC.", FloatEqual(lp_dc, 1, 0.0001));
+    testAssert("Low pass attenuates high frequencies.", lp_high < 0.01);
+    testAssert("Low pass is at -3dB at the cutoff with Q 0.7071.", FloatEqual(lp_cut, std::numbers::sqrt2 / 2.0, 0.01));
+    testAssert("High pass blocks DC.", hp_dc < 0.0001);
+    testAssert("High pass passes high frequencies.", FloatEqual(hp_high, 1, 0.01));
+    testAssert("Band pass has unity gain at the cutoff.", FloatEqual(bp, 1, 0.01));
+    testAssert("Notch removes the cutoff frequency.", notch < 0.01);
+  }
+
+  {
+    // Interleaved channels with different settings give the same results as separate filters:
+    const unsigned int channels = 5;
+    const unsigned int frames = 1000;
+    const Mode modes[] { Mode::LowPass, Mode::HighPass, Mode::BandPass, Mode::Notch, Mode::LowPass };
+    fmsynth::FilterBank bank(channels);
+    std::vector<fmsynth::FilterBank> singles(channels);
+    for(unsigned int c = 0; c < channels; c++)
+      {
+        bank.SetFilter(c, modes[c], 0.01 + 0.05 * c, 0.5 + c);
+        singles[c].SetFilter(0, modes[c], 0.01 + 0.05 * c, 0.5 + c);
+      }
+
+    std::vector<fmsynth::sample_t> data(channels * frames);
+    for(unsigned int i = 0; i < data.size(); i++)
+      data[i] = fmsynth::ToSample(std::sin(0.1 * i) + std::sin(0.013 * i));
+    auto input = data;
+    bank.Process(data.data(), data.data(), frames);
+
+    double error = 0;
+    for(unsigned int c = 0; c < channels; c++)
+      for(unsigned int i = 0; i < frames; i++)
+        {
+          auto v = input[i * channels + c];
+          singles[c].Process(&v, &v, 1);
+          error = std::max(error, std::abs(fmsynth::ToDouble(v - data[i * channels + c])));
+        }
+    testAssert("Channels of a bank are independent.", error < 1e-12);
+
+    bank.Reset();
+    bank.Process(input.data(), input.data(), frames);
+    testAssert("Reset clears the state.", std::equal(input.cbegin(), input.cend(), data.cbegin(), [](fmsynth::sample_t a, fmsynth::sample_t b) { return FloatEqual(a, b, 0); }));
+  }
+
+  {
+    // Filters gathered from single channel banks in the middle of the input continue where they were:
+    fmsynth::FilterBank a, b, gathered(2);
+    a.SetFilter(0, Mode::LowPass,  0.02, 2);
+    b.SetFilter(0, Mode::BandPass, 0.05, 1);
+    std::vector<fmsynth::sample_t> signal(200);
+    for(unsigned int i = 0; i < signal.size(); i++)
+      signal[i] = fmsynth::ToSample(std::sin(0.1 * i));
+    auto va = signal, vb = signal;
+    a.Process(va.data(), va.data(), 100);
+    b.Process(vb.data(), vb.data(), 100);
+    gathered.CopyChannel(0, a, 0);
+    gathered.CopyChannel(1, b, 0);
+    a.Process(va.data() + 100, va.data() + 100, 100);
+    b.Process(vb.data() + 100, vb.data() + 100, 100);
+
+    std::vector<fmsynth::sample_t> data(2 * 100);
+    for(unsigned int i = 0; i < 100; i++)
+      data[i * 2] = data[i * 2 + 1] = signal[100 + i];
+    gathered.Process(data.data(), data.data(), 100);
+    bool same = true;
+    for(unsigned int i = 0; i < 100; i++)
+      same = same && FloatEqual(data[i * 2], va[100 + i], 0) && FloatEqual(data[i * 2 + 1], vb[100 + i], 0);
+    testAssert("CopyChannel() copies the coefficients and the state.", same);
+  }
+}
@@ -30,6 +30,12 @@ void Input::SetDefaultValue(double new_default_value)
 }
 
 
+double Input::GetDefaultValue() const
+{
+  return _default_value;
+}
+
+
 bool Input::IsReady() const
 {
   assert(_input_count <= _input_nodes.size());
@@ -64,6 +70,13 @@ void Input::Reset()
   _input_count = 0;
 }
 
+void Input::SetValue(double value)
+{
+  _value = value;
+  _input_count = static_cast<unsigned int>(_input_nodes.size());
+}
+
+
 void Input::AddInputNode(Node * node)
 {
   _input_nodes.push_back(node);
@@ -111,13 +124,24 @@ const std::vector<Node *> & Input::GetInputNodes() const
 }
 
 
+Input::Range Input::GetValueRange(double min, double max)
+{
+  if(min >= 0 && max <= 1)
+    return Range::Zero_One;
+  else if(min >= -1 && max <= 1)
+    return Range::MinusOne_One;
+  else
+    return Range::Inf_Inf;
+}
+
+
 Input::Range Input::GetInputRange() const
 {
   Range range = Range::Zero_One;
   for(auto node : _input_nodes)
     if(node)
       {
-        auto r = node->GetFormOutputRange();
+        auto r = node->GetCachedFormOutputRange();
         switch(r)
           {
           case Range::Inf_Inf:
@@ -137,31 +161,49 @@ Input::Range Input::GetInputRange() const
 
 double Input::NormalizeInputValue(const Node * source, double value) const
 {
-  if(!source)
+  if(!source || _input_range == Range::Inf_Inf)
     return value;
   
-  switch(source->GetFormOutputRange())
+  auto [scale, offset] = GetNormalization(source);
+  return value * scale + offset;
+}
+
+
+std::tuple<double, double> Input::GetNormalization(const Node * source) const
+{
+  assert(source);
+  
+  switch(source->GetCachedFormOutputRange())
     {
     case Range::Zero_One:
       switch(_input_range)
         {
-        case Range::Zero_One:     return value;
-        case Range::MinusOne_One: return value * 2.0 - 1.0;
-        case Range::Inf_Inf:      return value;
+        case Range::Zero_One:     return { 1.0,  0.0 };
+        case Range::MinusOne_One: return { 2.0, -1.0 };
+        case Range::Inf_Inf:      return { 1.0,  0.0 };
         }
       break;
     case Range::MinusOne_One:
       switch(_input_range)
         {
-        case Range::Zero_One:     return value * 0.5 + 0.5;
-        case Range::MinusOne_One: return value;
-        case Range::Inf_Inf:      return value;
+        case Range::Zero_One:     return { 0.5,  0.5 };
+        case Range::MinusOne_One: return { 1.0,  0.0 };
+        case Range::Inf_Inf:      return { 1.0,  0.0 };
         }
       break;
     case Range::Inf_Inf:
-      return value;
+      return { 1.0, 0.0 };
     }
 
   assert(false);
-  return value;
+  return { 1.0, 0.0 };
+}
+
+
+bool Input::IsNormalizationIdentity(const Node * source) const
+{
+  assert(source);
+
+  auto range = source->GetCachedFormOutputRange();
+  return range == Range::Inf_Inf || _input_range == Range::Inf_Inf || range == _input_range;
 }
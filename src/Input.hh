@@ -12,6 +12,7 @@
   Complete license can be found in the LICENSE file.
 */
 
+#include <tuple>
 #include <vector>
 
 namespace fmsynth
@@ -29,8 +30,11 @@ namespace fmsynth
         Zero_One
       };
   
+    [[nodiscard]] static Range GetValueRange(double min, double max); // The narrowest range holding the values from min to max.
+
     void SetInputRange(Range range);
     void SetDefaultValue(double new_default_value);
+    [[nodiscard]] double GetDefaultValue() const;
   
     void AddInputNode(Node * node);
     void RemoveInputNode(Node * node);
@@ -42,6 +46,11 @@ namespace fmsynth
     [[nodiscard]] double GetValue()       const;
     [[nodiscard]] Range  GetInputRange()  const;
     void   Reset();
+    void   SetValue(double value); // Set the value as if all the input nodes had been input.
+
+    // The normalization of the values from source to the range of this input is: value * scale + offset
+    [[nodiscard]] std::tuple<double, double> GetNormalization(const Node * source) const; // Returns scale and offset.
+    [[nodiscard]] bool                       IsNormalizationIdentity(const Node * source) const;
 
     [[nodiscard]] const std::vector<Node *> & GetInputNodes()  const;
 
@@ -92,6 +92,22 @@ static void Test()
     inp.InputMultiply(&node, v2);
     testAssert("GetValue() returns the two values added with InputMultiply().", FloatEqual(inp.GetValue(), v1 * v2, 0.00001));
   }
+  {
+    MockNode node;
+    node.PublicSetOutputRange(fmsynth::Input::Range::Zero_One);
+    fmsynth::Input inp1;
+    inp1.SetInputRange(fmsynth::Input::Range::MinusOne_One);
+    inp1.AddInputNode(&node);
+    inp1.InputAdd(&node, 0.5);
+    node.PublicSetOutputRange(fmsynth::Input::Range::MinusOne_One);
+    fmsynth::Input inp2;
+    inp2.SetInputRange(fmsynth::Input::Range::Zero_One);
+    inp2.AddInputNode(&node);
+    inp2.InputAdd(&node, 0.5);
+    testComment << "inp1=" << inp1.GetValue() << ", inp2=" << inp2.GetValue() << "\n";
+    testAssert("Normalization follows the changes of the output range of the source.",
+               FloatEqual(inp1.GetValue(), 0, 0.00001) && FloatEqual(inp2.GetValue(), 0.75, 0.00001));
+  }
   {
     std::vector<std::tuple<fmsynth::Input::Range, fmsynth::Input::Range, double, double>> values
       {
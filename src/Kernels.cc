@@ -0,0 +1,476 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "Kernels.hh"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numbers>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+# define LIBFMSYNTH_KERNELS_X86 1
+#else
+# define LIBFMSYNTH_KERNELS_X86 0
+#endif
+
+using namespace fmsynth::kernels;
+
+
+namespace
+{
+  // GCC vector extensions, the width is limited by the instruction set the function using them is compiled for.
+#if defined(__GNUC__) || defined(__clang__)
+  typedef double   v2d __attribute__((vector_size(16)));
+  typedef uint64_t v2u __attribute__((vector_size(16)));
+  typedef double   v4d __attribute__((vector_size(32)));
+  typedef uint64_t v4u __attribute__((vector_size(32)));
+  typedef double   v8d __attribute__((vector_size(64)));
+  typedef uint64_t v8u __attribute__((vector_size(64)));
+#else
+  typedef double   v2d;
+  typedef uint64_t v2u;
+#endif
+
+  template <class V> struct Bits;
+  template <> struct Bits<double> { typedef uint64_t type; };
+#if defined(__GNUC__) || defined(__clang__)
+  template <> struct Bits<v2d>    { typedef v2u      type; };
+  template <> struct Bits<v4d>    { typedef v4u      type; };
+  template <> struct Bits<v8d>    { typedef v8u      type; };
+#endif
+
+  // Adding this rounds to the nearest integer, and leaves the integer in the low bits of the mantissa.
+  constexpr double RoundMagic = 6755399441055744.0; // 1.5 * 2^52
+
+  // Pi split into parts with at most 25 significant bits (Cody-Waite), k * PiA etc. are exact for |k| < 2^28.
+  constexpr double PiA = 3.1415926218032836914;
+  constexpr double PiB = 3.1786509424591713469e-08;
+  constexpr double PiC = 1.2246467864107188502e-16;
+  constexpr double PiD = 1.2736634327021899816e-24;
+
+  // Taylor series of sin(r), accurate to 1e-18 for |r| <= pi/2.
+  constexpr double S3  = -1.0 / 6.0;
+  constexpr double S5  =  1.0 / 120.0;
+  constexpr double S7  = -1.0 / 5040.0;
+  constexpr double S9  =  1.0 / 362880.0;
+  constexpr double S11 = -1.0 / 39916800.0;
+  constexpr double S13 =  1.0 / 6227020800.0;
+  constexpr double S15 = -1.0 / 1307674368000.0;
+  constexpr double S17 =  1.0 / 355687428096000.0;
+  constexpr double S19 = -1.0 / 121645100408832000.0;
+  constexpr double S21 =  1.0 / 51090942171709440000.0;
+
+
+  // The vectors are passed by reference and converted with __builtin_bit_cast(), because passing
+  // them by value to a function depends on the instruction set.
+
+  // Reduce x to r = x - k * pi, |r| <= pi/2, sin(x) = (-1)^k * sin(r). The sign is the sign bit for (-1)^k.
+  template <class V> [[gnu::always_inline]] inline void ReducePi(const V & x, V & r, typename Bits<V>::type & sign)
+  {
+    typedef typename Bits<V>::type U;
+    V q = x * std::numbers::inv_pi + RoundMagic;
+    V k = q - RoundMagic;
+    r = x - k * PiA;
+    r = r - k * PiB;
+    r = r - k * PiC;
+    r = r - k * PiD;
+    sign = __builtin_bit_cast(U, q) << 63;
+  }
+
+
+  template <class V> [[gnu::always_inline]] inline void SineValue(const V & x, V & y)
+  {
+    typedef typename Bits<V>::type U;
+    V r;
+    U sign;
+    ReducePi(x, r, sign);
+    V r2 = r * r;
+    V p = S21 * r2 + S19;
+    p = p * r2 + S17;
+    p = p * r2 + S15;
+    p = p * r2 + S13;
+    p = p * r2 + S11;
+    p = p * r2 + S9;
+    p = p * r2 + S7;
+    p = p * r2 + S5;
+    p = p * r2 + S3;
+    V s = r + r * r2 * p;
+    y = __builtin_bit_cast(V, __builtin_bit_cast(U, s) ^ sign);
+  }
+
+
+  template <class V> [[gnu::always_inline]] inline void TriangleValue(const V & x, V & y)
+  { // asin(sin(x)) = (-1)^k * r
+    typedef typename Bits<V>::type U;
+    V r;
+    U sign;
+    ReducePi(x, r, sign);
+    V t = r * (2.0 / std::numbers::pi);
+    y = __builtin_bit_cast(V, __builtin_bit_cast(U, t) ^ sign);
+  }
+
+
+  constexpr uint64_t NoiseGamma = 0x9E3779B97F4A7C15;
+
+  template <class U> [[gnu::always_inline]] inline void Mix(U & z)
+  { // SplitMix64 finalizer.
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    z = z ^ (z >> 31);
+  }
+
+  uint64_t NoiseKey(uint64_t seed)
+  {
+    Mix(seed);
+    return seed;
+  }
+
+  template <class V> [[gnu::always_inline]] inline void NoiseValue(const typename Bits<V>::type & position, uint64_t key, V & y)
+  { // The top 52 bits are used as the mantissa of a number in range [1, 2).
+    typedef typename Bits<V>::type U;
+    U z = position * NoiseGamma + key;
+    Mix(z);
+    U bits = (z >> 12) | 0x3FF0000000000000;
+    y = __builtin_bit_cast(V, bits) * 2.0 - 3.0;
+  }
+
+  template <class V> [[gnu::always_inline]] inline void ApplyNoise(uint64_t key, uint64_t position, double * output, unsigned int count)
+  {
+    typedef typename Bits<V>::type U;
+    constexpr unsigned int width = sizeof(V) / sizeof(double);
+    unsigned int i = 0;
+    if constexpr(width > 1)
+      {
+        U lanes;
+        for(unsigned int j = 0; j < width; j++)
+          lanes[j] = position + j;
+        for(; i + width <= count; i += width)
+          {
+            V y;
+            NoiseValue(lanes, key, y);
+            std::memcpy(output + i, &y, sizeof y);
+            lanes += width;
+          }
+      }
+    for(; i < count; i++)
+      {
+        double y;
+        NoiseValue<double>(position + i, key, y);
+        output[i] = y;
+      }
+  }
+
+
+  enum class Wave { Sine, Triangle };
+
+  template <Wave W, class V> [[gnu::always_inline]] inline void Evaluate(const V & x, V & y)
+  {
+    if constexpr(W == Wave::Sine)
+      SineValue(x, y);
+    else
+      TriangleValue(x, y);
+  }
+
+
+  template <Wave W, class V> [[gnu::always_inline]] inline void Apply(const double * input, double * output, unsigned int count)
+  {
+    constexpr unsigned int width = sizeof(V) / sizeof(double);
+    unsigned int i = 0;
+    for(; i + width <= count; i += width)
+      {
+        V x, y;
+        std::memcpy(&x, input + i, sizeof x);
+        Evaluate<W>(x, y);
+        std::memcpy(output + i, &y, sizeof y);
+      }
+    for(; i < count; i++)
+      {
+        double y;
+        Evaluate<W>(input[i], y);
+        output[i] = y;
+      }
+  }
+
+
+  void SineReference(const double * input, double * output, unsigned int count)
+  {
+    for(unsigned int i = 0; i < count; i++)
+      output[i] = std::sin(input[i]);
+  }
+
+  void TriangleReference(const double * input, double * output, unsigned int count)
+  {
+    for(unsigned int i = 0; i < count; i++)
+      output[i] = 2.0 / std::numbers::pi * std::asin(std::sin(input[i]));
+  }
+
+  void NoiseReference(uint64_t key, uint64_t position, double * output, unsigned int count)
+  {
+    ApplyNoise<double>(key, position, output, count);
+  }
+
+  void SineGeneric(const double * input, double * output, unsigned int count)     { Apply<Wave::Sine,     v2d>(input, output, count); }
+  void TriangleGeneric(const double * input, double * output, unsigned int count) { Apply<Wave::Triangle, v2d>(input, output, count); }
+  void NoiseGeneric(uint64_t key, uint64_t position, double * output, unsigned int count) { ApplyNoise<v2d>(key, position, output, count); }
+
+#if LIBFMSYNTH_KERNELS_X86
+  __attribute__((target("sse2")))        void SineSSE2(const double * input, double * output, unsigned int count)       { Apply<Wave::Sine,     v2d>(input, output, count); }
+  __attribute__((target("sse2")))        void TriangleSSE2(const double * input, double * output, unsigned int count)   { Apply<Wave::Triangle, v2d>(input, output, count); }
+  __attribute__((target("avx2,fma")))    void SineAVX2(const double * input, double * output, unsigned int count)       { Apply<Wave::Sine,     v4d>(input, output, count); }
+  __attribute__((target("avx2,fma")))    void TriangleAVX2(const double * input, double * output, unsigned int count)   { Apply<Wave::Triangle, v4d>(input, output, count); }
+  __attribute__((target("avx512f,fma"))) void SineAVX512(const double * input, double * output, unsigned int count)     { Apply<Wave::Sine,     v8d>(input, output, count); }
+  __attribute__((target("avx512f,fma"))) void TriangleAVX512(const double * input, double * output, unsigned int count) { Apply<Wave::Triangle, v8d>(input, output, count); }
+  __attribute__((target("sse2")))        void NoiseSSE2(uint64_t key, uint64_t position, double * output, unsigned int count)   { ApplyNoise<v2d>(key, position, output, count); }
+  __attribute__((target("avx2,fma")))    void NoiseAVX2(uint64_t key, uint64_t position, double * output, unsigned int count)   { ApplyNoise<v4d>(key, position, output, count); }
+  __attribute__((target("avx512f,fma"))) void NoiseAVX512(uint64_t key, uint64_t position, double * output, unsigned int count) { ApplyNoise<v8d>(key, position, output, count); }
+#endif
+
+
+  struct Table
+  {
+    void (*sine)(const double * input, double * output, unsigned int count);
+    void (*triangle)(const double * input, double * output, unsigned int count);
+    void (*noise)(uint64_t key, uint64_t position, double * output, unsigned int count);
+  };
+
+  const Table & GetTable(Isa isa)
+  {
+    static const Table reference { SineReference, TriangleReference, NoiseReference };
+    static const Table generic   { SineGeneric,   TriangleGeneric,   NoiseGeneric   };
+#if LIBFMSYNTH_KERNELS_X86
+    static const Table sse2      { SineSSE2,      TriangleSSE2,      NoiseSSE2      };
+    static const Table avx2      { SineAVX2,      TriangleAVX2,      NoiseAVX2      };
+    static const Table avx512    { SineAVX512,    TriangleAVX512,    NoiseAVX512    };
+#endif
+    switch(isa)
+      {
+      case Isa::Reference: return reference;
+      case Isa::Generic:   return generic;
+#if LIBFMSYNTH_KERNELS_X86
+      case Isa::SSE2:      return sse2;
+      case Isa::AVX2:      return avx2;
+      case Isa::AVX512:    return avx512;
+#else
+      case Isa::SSE2:
+      case Isa::AVX2:
+      case Isa::AVX512:
+        break;
+#endif
+      }
+    assert(false);
+    return reference;
+  }
+
+
+  std::atomic<Isa> & CurrentIsa()
+  {
+    static std::atomic<Isa> isa { GetBestIsa() };
+    return isa;
+  }
+
+
+  bool IsInRange(const double * input, unsigned int count)
+  {
+    for(unsigned int i = 0; i < count; i++)
+      if(!(std::abs(input[i]) < MaxPhase))
+        return false;
+    return true;
+  }
+
+
+  const Table & GetTable(const double * input, unsigned int count)
+  {
+    auto isa = CurrentIsa().load(std::memory_order_relaxed);
+    if(isa != Isa::Reference && !IsInRange(input, count))
+      isa = Isa::Reference;
+    return GetTable(isa);
+  }
+}
+
+
+
+Isa fmsynth::kernels::GetIsa()
+{
+  return CurrentIsa().load(std::memory_order_relaxed);
+}
+
+
+Isa fmsynth::kernels::GetBestIsa()
+{
+  for(auto isa : { Isa::AVX512, Isa::AVX2, Isa::SSE2 })
+    if(IsSupported(isa))
+      return isa;
+  return Isa::Generic;
+}
+
+
+bool fmsynth::kernels::IsSupported(Isa isa)
+{
+  switch(isa)
+    {
+    case Isa::Reference:
+    case Isa::Generic:
+      return true;
+#if LIBFMSYNTH_KERNELS_X86
+    case Isa::SSE2:   return __builtin_cpu_supports("sse2");
+    case Isa::AVX2:   return __builtin_cpu_supports("avx2")    && __builtin_cpu_supports("fma");
+    case Isa::AVX512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("fma");
+#else
+    case Isa::SSE2:
+    case Isa::AVX2:
+    case Isa::AVX512:
+      return false;
+#endif
+    }
+  assert(false);
+  return false;
+}
+
+
+bool fmsynth::kernels::SetIsa(Isa isa)
+{
+  if(!IsSupported(isa))
+    return false;
+
+  CurrentIsa().store(isa, std::memory_order_relaxed);
+  return true;
+}
+
+
+std::string fmsynth::kernels::IsaToName(Isa isa)
+{
+  switch(isa)
+    {
+    case Isa::Reference: return "Reference";
+    case Isa::Generic:   return "Generic";
+    case Isa::SSE2:      return "SSE2";
+    case Isa::AVX2:      return "AVX2";
+    case Isa::AVX512:    return "AVX512";
+    }
+  assert(false);
+  return "UnknownIsa" + std::to_string(static_cast<int>(isa)) + "Error";
+}
+
+
+void fmsynth::kernels::Sine(const double * phase, double * output, unsigned int count)
+{
+  GetTable(phase, count).sine(phase, output, count);
+}
+
+
+void fmsynth::kernels::Triangle(const double * phase, double * output, unsigned int count)
+{
+  GetTable(phase, count).triangle(phase, output, count);
+}
+
+
+void fmsynth::kernels::Pulse(const double * phase, double duty, double * output, unsigned int count)
+{
+  if(duty <= -1)
+    {
+      std::fill_n(output, count, -1.0);
+      return;
+    }
+
+  Sine(phase, output, count);
+  for(unsigned int i = 0; i < count; i++)
+    output[i] = output[i] <= duty ? 1.0 : -1.0;
+}
+
+
+void fmsynth::kernels::Pulse(const double * phase, const double * duty, double * output, unsigned int count)
+{
+  Sine(phase, output, count);
+  for(unsigned int i = 0; i < count; i++)
+    output[i] = duty[i] <= -1 ? -1.0 : (output[i] <= duty[i] ? 1.0 : -1.0);
+}
+
+
+double fmsynth::kernels::PolyBlep(double t, double dt)
+{
+  if(t < dt)
+    {
+      double x = t / dt;
+      return x + x - x * x - 1.0;
+    }
+  if(t > 1.0 - dt)
+    {
+      double x = (t - 1.0) / dt;
+      return x * x + x + x + 1.0;
+    }
+  return 0;
+}
+
+
+namespace
+{
+  double Cycles(double phase)
+  {
+    double t = phase * (0.5 / std::numbers::pi);
+    return t - std::floor(t);
+  }
+
+  double CycleIncrement(double increment)
+  { // The residuals of the two sides of a step overlap above the Nyquist frequency.
+    return std::min(std::abs(increment) * (0.5 / std::numbers::pi), 0.5);
+  }
+}
+
+
+double fmsynth::kernels::Sawtooth(double phase, double increment)
+{
+  double t = Cycles(phase + std::numbers::pi);
+  return 2.0 * t - 1.0 - PolyBlep(t, CycleIncrement(increment));
+}
+
+
+double fmsynth::kernels::PulseEdges(double phase, double increment, double duty)
+{
+  if(duty <= -1 || duty >= 1)
+    return 0;
+
+  // sin(phase) <= duty rises from -1 to 1 at pi - asin(duty), and falls back to -1 at asin(duty):
+  double edge = std::asin(duty);
+  double dt = CycleIncrement(increment);
+  return PolyBlep(Cycles(phase - std::numbers::pi + edge), dt) - PolyBlep(Cycles(phase - edge), dt);
+}
+
+
+void fmsynth::kernels::Sawtooth(const double * phase, const double * frequency, double samples_per_second, double * output, unsigned int count)
+{
+  for(unsigned int i = 0; i < count; i++)
+    output[i] = Sawtooth(phase[i], frequency[i] / samples_per_second);
+}
+
+
+void fmsynth::kernels::PulseEdges(const double * phase, const double * frequency, double samples_per_second, const double * duty, double * output, unsigned int count)
+{
+  for(unsigned int i = 0; i < count; i++)
+    output[i] += PulseEdges(phase[i], frequency[i] / samples_per_second, duty[i]);
+}
+
+
+double fmsynth::kernels::Noise(uint64_t seed, uint64_t position)
+{
+  double y;
+  NoiseValue<double>(position, NoiseKey(seed), y);
+  return y;
+}
+
+
+void fmsynth::kernels::Noise(uint64_t seed, uint64_t position, double * output, unsigned int count)
+{
+  GetTable(CurrentIsa().load(std::memory_order_relaxed)).noise(NoiseKey(seed), position, output, count);
+}
@@ -0,0 +1,69 @@
+#ifndef KERNELS_HH_
+#define KERNELS_HH_
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include <cstdint>
+#include <string>
+
+// Block kernels for the oscillator waveforms.
+//
+// The kernels evaluate the waveforms with polynomial approximations using SIMD instructions.
+// The instruction set is selected at runtime by CPUID, the Reference instruction set uses
+// the scalar libm functions and matches the output of the per frame oscillator code.
+//
+// Maximum absolute error compared to the Reference, for |phase| < MaxPhase:
+//   Sine:     4e-16
+//   Triangle: 1e-8 near the peaks, where asin() of the Reference loses precision, elsewhere 2e-12
+// Values with |phase| >= MaxPhase are evaluated using the Reference code.
+// Different instruction sets may produce results that differ in the last bit.
+namespace fmsynth::kernels
+{
+  enum class Isa
+    {
+      Reference,
+      Generic,
+      SSE2,
+      AVX2,
+      AVX512
+    };
+
+  constexpr double MaxPhase = 1.0e8;
+
+  [[nodiscard]] Isa         GetIsa();
+  [[nodiscard]] Isa         GetBestIsa();
+  [[nodiscard]] bool        IsSupported(Isa isa);
+  [[nodiscard]] bool        SetIsa(Isa isa); // Returns false if the isa is not supported by the CPU.
+  [[nodiscard]] std::string IsaToName(Isa isa);
+
+  // The phase is in radians, the input and output arrays may be the same array.
+  void Sine(const double * phase, double * output, unsigned int count);                       // sin(phase)
+  void Triangle(const double * phase, double * output, unsigned int count);                   // 2/pi * asin(sin(phase))
+  void Pulse(const double * phase, double duty, double * output, unsigned int count);         // sin(phase) <= duty ? 1 : -1
+  void Pulse(const double * phase, const double * duty, double * output, unsigned int count);
+
+  // Band-limited waveforms using PolyBLEP, the cost does not depend on the frequency.
+  // The increment is the change of the phase per frame, frequency / samples_per_second, in radians.
+  [[nodiscard]] double PolyBlep(double t, double dt); // Residual for a step of -2 at t = 0, t and dt are in cycles.
+  [[nodiscard]] double Sawtooth(double phase, double increment);                  // Rises from -1 to 1 as the phase goes from -pi to pi.
+  [[nodiscard]] double PulseEdges(double phase, double increment, double duty);   // Add to Pulse() to band-limit it.
+  void Sawtooth(const double * phase, const double * frequency, double samples_per_second, double * output, unsigned int count);
+  void PulseEdges(const double * phase, const double * frequency, double samples_per_second, const double * duty, double * output, unsigned int count); // Adds to the output.
+
+  // Counter based white noise in range [-1, 1), SplitMix64 of the seed and the position.
+  // The value depends only on the seed and the position, so any position can be generated
+  // without generating the values before it, and all the instruction sets give the same values.
+  [[nodiscard]] double Noise(uint64_t seed, uint64_t position);
+  void                 Noise(uint64_t seed, uint64_t position, double * output, unsigned int count); // Positions position ... position + count - 1.
+}
+
+#endif
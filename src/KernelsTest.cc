@@ -0,0 +1,184 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "Kernels.hh"
+#include "Test.hh"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+
+
+static void Test()
+{
+  using fmsynth::kernels::Isa;
+
+  testComment << "best isa=" << fmsynth::kernels::IsaToName(fmsynth::kernels::GetBestIsa()) << "\n";
+  testAssert("The best instruction set is selected by default.", fmsynth::kernels::GetIsa() == fmsynth::kernels::GetBestIsa());
+
+  // Phases of audible frequencies at the start of the range, and random phases over the whole range:
+  std::vector<double> phase;
+  for(unsigned int i = 0; i < 100001; i++)
+    phase.push_back(2.0 * std::numbers::pi * static_cast<double>(i) / 1000.0);
+  std::mt19937_64 generator(0);
+  std::uniform_real_distribution<double> dist(-fmsynth::kernels::MaxPhase, fmsynth::kernels::MaxPhase);
+  for(unsigned int i = 0; i < 100001; i++)
+    phase.push_back(dist(generator));
+  auto count = static_cast<unsigned int>(phase.size());
+
+  std::vector<double> sine(phase.size());
+  std::vector<double> triangle(phase.size());
+  for(unsigned int i = 0; i < count; i++)
+    {
+      sine[i]     = std::sin(phase[i]);
+      triangle[i] = 2.0 / std::numbers::pi * std::asin(std::sin(phase[i]));
+    }
+
+  for(auto isa : { Isa::Reference, Isa::Generic, Isa::SSE2, Isa::AVX2, Isa::AVX512 })
+    {
+      auto name = fmsynth::kernels::IsaToName(isa);
+      if(!fmsynth::kernels::SetIsa(isa))
+        {
+          testSkip(name + " sine kernel is accurate.",     "Not supported by the CPU.");
+          testSkip(name + " triangle kernel is accurate.", "Not supported by the CPU.");
+          testSkip(name + " pulse kernel matches the sine kernel.", "Not supported by the CPU.");
+          continue;
+        }
+
+      std::vector<double> output(phase.size());
+      double sine_error = 0;
+      fmsynth::kernels::Sine(phase.data(), output.data(), count);
+      for(unsigned int i = 0; i < count; i++)
+        sine_error = std::max(sine_error, std::abs(output[i] - sine[i]));
+
+      double triangle_error = 0;
+      output = phase;
+      fmsynth::kernels::Triangle(output.data(), output.data(), count); // In place.
+      for(unsigned int i = 0; i < count; i++)
+        triangle_error = std::max(triangle_error, std::abs(output[i] - triangle[i]));
+
+      testComment << name << ": sine error=" << sine_error << ", triangle error=" << triangle_error << "\n";
+      testAssert(name + " sine kernel is accurate.",     sine_error     <= 4e-16);
+      testAssert(name + " triangle kernel is accurate.", triangle_error <= 1e-8);
+
+      bool pulse_ok = true;
+      std::vector<double> duty(phase.size());
+      for(unsigned int i = 0; i < count; i++)
+        duty[i] = static_cast<double>(i % 5) * 0.5 - 1.0;
+      fmsynth::kernels::Sine(phase.data(), sine.data(), count);
+      fmsynth::kernels::Pulse(phase.data(), duty.data(), output.data(), count);
+      for(unsigned int i = 0; i < count; i++)
+        {
+          double expected = duty[i] <= -1 ? -1.0 : (sine[i] <= duty[i] ? 1.0 : -1.0);
+          if(output[i] < expected || output[i] > expected)
+            pulse_ok = false;
+        }
+      fmsynth::kernels::Pulse(phase.data(), 0.0, output.data(), count);
+      for(unsigned int i = 0; i < count; i++)
+        {
+          double expected = sine[i] <= 0.0 ? 1.0 : -1.0;
+          if(output[i] < expected || output[i] > expected)
+            pulse_ok = false;
+        }
+      testAssert(name + " pulse kernel matches the sine kernel.", pulse_ok);
+
+      for(unsigned int i = 0; i < count; i++)
+        sine[i] = std::sin(phase[i]);
+    }
+  testAssert("Instruction set can be reset to the best one.", fmsynth::kernels::SetIsa(fmsynth::kernels::GetBestIsa()));
+
+  {
+    const uint64_t seed = 1234;
+    const uint64_t start = 1000000007;
+    std::vector<double> expected(1001);
+    for(unsigned int i = 0; i < expected.size(); i++)
+      expected[i] = fmsynth::kernels::Noise(seed, start + i);
+
+    bool same = true;
+    for(auto isa : { Isa::Reference, Isa::Generic, Isa::SSE2, Isa::AVX2, Isa::AVX512 })
+      if(fmsynth::kernels::SetIsa(isa))
+        {
+          std::vector<double> output(expected.size());
+          fmsynth::kernels::Noise(seed, start, output.data(), static_cast<unsigned int>(output.size()));
+          // Generating from a later position gives the same values as skipping the values before it:
+          fmsynth::kernels::Noise(seed, start + 3, output.data() + 3, 500);
+          for(unsigned int i = 0; i < output.size(); i++)
+            if(output[i] < expected[i] || output[i] > expected[i])
+              same = false;
+        }
+    (void) fmsynth::kernels::SetIsa(fmsynth::kernels::GetBestIsa());
+    testAssert("Noise is the same for all the instruction sets and positions.", same);
+
+    std::vector<double> noise(100000);
+    std::vector<double> other(noise.size());
+    fmsynth::kernels::Noise(seed,     0, noise.data(), static_cast<unsigned int>(noise.size()));
+    fmsynth::kernels::Noise(seed + 1, 0, other.data(), static_cast<unsigned int>(other.size()));
+    double sum = 0;
+    double product = 0;
+    bool inrange = true;
+    for(unsigned int i = 0; i < noise.size(); i++)
+      {
+        sum += noise[i];
+        product += noise[i] * other[i];
+        if(noise[i] < -1.0 || !(noise[i] < 1.0))
+          inrange = false;
+      }
+    double mean = sum / static_cast<double>(noise.size());
+    double correlation = product / static_cast<double>(noise.size()) * 3.0; // The variance is 1/3.
+    testComment << "mean=" << mean << ", correlation=" << correlation << "\n";
+    testAssert("Noise is in range [-1, 1).", inrange);
+    testAssert("Noise has zero mean.", std::abs(mean) < 0.01);
+    testAssert("Noise with different seeds is not correlated.", std::abs(correlation) < 0.02);
+  }
+
+  {
+    std::vector<double> large { fmsynth::kernels::MaxPhase * 4.0, -fmsynth::kernels::MaxPhase * 1000.0, 1.0 };
+    std::vector<double> output(large.size());
+    fmsynth::kernels::Sine(large.data(), output.data(), static_cast<unsigned int>(large.size()));
+    bool ok = true;
+    for(unsigned int i = 0; i < large.size(); i++)
+      if(!FloatEqual(output[i], std::sin(large[i]), 0.0))
+        ok = false;
+    testAssert("Phases outside the supported range are evaluated using the reference code.", ok);
+  }
+
+  {
+    const double sps = 44100;
+    const unsigned int frames = 44100;
+    std::vector<double> frequency(frames, 2.0 * std::numbers::pi * 1234.5);
+    std::vector<double> phases(frames);
+    for(unsigned int i = 0; i < frames; i++)
+      phases[i] = frequency[i] * static_cast<double>(i) / sps;
+    std::vector<double> duty(frames, 0.4);
+
+    std::vector<double> sawtooth(frames);
+    std::vector<double> pulse(frames);
+    fmsynth::kernels::Sawtooth(phases.data(), frequency.data(), sps, sawtooth.data(), frames);
+    fmsynth::kernels::Pulse(phases.data(), duty.data(), pulse.data(), frames);
+    fmsynth::kernels::PulseEdges(phases.data(), frequency.data(), sps, duty.data(), pulse.data(), frames);
+
+    double sawtooth_step = 0;
+    double pulse_step = 0;
+    double peak = 0;
+    for(unsigned int i = 1; i < frames; i++)
+      {
+        sawtooth_step = std::max(sawtooth_step, std::abs(sawtooth[i] - sawtooth[i - 1]));
+        pulse_step    = std::max(pulse_step,    std::abs(pulse[i] - pulse[i - 1]));
+        peak = std::max({ peak, std::abs(sawtooth[i]), std::abs(pulse[i]) });
+      }
+    testComment << "sawtooth step=" << sawtooth_step << ", pulse step=" << pulse_step << ", peak=" << peak << "\n";
+    testAssert("Band-limited sawtooth spreads the discontinuity over two frames.", sawtooth_step < 1.75);
+    testAssert("Band-limited pulse spreads the edges over two frames.", pulse_step < 1.75);
+    testAssert("Band-limited waveforms stay in range [-1, 1].", peak <= 1.0);
+  }
+}
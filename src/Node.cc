@@ -11,23 +11,34 @@
 */
 
 #include "Node.hh"
+#include "Blueprint.hh"
+#include <algorithm>
 #include <cassert>
 #include <climits>
 
 using namespace fmsynth;
 
 
-unsigned long Node::_next_id = 1;
+std::atomic<unsigned long> Node::_next_id = 1;
+std::atomic<unsigned long> Node::_graph_revision = 1;
 
 
 Node::Node(const std::string & type)
   : _type(type),
-    _id(std::to_string(_next_id)),
+    _id(std::to_string(_next_id.load())),
+    _blueprint(nullptr),
     _preprocess_amplitude(false),
     _enabled(true),
     _samples_per_second(0),
     _finished(false),
-    _output_range(Input::Range::Inf_Inf)
+    _time_index(0),
+    _finished_time_index(0),
+    _eof_deferred(false),
+    _eof_pending(false),
+    _skipping(false),
+    _output_range(Input::Range::Inf_Inf),
+    _cached_range_revision(0),
+    _cached_range(Input::Range::Inf_Inf)
 #if LIBFMSYNTH_ENABLE_NODETESTING
   , _last_frame(0)
 #endif
@@ -38,6 +49,42 @@ Node::Node(const std::string & type)
 }
 
 
+Node::Node(const Node & source)
+  : _type(source._type),
+    _id(source._id),
+    _blueprint(nullptr),
+    _preprocess_amplitude(source._preprocess_amplitude),
+    _enabled(source._enabled),
+    _samples_per_second(source._samples_per_second),
+    _finished(false),
+    _time_index(0),
+    _finished_time_index(0),
+    _eof_deferred(false),
+    _eof_pending(false),
+    _skipping(false),
+    _inputs(source._inputs),
+    _output_range(source._output_range),
+    _cached_range_revision(0),
+    _cached_range(Input::Range::Inf_Inf)
+#if LIBFMSYNTH_ENABLE_NODETESTING
+  , _last_frame(0)
+#endif
+{
+  // The inputs keep their ranges and default values, the blueprint of the copy links it:
+  for(auto & input : _inputs)
+    {
+      input.RemoveAllInputNodes();
+      input.SetValue(0);
+    }
+}
+
+
+std::shared_ptr<Node> Node::Clone() const
+{
+  return nullptr;
+}
+
+
 Node::~Node()
 {
   for(auto channel : AllChannels)
@@ -45,6 +92,8 @@ Node::~Node()
 
   for(auto channel : AllChannels)
     GetOutput(channel)->RemoveAllOutputNodes();
+
+  InvalidateGraph();
 }
 
 
@@ -62,8 +111,25 @@ const std::string & Node::GetId() const
 
 void Node::SetId(const std::string & id)
 {
+  auto old_id = _id;
   _id = id;
   UpdateNextId();
+  if(_blueprint)
+    _blueprint->OnNodeIdChanged(this, old_id);
+}
+
+
+Blueprint * Node::GetBlueprint() const
+{
+  return _blueprint;
+}
+
+
+void Node::SetBlueprint(Blueprint * blueprint)
+{
+  _blueprint = blueprint;
+  _cached_range_revision = 0; // The revisions of the blueprints are counted separately.
+  InvalidateGraph();
 }
 
 
@@ -84,6 +150,7 @@ void Node::OnInputConnected(Node * from)
 void Node::AddInputNode(Channel from_channel, Node * from_node)
 {
   GetInput(from_channel)->AddInputNode(from_node);
+  InvalidateGraph();
   OnInputConnected(from_node);
 }
 
@@ -91,6 +158,7 @@ void Node::AddInputNode(Channel from_channel, Node * from_node)
 void Node::RemoveInputNode(Channel from_channel, Node * from_node)
 {
   GetInput(from_channel)->RemoveInputNode(from_node);
+  InvalidateGraph();
 }
 
 
@@ -125,14 +193,7 @@ void Node::FinishFrame(long time_index)
       
   auto form = GetInput(Channel::Form)->GetValueAndReset();
 
-  assert(_samples_per_second > 0);
-  double time = static_cast<double>(time_index) / static_cast<double>(_samples_per_second);
-
-  double result;
-  if(_preprocess_amplitude)
-    result = ProcessInput(time, amplitude * form);
-  else
-    result = amplitude * ProcessInput(time, form);
+  double result = ProcessFrame(time_index, amplitude, form);
 
   GetInput(Channel::Aux)->Reset();
 
@@ -146,6 +207,90 @@ void Node::FinishFrame(long time_index)
 }
 
 
+double Node::ProcessFrame(long time_index, double amplitude, double form)
+{
+  assert(_samples_per_second > 0);
+  _time_index = time_index;
+  double time = static_cast<double>(time_index) / static_cast<double>(_samples_per_second);
+
+  if(_preprocess_amplitude)
+    return ProcessInput(time, amplitude * form);
+  else
+    return amplitude * ProcessInput(time, form);
+}
+
+
+void Node::RenderBlock(long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output)
+{
+  assert(frames > 0);
+  _skipping = false;
+  ProcessBlock(time_index, frames, amplitude, form, aux, output);
+
+#if LIBFMSYNTH_ENABLE_NODETESTING
+  _last_frame = ToDouble(output[frames - 1]);
+#endif
+}
+
+
+void Node::RenderVoices(Node * const * nodes, unsigned int count, const long * time_indices, unsigned int frames,
+                        const sample_t * const * amplitude, const sample_t * const * form, const sample_t * const * aux, sample_t * const * output)
+{
+  assert(frames > 0);
+  assert(count > 0 && nodes[0] == this);
+  for(unsigned int v = 0; v < count; v++)
+    {
+      assert(nodes[v]->GetNodeType() == GetNodeType());
+      nodes[v]->_skipping = false;
+    }
+  ProcessVoices(nodes, count, time_indices, frames, amplitude, form, aux, output);
+
+#if LIBFMSYNTH_ENABLE_NODETESTING
+  for(unsigned int v = 0; v < count; v++)
+    nodes[v]->_last_frame = ToDouble(output[v][frames - 1]);
+#endif
+}
+
+
+void Node::SkipBlock()
+{
+  if(!_skipping)
+    {
+      _skipping = true;
+      OnSkip();
+    }
+
+#if LIBFMSYNTH_ENABLE_NODETESTING
+  _last_frame = 0;
+#endif
+}
+
+
+void Node::OnSkip()
+{
+}
+
+
+void Node::ProcessBlock(long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output)
+{
+  // The Aux input is read by the nodes through GetInput(Channel::Aux)->GetValue(), feed it one frame at a time:
+  auto auxinput = GetInput(Channel::Aux);
+  for(unsigned int i = 0; i < frames; i++)
+    {
+      auxinput->SetValue(ToDouble(aux[i]));
+      output[i] = ToSample(ProcessFrame(time_index + i, ToDouble(amplitude[i]), ToDouble(form[i])));
+    }
+  auxinput->Reset();
+}
+
+
+void Node::ProcessVoices(Node * const * nodes, unsigned int count, const long * time_indices, unsigned int frames,
+                         const sample_t * const * amplitude, const sample_t * const * form, const sample_t * const * aux, sample_t * const * output)
+{
+  for(unsigned int v = 0; v < count; v++)
+    nodes[v]->ProcessBlock(time_indices[v], frames, amplitude[v], form[v], aux[v], output[v]);
+}
+
+
 #if LIBFMSYNTH_ENABLE_NODETESTING
 double Node::GetLastFrame() const
 {
@@ -155,11 +300,24 @@ double Node::GetLastFrame() const
 
 
 void Node::SetIsFinished()
+{
+  PropagateFinished(_time_index);
+}
+
+
+void Node::SetIsFinished(long time_index)
+{
+  PropagateFinished(time_index);
+}
+
+
+void Node::PropagateFinished(long time_index)
 {
   if(_finished)
     return;
   
   _finished = true;
+  _finished_time_index = time_index;
 
   std::set<Node *> connected;
 
@@ -174,8 +332,40 @@ void Node::SetIsFinished()
         connected.insert(n);
 
   for(auto n : connected)
-    n->SetIsFinished();
+    n->PropagateFinished(time_index);
+
+  if(_eof_deferred)
+    _eof_pending = true;
+  else
+    OnEOF();
+}
+
+
+long Node::GetTimeIndex() const
+{
+  return _time_index;
+}
+
 
+long Node::GetFinishedTimeIndex() const
+{
+  assert(_finished);
+  return _finished_time_index;
+}
+
+
+void Node::SetEOFDeferred(bool deferred)
+{
+  _eof_deferred = deferred;
+}
+
+
+void Node::FlushEOF()
+{
+  if(!_eof_pending)
+    return;
+
+  _eof_pending = false;
   OnEOF();
 }
 
@@ -223,7 +413,8 @@ Output * Node::GetOutput(Channel channel)
 
 void Node::ResetTime()
 {
-  _finished = false;
+  _finished    = false;
+  _eof_pending = false;
 }
 
 
@@ -240,17 +431,19 @@ json11::Json Node::to_json() const
 void Node::SetFromJson(const json11::Json & json)
 {
   // assert(_type == json["node_type"].string_value()); Does not hold because the WidgetNode overwrites node_type.
-  _id      = json["node_id"].string_value();
+  SetId(json["node_id"].string_value());
   _enabled = json["enabled"].bool_value();
-  UpdateNextId();
+  InvalidateGraph();
 }
 
 
 void Node::UpdateNextId()
 {
+  // The blueprints can be loaded in several threads at once:
   auto intid = std::strtoul(_id.c_str(), nullptr, 0);
-  if(intid < ULONG_MAX && intid >= _next_id)
-    _next_id = intid + 1;
+  auto next = _next_id.load();
+  while(intid < ULONG_MAX && intid >= next && !_next_id.compare_exchange_weak(next, intid + 1))
+    ;
   assert(_next_id > 0);
 }
 
@@ -267,6 +460,7 @@ void Node::SetEnabled(const Node * root, bool enabled)
   assert(root != this);
 
   _enabled = enabled;
+  InvalidateGraph();
 
   if(enabled)
     OnEnabled();
@@ -287,6 +481,7 @@ Input::Range Node::GetInputRange(Channel channel) const
 void Node::SetOutputRange(Input::Range range)
 {
   _output_range = range;
+  InvalidateGraph();
 }
 
 
@@ -296,6 +491,72 @@ Input::Range Node::GetFormOutputRange() const
 }
 
 
+Input::Range Node::GetCachedFormOutputRange() const
+{
+  auto revision = GetGraphRevision();
+  if(_cached_range_revision != revision)
+    {
+      _cached_range_revision = revision;
+      _cached_range = Input::Range::Inf_Inf; // Ends the recursion if the node is in a cycle.
+      _cached_range = GetFormOutputRange();
+    }
+  return _cached_range;
+}
+
+
+unsigned long Node::GetGraphRevision() const
+{
+  if(_blueprint)
+    return _blueprint->_graph_revision;
+  return _graph_revision.load(std::memory_order_relaxed);
+}
+
+
+void Node::InvalidateGraph()
+{
+  if(_blueprint)
+    _blueprint->_graph_revision++;
+  else
+    _graph_revision.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+bool Node::IsStateless() const
+{
+  return false;
+}
+
+
+bool Node::HasSideEffects() const
+{
+  return false;
+}
+
+
+bool Node::CanRunAtControlRate() const
+{
+  return false;
+}
+
+
+bool Node::IsSilent() const
+{
+  return false;
+}
+
+
+bool Node::CanFinish() const
+{
+  return false;
+}
+
+
+long Node::GetHistoryLength() const
+{
+  return IsStateless() ? 0 : -1;
+}
+
+
 void Node::SetSamplesPerSecond(unsigned int samples_per_second)
 {
   _samples_per_second = samples_per_second;
@@ -20,17 +20,22 @@
 
 #include "Input.hh"
 #include "Output.hh"
+#include "Sample.hh"
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 #include <json11.hpp>
 
 
 namespace fmsynth
 {
+  class Blueprint;
+
   class Node
   {
   public:
@@ -69,19 +74,51 @@ namespace fmsynth
     Node(const std::string & type);
     virtual ~Node();
 
+    Node & operator=(const Node & rhs) = delete;
+
+    // A node of the same type, id and parameters, without the links and not in a blueprint. The voices of a
+    // VoiceEngine are copies of one loaded blueprint. Returns nullptr if the node type can not be copied:
+    [[nodiscard]] virtual std::shared_ptr<Node> Clone() const;
+
     [[nodiscard]] const std::string & GetNodeType() const;
     [[nodiscard]] const std::string & GetId()   const;
     void                              SetId(const std::string & id);
+    // The blueprint the node has been added to, it keeps its index of the node ids up to date when the id changes:
+    [[nodiscard]] Blueprint *         GetBlueprint() const;
+    void                              SetBlueprint(Blueprint * blueprint);
 
     [[nodiscard]] virtual Input::Range GetInputRange(Channel channel) const;
     [[nodiscard]] virtual Input::Range GetFormOutputRange()     const;
-
-    void                       SetSamplesPerSecond(unsigned int samples_per_second);
+    // GetFormOutputRange() resolved once after each change of the ranges, without walking the upstream nodes again:
+    [[nodiscard]] Input::Range         GetCachedFormOutputRange() const;
+    // The graph revision changes with every change which can change a compiled program: the links, the enabled
+    // states, the output ranges, and the parameters of the stateless nodes. Each blueprint counts the changes of
+    // its own nodes, the nodes which are not in a blueprint share one revision.
+    [[nodiscard]] unsigned long GetGraphRevision() const;
+    void                        InvalidateGraph();
+
+    [[nodiscard]] virtual bool IsStateless()    const; // The output depends only on the inputs of the same frame, and on the parameters.
+    [[nodiscard]] virtual bool HasSideEffects() const; // The node is run even when its output is not used.
+    [[nodiscard]] virtual bool CanRunAtControlRate() const; // The output varies slowly, it can be computed every few frames and interpolated.
+    [[nodiscard]] virtual bool IsSilent()       const; // The output is zero whatever the input is.
+    [[nodiscard]] virtual bool CanFinish()      const; // Running the node can finish the blueprint, see SetIsFinished().
+    // How many frames back the input of the node can affect its output, 0 if the output depends only on the time and
+    // the input of the same frame, and -1 if there is no limit. Decaying responses end where they fall below -240dB.
+    [[nodiscard]] virtual long GetHistoryLength() const;
+
+    virtual void               SetSamplesPerSecond(unsigned int samples_per_second);
     [[nodiscard]] unsigned int GetSamplesPerSecond() const;
 
     void    PushInput(Node * pusher, Channel channel, double value);
     void    FinishFrame(long time_index);
 
+    void    RenderBlock(long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output);
+    void    SkipBlock(); // Called instead of RenderBlock() for the blocks in which the output is known to be silent or is not used.
+    // Renders the same block of this node and the same node of the other voices of a VoiceEngine, nodes[0] is this node.
+    // The input and output arrays have a block for each voice:
+    void    RenderVoices(Node * const * nodes, unsigned int count, const long * time_indices, unsigned int frames,
+                         const sample_t * const * amplitude, const sample_t * const * form, const sample_t * const * aux, sample_t * const * output);
+
 #if LIBFMSYNTH_ENABLE_NODETESTING
     [[nodiscard]] double  GetLastFrame() const;
 #endif
@@ -91,6 +128,10 @@ namespace fmsynth
 
     [[nodiscard]] bool    IsFinished() const;
     void                  SetIsFinished();
+    void                  SetIsFinished(long time_index); // Finished during the given frame instead of the frame being processed.
+    [[nodiscard]] long    GetFinishedTimeIndex() const; // The frame during which the node was finished.
+    void                  SetEOFDeferred(bool deferred);  // When deferred, OnEOF() is called from FlushEOF() instead of SetIsFinished().
+    void                  FlushEOF();
 
     [[nodiscard]] std::set<Node *> GetAllOutputNodes() const;
     virtual void                   ResetTime();
@@ -108,33 +149,55 @@ namespace fmsynth
     void RemoveOutputNode(Channel channel, Node * node);
     
   protected:
+    Node(const Node & source); // Copies the parameters for Clone(), not the links.
     virtual void   OnInputConnected(Node * from);
     virtual double ProcessInput(double time, double form) = 0;
+    virtual void   ProcessBlock(long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output);
+    // Called for nodes[0] by RenderVoices(). The default calls ProcessBlock() of each node, the node types whose state
+    // can be gathered into arrays process all the voices in one pass instead:
+    virtual void   ProcessVoices(Node * const * nodes, unsigned int count, const long * time_indices, unsigned int frames,
+                                 const sample_t * const * amplitude, const sample_t * const * form, const sample_t * const * aux, sample_t * const * output);
+    [[nodiscard]] double ProcessFrame(long time_index, double amplitude, double form);
+    [[nodiscard]] long   GetTimeIndex() const; // The frame being processed by ProcessInput().
     virtual void   OnEnabled();
     virtual void   OnEOF();
+    // Called on the first skipped block after the node has been run. The default keeps the state, and the node
+    // continues from where it stopped. The nodes whose state holds past input clear it instead, so that they
+    // do not replay stale input.
+    virtual void   OnSkip();
 
     void          SetPreprocessAmplitude();
     void          SetOutputRange(Input::Range range);
 
   private:
-    static unsigned long _next_id;
+    static std::atomic<unsigned long> _next_id;
+    static std::atomic<unsigned long> _graph_revision; // Of the nodes which are not in a blueprint.
   
     std::string  _type;
     std::string  _id;
+    Blueprint *  _blueprint;
     bool         _preprocess_amplitude;
 
     bool         _enabled;
     unsigned int _samples_per_second;
     bool         _finished;
+    long         _time_index;
+    long         _finished_time_index;
+    bool         _eof_deferred;
+    bool         _eof_pending;
+    bool         _skipping;
     std::array<Input,  AllChannels.size()> _inputs;
     std::array<Output, AllChannels.size()> _outputs;
     
     Input::Range _output_range;
+    mutable unsigned long _cached_range_revision;
+    mutable Input::Range  _cached_range;
 #if LIBFMSYNTH_ENABLE_NODETESTING
     double       _last_frame;
 #endif
 
     void UpdateNextId();
+    void PropagateFinished(long time_index);
   };
 }
 
@@ -17,6 +17,12 @@
 using namespace fmsynth;
 
 
+static bool IsSame(double a, double b)
+{
+  return !(a < b) && !(a > b);
+}
+
+
 NodeADHSR::NodeADHSR()
   : Node("ADHSR"),
     _attack_time(0),
@@ -30,6 +36,12 @@ NodeADHSR::NodeADHSR()
 }
 
 
+std::shared_ptr<Node> NodeADHSR::Clone() const
+{
+  return std::make_shared<NodeADHSR>(*this);
+}
+
+
 
 void NodeADHSR::Set(double attack_time, double decay_time, double hold_time, double sustain_level, double release_time, EndAction end_action)
 {
@@ -42,6 +54,42 @@ void NodeADHSR::Set(double attack_time, double decay_time, double hold_time, dou
 }
 
 
+void NodeADHSR::SetAttackTime(double attack_time)
+{
+  _attack_time = attack_time;
+}
+
+
+void NodeADHSR::SetDecayTime(double decay_time)
+{
+  _decay_time = decay_time;
+}
+
+
+void NodeADHSR::SetHoldTime(double hold_time)
+{
+  _hold_time = hold_time;
+}
+
+
+void NodeADHSR::SetSustainLevel(double sustain_level)
+{
+  _sustain_level = sustain_level;
+}
+
+
+void NodeADHSR::SetReleaseTime(double release_time)
+{
+  _release_time = release_time;
+}
+
+
+void NodeADHSR::SetEndAction(EndAction end_action)
+{
+  _end_action = end_action;
+}
+
+
 double NodeADHSR::GetAttackTime() const
 {
   return _attack_time;
@@ -88,48 +136,108 @@ void NodeADHSR::ResetTime()
 
 double NodeADHSR::ProcessInput(double time, double form)
 {
-  if(_attack_time + _decay_time + _hold_time + _release_time <= 0)
+  if(GetLength() <= 0)
     return 0;
   
   assert(time >= _timeshift);
   time -= _timeshift;
 
-  double m = 0;
+  double m = time < GetLength() ? Level(time) : End(time);
+  return form * m;
+}
+
+
+void NodeADHSR::ProcessVoices(Node * const * nodes, unsigned int count, const long * time_indices, unsigned int frames,
+                              const sample_t * const * amplitude, const sample_t * const * form, const sample_t * const * aux, sample_t * const * output)
+{
+  // The times of the voices with the envelope of this node, which do not reach the end of the release during the block,
+  // are gathered into arrays, and the envelope is computed for them without the end actions:
+  auto sps = static_cast<double>(GetSamplesPerSecond());
+  _voices.clear();
+  for(unsigned int v = 0; v < count; v++)
+    {
+      auto node = static_cast<NodeADHSR *>(nodes[v]);
+      auto last = static_cast<double>(time_indices[v] + frames - 1) / sps - node->_timeshift;
+      if(HasSameEnvelope(*node) && GetLength() > 0 && last < GetLength())
+        _voices.push_back(v);
+      else
+        node->ProcessBlock(time_indices[v], frames, amplitude[v], form[v], aux[v], output[v]);
+    }
+  if(_voices.size() < 2)
+    {
+      for(auto v : _voices)
+        static_cast<NodeADHSR *>(nodes[v])->ProcessBlock(time_indices[v], frames, amplitude[v], form[v], aux[v], output[v]);
+      return;
+    }
+
+  auto channels = static_cast<unsigned int>(_voices.size());
+  _voices_time.resize(channels);
+  _voices_timeshift.resize(channels);
+  for(unsigned int c = 0; c < channels; c++)
+    {
+      _voices_time[c]      = time_indices[_voices[c]];
+      _voices_timeshift[c] = static_cast<NodeADHSR *>(nodes[_voices[c]])->_timeshift;
+    }
+
+  for(unsigned int c = 0; c < channels; c++)
+    {
+      auto v = _voices[c];
+      for(unsigned int i = 0; i < frames; i++)
+        {
+          auto level = Level(static_cast<double>(_voices_time[c] + i) / sps - _voices_timeshift[c]);
+          output[v][i] = ToSample(ToDouble(amplitude[v][i]) * (ToDouble(form[v][i]) * level));
+        }
+    }
+}
+
+
+bool NodeADHSR::HasSameEnvelope(const NodeADHSR & other) const
+{
+  return IsSame(_attack_time, other._attack_time) && IsSame(_decay_time, other._decay_time) && IsSame(_hold_time, other._hold_time)
+    && IsSame(_sustain_level, other._sustain_level) && IsSame(_release_time, other._release_time) && _end_action == other._end_action
+    && GetSamplesPerSecond() == other.GetSamplesPerSecond();
+}
+
+
+double NodeADHSR::GetLength() const
+{
+  return _attack_time + _decay_time + _hold_time + _release_time;
+}
+
+
+double NodeADHSR::Level(double time) const
+{
   if(time < _attack_time)
-    m = Attack(time);
+    return Attack(time);
   else if(time < _attack_time + _decay_time)
-    m = Decay(time);
+    return Decay(time);
   else if(time < _attack_time + _decay_time + _hold_time)
-    m = Sustain(time);
-  else if(time < _attack_time + _decay_time + _hold_time + _release_time)
-    m = Release(time);
+    return Sustain(time);
   else
-    m = End(time);
-
-  return form * m;
+    return Release(time);
 }
 
 
-double NodeADHSR::Attack(double time)
+double NodeADHSR::Attack(double time) const
 {
   return time / _attack_time;
 }
 
 
-double NodeADHSR::Decay(double time)
+double NodeADHSR::Decay(double time) const
 {
   auto pos = (time - _attack_time) / _decay_time;
   return 1.0 - pos * (1.0 - _sustain_level);
 }
 
 
-double NodeADHSR::Sustain([[maybe_unused]] double time)
+double NodeADHSR::Sustain([[maybe_unused]] double time) const
 {
   return _sustain_level;
 }
 
 
-double NodeADHSR::Release(double time)
+double NodeADHSR::Release(double time) const
 {
   double pos = (time - _attack_time - _decay_time - _hold_time) / _release_time;
   return std::lerp(_sustain_level, 0.0, pos);
@@ -184,3 +292,28 @@ Input::Range NodeADHSR::GetFormOutputRange() const
 {
   return GetInput(Channel::Form)->GetInputRange();
 }
+
+
+bool NodeADHSR::HasSideEffects() const
+{
+  return true;
+}
+
+
+bool NodeADHSR::CanRunAtControlRate() const
+{
+  return true;
+}
+
+
+bool NodeADHSR::CanFinish() const
+{
+  return _end_action == EndAction::STOP;
+}
+
+
+long NodeADHSR::GetHistoryLength() const
+{
+  // The envelope is a function of the time, until it restarts from the time it ended:
+  return _end_action == EndAction::RESTART ? -1 : 0;
+}
@@ -13,6 +13,7 @@
 */
 
 #include "Node.hh"
+#include <vector>
 
 
 namespace fmsynth
@@ -27,8 +28,20 @@ namespace fmsynth
     };
   
     NodeADHSR();
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
+
+    [[nodiscard]] bool HasSideEffects() const override;
+    [[nodiscard]] bool CanRunAtControlRate() const override;
+    [[nodiscard]] bool CanFinish() const override;
+    [[nodiscard]] long GetHistoryLength() const override;
 
     void      Set(double attack_time, double decay_time, double hold_time, double sustain_level, double release_time, EndAction end_action);
+    void      SetAttackTime(double attack_time);
+    void      SetDecayTime(double decay_time);
+    void      SetHoldTime(double hold_time);
+    void      SetSustainLevel(double sustain_level);
+    void      SetReleaseTime(double release_time);
+    void      SetEndAction(EndAction end_action);
     [[nodiscard]] double    GetAttackTime()   const;
     [[nodiscard]] double    GetDecayTime()    const;
     [[nodiscard]] double    GetHoldTime()     const;
@@ -44,6 +57,8 @@ namespace fmsynth
   
   protected:
     [[nodiscard]] double ProcessInput(double time, double form) override;
+    void                 ProcessVoices(Node * const * nodes, unsigned int count, const long * time_indices, unsigned int frames,
+                                       const sample_t * const * amplitude, const sample_t * const * form, const sample_t * const * aux, sample_t * const * output) override;
 
   private:
     double    _attack_time;
@@ -54,10 +69,18 @@ namespace fmsynth
     EndAction _end_action;
     double    _timeshift;
 
-    [[nodiscard]] double Attack(double time);
-    [[nodiscard]] double Decay(double time);
-    [[nodiscard]] double Sustain(double time);
-    [[nodiscard]] double Release(double time);
+    std::vector<unsigned int> _voices;           // The voices gathered by ProcessVoices().
+    std::vector<long>         _voices_time;      // The first frame of the block of each voice.
+    std::vector<double>       _voices_timeshift;
+
+    [[nodiscard]] bool   HasSameEnvelope(const NodeADHSR & other) const;
+    [[nodiscard]] double GetLength() const;         // The time from the start to the end of the release.
+    [[nodiscard]] double Level(double time) const; // The level before the end of the release.
+
+    [[nodiscard]] double Attack(double time) const;
+    [[nodiscard]] double Decay(double time) const;
+    [[nodiscard]] double Sustain(double time) const;
+    [[nodiscard]] double Release(double time) const;
     [[nodiscard]] double End(double time);
   };
 }
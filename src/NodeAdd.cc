@@ -23,6 +23,12 @@ NodeAdd::NodeAdd()
 }
 
 
+std::shared_ptr<Node> NodeAdd::Clone() const
+{
+  return std::make_shared<NodeAdd>(*this);
+}
+
+
 double NodeAdd::GetValue() const
 {
   return _value;
@@ -32,6 +38,7 @@ double NodeAdd::GetValue() const
 void NodeAdd::SetValue(double value)
 {
   _value = value;
+  InvalidateGraph();
 }
 
 
@@ -41,6 +48,14 @@ double NodeAdd::ProcessInput([[maybe_unused]] double time, double form)
 }
 
 
+void NodeAdd::ProcessBlock([[maybe_unused]] long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, [[maybe_unused]] const sample_t * aux, sample_t * output)
+{
+  auto value = ToSample(_value);
+  for(unsigned int i = 0; i < frames; i++)
+    output[i] = amplitude[i] * (form[i] + value);
+}
+
+
 json11::Json NodeAdd::to_json() const
 {
   auto rv = Node::to_json().object_items();
@@ -53,3 +68,9 @@ void NodeAdd::SetFromJson(const json11::Json & json)
   Node::SetFromJson(json);
   _value = json["add_value"].number_value();
 }
+
+
+bool NodeAdd::IsStateless() const
+{
+  return true;
+}
@@ -26,6 +26,12 @@ NodeAudioDeviceOutput::NodeAudioDeviceOutput()
 }
 
 
+std::shared_ptr<Node> NodeAudioDeviceOutput::Clone() const
+{
+  return std::make_shared<NodeAudioDeviceOutput>(*this);
+}
+
+
 void NodeAudioDeviceOutput::SetOnPlaySample(on_play_sample_t callback)
 {
   _on_play_sample = callback;
@@ -81,3 +87,21 @@ void NodeAudioDeviceOutput::SetFromJson(const json11::Json & json)
   _muted     = json["audiodeviceoutput_muted"].bool_value();
   _amplitude = json["audiodeviceoutput_volume"].number_value();
 }
+
+
+bool NodeAudioDeviceOutput::HasSideEffects() const
+{
+  return true;
+}
+
+
+bool NodeAudioDeviceOutput::IsSilent() const
+{
+  return _muted;
+}
+
+
+long NodeAudioDeviceOutput::GetHistoryLength() const
+{
+  return 0;
+}
@@ -24,6 +24,11 @@ namespace fmsynth
     typedef std::function<void(double sample)> on_play_sample_t;
   
     NodeAudioDeviceOutput();
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
+
+    [[nodiscard]] bool HasSideEffects() const override;
+    [[nodiscard]] bool IsSilent()       const override; // When muted.
+    [[nodiscard]] long GetHistoryLength() const override;
 
     void   SetOnPlaySample(on_play_sample_t callback);
 
@@ -22,6 +22,12 @@ NodeAverage::NodeAverage()
 }
 
 
+std::shared_ptr<Node> NodeAverage::Clone() const
+{
+  return std::make_shared<NodeAverage>(*this);
+}
+
+
 double NodeAverage::ProcessInput([[maybe_unused]] double time, double form)
 {
   auto n = static_cast<double>(GetInput(Channel::Form)->GetInputNodes().size());
@@ -36,3 +42,9 @@ Input::Range NodeAverage::GetFormOutputRange() const
 {
   return GetInput(Channel::Form)->GetInputRange();
 }
+
+
+bool NodeAverage::IsStateless() const
+{
+  return true;
+}
@@ -21,6 +21,9 @@ namespace fmsynth
   {
   public:
     NodeAverage();
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
+
+    [[nodiscard]] bool IsStateless() const override;
 
     [[nodiscard]] Input::Range GetFormOutputRange() const       override;
   
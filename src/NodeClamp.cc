@@ -24,6 +24,12 @@ NodeClamp::NodeClamp()
 }
 
 
+std::shared_ptr<Node> NodeClamp::Clone() const
+{
+  return std::make_shared<NodeClamp>(*this);
+}
+
+
 double NodeClamp::GetMin() const
 {
   return _min;
@@ -39,12 +45,14 @@ double NodeClamp::GetMax() const
 void NodeClamp::SetMin(double min)
 {
   _min = min;
+  InvalidateGraph();
 }
 
 
 void NodeClamp::SetMax(double max)
 {
   _max = max;
+  InvalidateGraph();
 }
 
 
@@ -54,6 +62,15 @@ double NodeClamp::ProcessInput([[maybe_unused]] double time, double form)
 }
 
 
+void NodeClamp::ProcessBlock([[maybe_unused]] long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, [[maybe_unused]] const sample_t * aux, sample_t * output)
+{
+  auto min = ToSample(_min);
+  auto max = ToSample(_max);
+  for(unsigned int i = 0; i < frames; i++)
+    output[i] = amplitude[i] * std::clamp(form[i], min, max);
+}
+
+
 json11::Json NodeClamp::to_json() const
 {
   auto rv = Node::to_json().object_items();
@@ -67,15 +84,17 @@ void NodeClamp::SetFromJson(const json11::Json & json)
   Node::SetFromJson(json);
   _min = json["clamp_min"].number_value();
   _max = json["clamp_max"].number_value();
+  InvalidateGraph();
 }
 
 
 Input::Range NodeClamp::GetFormOutputRange() const
 {
-  if(_min >= 0 && _max <= 1)
-    return Input::Range::Zero_One;
-  else if(_min >= -1 && _max <= 1)
-    return Input::Range::MinusOne_One;
-  else
-    return Input::Range::Inf_Inf;
+  return Input::GetValueRange(_min, _max);
+}
+
+
+bool NodeClamp::IsStateless() const
+{
+  return true;
 }
@@ -21,6 +21,9 @@ namespace fmsynth
   {
   public:
     NodeClamp();
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
+
+    [[nodiscard]] bool IsStateless() const override;
 
     [[nodiscard]] double GetMin() const;
     [[nodiscard]] double GetMax() const;
@@ -34,6 +37,7 @@ namespace fmsynth
   
   protected:
     [[nodiscard]] double ProcessInput(double time, double form)       override;
+    void                 ProcessBlock(long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output) override;
   
   private:
     double _min;
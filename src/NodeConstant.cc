@@ -24,9 +24,9 @@ NodeConstant::NodeConstant()
 }
 
 
-ConstantValue & NodeConstant::GetValue()
+std::shared_ptr<Node> NodeConstant::Clone() const
 {
-  return _value;
+  return std::make_shared<NodeConstant>(*this);
 }
 
 
@@ -36,22 +36,31 @@ const ConstantValue & NodeConstant::GetValue() const
 }
 
 
+void NodeConstant::SetValue(const ConstantValue & value)
+{
+  _value = value;
+  InvalidateGraph();
+}
+
+
 double NodeConstant::ProcessInput([[maybe_unused]] double time, [[maybe_unused]] double form)
 {
   return _value.GetValue();
 }
 
 
+void NodeConstant::ProcessBlock([[maybe_unused]] long time_index, unsigned int frames, const sample_t * amplitude, [[maybe_unused]] const sample_t * form, [[maybe_unused]] const sample_t * aux, sample_t * output)
+{
+  auto value = ToSample(_value.GetValue());
+  for(unsigned int i = 0; i < frames; i++)
+    output[i] = amplitude[i] * value;
+}
+
+
 Input::Range NodeConstant::GetFormOutputRange() const
 {
   auto c = _value.GetValue();
-
-  if(c >= 0 && c <= 1)
-    return Input::Range::Zero_One;
-  else if(c >= -1 && c <= 1)
-    return Input::Range::MinusOne_One;
-  else
-    return Input::Range::Inf_Inf;
+  return Input::GetValueRange(c, c);
 }
 
 
@@ -80,4 +89,11 @@ void NodeConstant::SetFromJson(const json11::Json & json)
         unit
       };
     }
+  InvalidateGraph();
+}
+
+
+bool NodeConstant::IsStateless() const
+{
+  return true;
 }
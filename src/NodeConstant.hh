@@ -22,9 +22,12 @@ namespace fmsynth
   {
   public:
     NodeConstant();
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
+
+    [[nodiscard]] bool IsStateless() const override;
 
-    [[nodiscard]] ConstantValue &       GetValue();
     [[nodiscard]] const ConstantValue & GetValue() const;
+    void                                SetValue(const ConstantValue & value);
 
     [[nodiscard]] Input::Range GetFormOutputRange() const             override;
 
@@ -33,6 +36,7 @@ namespace fmsynth
   
   protected:
     [[nodiscard]] double ProcessInput(double time, double form)       override;
+    void                 ProcessBlock(long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output) override;
   
   private:
     ConstantValue _value;
@@ -11,14 +11,32 @@
 */
 
 #include "NodeDelay.hh"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstring>
 
 using namespace fmsynth;
 
 
 NodeDelay::NodeDelay()
   : Node("Delay"),
-    _delay_time(0)
-{ // todo: Use std::vector instead.
+    _delay_time(0),
+    _max_delay_time(0),
+    _interpolation(Interpolation::LINEAR),
+    _mask(0),
+    _write(0),
+    _allpass_previous(0),
+    _buffer_samples_per_second(0)
+{
+  UpdateBuffer();
+}
+
+
+std::shared_ptr<Node> NodeDelay::Clone() const
+{
+  return std::make_shared<NodeDelay>(*this);
 }
 
 
@@ -28,37 +46,216 @@ double NodeDelay::GetDelayTime() const
 }
 
 
+double NodeDelay::GetMaxDelayTime() const
+{
+  return _max_delay_time;
+}
+
+
+NodeDelay::Interpolation NodeDelay::GetInterpolation() const
+{
+  return _interpolation;
+}
+
+
 void NodeDelay::SetDelayTime(double time)
 {
   _delay_time = time;
+  UpdateBuffer();
+}
+
+
+void NodeDelay::SetMaxDelayTime(double time)
+{
+  _max_delay_time = time;
+  UpdateBuffer();
+}
+
+
+void NodeDelay::SetInterpolation(Interpolation interpolation)
+{
+  _interpolation = interpolation;
+}
+
+
+void NodeDelay::SetSamplesPerSecond(unsigned int samples_per_second)
+{
+  Node::SetSamplesPerSecond(samples_per_second);
+  UpdateBuffer();
+}
+
+
+void NodeDelay::UpdateBuffer()
+{
+  // Room for the interpolation points around the longest delay:
+  auto reserved = std::max(0.0, _max_delay_time * static_cast<double>(GetSamplesPerSecond()));
+  auto longest = static_cast<uint64_t>(std::ceil(std::max(GetDelaySamples(1), reserved)));
+  auto size = std::bit_ceil(longest + 4);
+  if(_buffer_samples_per_second != GetSamplesPerSecond())
+    { // The frames in the buffer are of the old rate, start from silence:
+      _buffer.assign(size, 0);
+      _mask = size - 1;
+      _write = 0;
+      _allpass_previous = 0;
+      _buffer_samples_per_second = GetSamplesPerSecond();
+      return;
+    }
+  if(size <= _buffer.size())
+    return; // A shorter delay reads the history from the same buffer.
+
+  // Grow the buffer, keeping the history at the positions of the larger mask:
+  std::vector<sample_t> buffer(size, 0);
+  for(uint64_t i = 0; i < _buffer.size(); i++)
+    buffer[(_write - i) & (size - 1)] = _buffer[(_write - i) & _mask];
+  _buffer.swap(buffer);
+  _mask = size - 1;
 }
 
 
-void NodeDelay::PrefillBuffer()
+double NodeDelay::GetDelaySamples(double scale) const
 {
-  _buffer.clear();
-  auto n = static_cast<unsigned int>(_delay_time * static_cast<double>(GetSamplesPerSecond()));
-  for(unsigned int i = 0; i < n; i++)
-    _buffer.push_back(0);
+  double delay = std::max(0.0, _delay_time * std::clamp(scale, 0.0, 1.0) * static_cast<double>(GetSamplesPerSecond()));
+  // Delay times like 0.3s are not exact in binary, make them whole frames:
+  double whole = std::round(delay);
+  if(std::abs(delay - whole) < 0.000001)
+    delay = whole;
+  return delay;
+}
+
+
+double NodeDelay::Read(double delay)
+{
+  auto   whole    = static_cast<uint64_t>(delay);
+  double fraction = delay - static_cast<double>(whole);
+  auto   buffer   = _buffer.data();
+  auto   at       = [this, buffer](uint64_t position) { return ToDouble(buffer[position & _mask]); };
+  auto   position = _write - whole;
+
+  switch(_interpolation)
+    {
+    case Interpolation::LINEAR:
+      {
+        double x0 = at(position);
+        if(!(fraction > 0))
+          return x0;
+        return x0 + fraction * (at(position - 1) - x0);
+      }
+
+    case Interpolation::CUBIC:
+      {
+        if(!(fraction > 0))
+          return at(position);
+        // Catmull-Rom spline, at the shortest delay the newest frame stands for the missing next one:
+        double xm1 = whole > 0 ? at(position + 1) : at(position);
+        double x0  = at(position);
+        double x1  = at(position - 1);
+        double x2  = at(position - 2);
+        return x0 + 0.5 * fraction * (x1 - xm1 + fraction * (2.0 * xm1 - 5.0 * x0 + 4.0 * x1 - x2 + fraction * (3.0 * (x0 - x1) + x2 - xm1)));
+      }
+
+    case Interpolation::ALLPASS:
+      {
+        // First order allpass, the fraction is kept in [0.1, 1.1) where the coefficient stays away from the pole at -1:
+        if(fraction < 0.1 && whole > 0)
+          {
+            position++;
+            fraction += 1.0;
+          }
+        double a = (1.0 - fraction) / (1.0 + fraction);
+        double rv = a * at(position) + at(position - 1) - a * _allpass_previous;
+        _allpass_previous = rv;
+        return rv;
+      }
+    }
+  assert(false);
+  return 0;
 }
 
 
 double NodeDelay::ProcessInput([[maybe_unused]] double time, double form)
 {
-  if(_buffer.empty() && _delay_time > 0.0)
-    PrefillBuffer();
-  
-  _buffer.push_back(form);
-  auto rv = _buffer.front();
-  _buffer.pop_front();
-  return rv;
+  double scale = 1;
+  auto aux = GetInput(Channel::Aux);
+  if(aux->GetInputNodes().size() > 0)
+    scale = aux->GetValue();
+
+  _buffer[++_write & _mask] = ToSample(form);
+  return Read(GetDelaySamples(scale));
+}
+
+
+void NodeDelay::ProcessBlock([[maybe_unused]] long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output)
+{
+  bool has_aux = GetInput(Channel::Aux)->GetInputNodes().size() > 0;
+  double delay = GetDelaySamples(1);
+  if(has_aux || _interpolation == Interpolation::ALLPASS || delay > std::floor(delay))
+    {
+      for(unsigned int i = 0; i < frames; i++)
+        {
+          _buffer[++_write & _mask] = form[i];
+          output[i] = amplitude[i] * ToSample(Read(has_aux ? GetDelaySamples(ToDouble(aux[i])) : delay));
+        }
+      return;
+    }
+
+  // Whole frame delay, copy the spans in and out of the ring buffer. The block is written before it is read,
+  // so the chunks must not overwrite the frames which are still to be read:
+  auto whole = static_cast<uint64_t>(delay);
+  auto size = _buffer.size();
+  auto buffer = _buffer.data();
+  auto copy = [buffer, size, this](uint64_t position, uint64_t count, auto && span)
+  {
+    auto start = position & _mask;
+    auto first = std::min(count, size - start);
+    span(buffer + start, 0, first);
+    if(first < count)
+      span(buffer, first, count - first);
+  };
+
+  for(unsigned int done = 0; done < frames;)
+    {
+      auto count = std::min(static_cast<uint64_t>(frames - done), size - whole);
+      copy(_write + 1, count, [form, done](sample_t * ring, uint64_t offset, uint64_t n) { std::memcpy(ring, form + done + offset, n * sizeof(sample_t)); });
+      copy(_write + 1 - whole, count, [output, done](sample_t * ring, uint64_t offset, uint64_t n) { std::memcpy(output + done + offset, ring, n * sizeof(sample_t)); });
+      _write += count;
+      done += static_cast<unsigned int>(count);
+    }
+
+  for(unsigned int i = 0; i < frames; i++)
+    output[i] *= amplitude[i];
 }
 
 
 void NodeDelay::ResetTime()
 {
   Node::ResetTime();
-  PrefillBuffer();
+  std::fill(_buffer.begin(), _buffer.end(), 0);
+  _allpass_previous = 0;
+}
+
+
+long NodeDelay::GetHistoryLength() const
+{
+  // The allpass interpolation feeds back its previous output:
+  if(_interpolation == Interpolation::ALLPASS)
+    return -1;
+  return static_cast<long>(std::ceil(GetDelaySamples(1))) + 2; // The cubic interpolation reads one frame further.
+}
+
+
+void NodeDelay::OnSkip()
+{
+  std::fill(_buffer.begin(), _buffer.end(), 0);
+  _allpass_previous = 0;
+}
+
+
+Input::Range NodeDelay::GetInputRange(Channel channel) const
+{
+  if(channel == Channel::Aux)
+    return Input::Range::Zero_One;
+  else
+    return Node::GetInputRange(channel);
 }
 
 
@@ -72,6 +269,7 @@ json11::Json NodeDelay::to_json() const
 {
   auto rv = Node::to_json().object_items();
   rv["delay_time"] = _delay_time;
+  rv["delay_interpolation"] = static_cast<int>(_interpolation);
   return rv;
 }
 
@@ -79,5 +277,6 @@ void NodeDelay::SetFromJson(const json11::Json & json)
 {
   Node::SetFromJson(json);
   _delay_time = json["delay_time"].number_value();
-  PrefillBuffer();
+  _interpolation = static_cast<Interpolation>(json["delay_interpolation"].int_value());
+  UpdateBuffer();
 }
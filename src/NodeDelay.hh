@@ -13,19 +13,40 @@
 */
 
 #include "Node.hh"
-#include <deque>
+#include <cstdint>
+#include <vector>
 
 namespace fmsynth
 {
+  // The delay line is a ring buffer of power of two size, sized by SetDelayTime() and SetSamplesPerSecond()
+  // so that rendering does not allocate. A longer delay time grows the buffer keeping the history, a shorter
+  // one keeps the buffer. SetMaxDelayTime() sizes the buffer ahead, so that the delay times up to it only
+  // change the read distance and SetDelayTime() does not allocate while the node is played. The Aux input scales the delay time from 0 to the set delay time, fractional delays
+  // are interpolated.
   class NodeDelay : public Node
   {
   public:
+    enum class Interpolation
+      {
+        LINEAR,
+        CUBIC,
+        ALLPASS
+      };
+
     NodeDelay();
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
 
-    [[nodiscard]] double GetDelayTime()            const;
-    void                 SetDelayTime(double time);
+    [[nodiscard]] double        GetDelayTime()     const;
+    [[nodiscard]] double        GetMaxDelayTime()  const;
+    [[nodiscard]] Interpolation GetInterpolation() const;
+    void                        SetDelayTime(double time);
+    void                        SetMaxDelayTime(double time); // The longest delay time the buffer is kept large enough for.
+    void                        SetInterpolation(Interpolation interpolation);
+    void                        SetSamplesPerSecond(unsigned int samples_per_second) override;
 
     void                       ResetTime()                            override;
+    [[nodiscard]] long         GetHistoryLength() const               override;
+    [[nodiscard]] Input::Range GetInputRange(Channel channel) const   override;
     [[nodiscard]] Input::Range GetFormOutputRange() const             override;
   
     [[nodiscard]] json11::Json to_json() const                        override;
@@ -33,12 +54,22 @@ namespace fmsynth
   
   protected:
     [[nodiscard]] double ProcessInput(double time, double form)       override;
+    void                 ProcessBlock(long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output) override;
+    void                 OnSkip() override;
   
   private:
-    double             _delay_time;
-    std::deque<double> _buffer;
+    double                _delay_time;
+    double                _max_delay_time;
+    Interpolation         _interpolation;
+    std::vector<sample_t> _buffer;
+    uint64_t              _mask;
+    uint64_t              _write;            // Position of the latest input, grows forever and is masked for indexing.
+    double                _allpass_previous;
+    unsigned int          _buffer_samples_per_second;
 
-    void PrefillBuffer();
+    void                 UpdateBuffer();
+    [[nodiscard]] double GetDelaySamples(double scale) const;
+    [[nodiscard]] double Read(double delay);
   };
 }
 
@@ -12,6 +12,10 @@
 
 #include "Test.hh"
 #include "NodeDelay.hh"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
 
 static void Test()
 {
@@ -51,4 +55,135 @@ static void Test()
     testSkip(test_name, "NodeTesting is disabled.");
 #endif
   }
+
+  {
+    std::string test_name = "Fractional delay is interpolated.";
+#if LIBFMSYNTH_ENABLE_NODETESTING
+    const unsigned int sps = 1000;
+    fmsynth::NodeDelay node;
+    node.SetSamplesPerSecond(sps);
+    node.AddInputNode(fmsynth::Node::Channel::Form, nullptr);
+    node.SetDelayTime(0.0025);
+    double maxdiff = 0;
+    for(long i = 0; i < 100; i++)
+      {
+        node.PushInput(nullptr, fmsynth::Node::Channel::Form, static_cast<double>(i));
+        node.FinishFrame(i);
+        if(i >= 3)
+          maxdiff = std::max(maxdiff, std::abs(node.GetLastFrame() - (static_cast<double>(i) - 2.5)));
+      }
+    testComment << "maxdiff=" << maxdiff << "\n";
+    testAssert(test_name, maxdiff < 0.000001);
+#else
+    testSkip(test_name, "NodeTesting is disabled.");
+#endif
+  }
+
+  for(auto max_delay_time : { 0.0, 0.02 })
+    {
+      std::string test_name = "Changing the delay time keeps the history, max delay time " + std::to_string(max_delay_time) + "s.";
+#if LIBFMSYNTH_ENABLE_NODETESTING
+      // Without a max delay time, the buffer of the 10 frames delay grows when the delay is changed to 14 frames,
+      // and is kept when it is changed back. With it, the buffer is sized once and only the read distance changes:
+      fmsynth::NodeDelay node;
+      node.SetSamplesPerSecond(1000);
+      node.SetMaxDelayTime(max_delay_time);
+      node.AddInputNode(fmsynth::Node::Channel::Form, nullptr);
+      node.SetDelayTime(0.01);
+      bool same = true;
+      for(long i = 0; i < 100; i++)
+        {
+          if(i == 30)
+            node.SetDelayTime(0.014);
+          if(i == 60)
+            node.SetDelayTime(0.01);
+          node.PushInput(nullptr, fmsynth::Node::Channel::Form, static_cast<double>(i));
+          node.FinishFrame(i);
+          long expected = std::max(0l, i - (i >= 30 && i < 60 ? 14 : 10));
+          if(i >= 10 && !FloatEqual(node.GetLastFrame(), static_cast<double>(expected), 0.0))
+            {
+              testComment << "frame " << i << ": " << node.GetLastFrame() << ", expected " << expected << "\n";
+              same = false;
+            }
+        }
+      testAssert(test_name, same);
+#else
+      testSkip(test_name, "NodeTesting is disabled.");
+#endif
+    }
+
+  {
+    const unsigned int sps = 1000;
+    const unsigned int frames = 1000;
+    std::vector<fmsynth::sample_t> amplitude(frames, 0.5);
+    std::vector<fmsynth::sample_t> form(frames);
+    std::vector<fmsynth::sample_t> aux(frames);
+    for(unsigned int i = 0; i < frames; i++)
+      {
+        form[i] = fmsynth::ToSample(std::sin(0.05 * i));
+        aux[i] = fmsynth::ToSample(0.5 + 0.5 * std::sin(0.01 * i));
+      }
+
+    const std::vector<std::pair<fmsynth::NodeDelay::Interpolation, std::string>> interpolations {
+      { fmsynth::NodeDelay::Interpolation::LINEAR,  "linear"  },
+      { fmsynth::NodeDelay::Interpolation::CUBIC,   "cubic"   },
+      { fmsynth::NodeDelay::Interpolation::ALLPASS, "allpass" },
+    };
+    // The short whole delay makes the blocks wrap around the ring buffer several times:
+    for(auto delay : { 0.0, 0.003, 0.0125, 0.1 })
+      for(auto use_aux : { false, true })
+        for(auto & [interpolation, name] : interpolations)
+          {
+            std::string test_name = "Block rendering matches the per frame output with " + name + " interpolation, delay " + std::to_string(delay) + "s" + (use_aux ? " modulated." : ".");
+#if LIBFMSYNTH_ENABLE_NODETESTING
+            fmsynth::NodeDelay tick;
+            fmsynth::NodeDelay block;
+            for(auto d : { &tick, &block })
+              {
+                d->SetSamplesPerSecond(sps);
+                d->SetDelayTime(delay);
+                d->SetInterpolation(interpolation);
+                d->AddInputNode(fmsynth::Node::Channel::Form, nullptr);
+                d->AddInputNode(fmsynth::Node::Channel::Amplitude, nullptr);
+                if(use_aux)
+                  d->AddInputNode(fmsynth::Node::Channel::Aux, nullptr);
+              }
+
+            std::vector<fmsynth::sample_t> output(frames);
+            block.RenderBlock(0, frames / 2, amplitude.data(), form.data(), aux.data(), output.data());
+            block.RenderBlock(frames / 2, frames / 2, amplitude.data() + frames / 2, form.data() + frames / 2, aux.data() + frames / 2, output.data() + frames / 2);
+
+            double maxdiff = 0;
+            for(unsigned int i = 0; i < frames; i++)
+              {
+                tick.PushInput(nullptr, fmsynth::Node::Channel::Form,      fmsynth::ToDouble(form[i]));
+                tick.PushInput(nullptr, fmsynth::Node::Channel::Amplitude, fmsynth::ToDouble(amplitude[i]));
+                if(use_aux)
+                  tick.PushInput(nullptr, fmsynth::Node::Channel::Aux, fmsynth::ToDouble(aux[i]));
+                tick.FinishFrame(i);
+                maxdiff = std::max(maxdiff, std::abs(tick.GetLastFrame() - fmsynth::ToDouble(output[i])));
+              }
+            testComment << "maxdiff=" << maxdiff << "\n";
+            testAssert(test_name, maxdiff < 0.000001);
+#else
+            testSkip(test_name, "NodeTesting is disabled.");
+#endif
+          }
+  }
+
+  {
+    // The delay line is cleared when the node is skipped, it does not replay the input from before:
+    const unsigned int frames = 100;
+    fmsynth::NodeDelay node;
+    node.SetSamplesPerSecond(1000);
+    node.SetDelayTime(0.01);
+    std::vector<fmsynth::sample_t> ones(frames, 1);
+    std::vector<fmsynth::sample_t> zeros(frames, 0);
+    std::vector<fmsynth::sample_t> output(frames);
+    node.RenderBlock(0, frames, ones.data(), ones.data(), zeros.data(), output.data());
+    node.SkipBlock();
+    node.RenderBlock(2 * frames, frames, ones.data(), zeros.data(), zeros.data(), output.data());
+    testAssert("Skipped delay does not output the input from before skipping.",
+               std::all_of(output.cbegin(), output.cend(), [](fmsynth::sample_t v) { return !(std::abs(v) > 0); }));
+  }
 }
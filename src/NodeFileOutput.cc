@@ -11,26 +11,36 @@
 */
 
 #include "NodeFileOutput.hh"
-#include <iostream>
-#include <AudioFile.h>
 
 using namespace fmsynth;
 
 
 NodeFileOutput::NodeFileOutput()
   : Node("FileOutput"),
-    _file(new AudioFile<double>()),
-    _filename("")
+    _filename(""),
+    _format(WavWriter::Format::PCM16)
 {
   GetInput(Channel::Form)->SetInputRange(Input::Range::MinusOne_One);
   SetPreprocessAmplitude();
-  _file->setNumChannels(1);
+}
+
+
+NodeFileOutput::NodeFileOutput(const NodeFileOutput & src)
+  : Node(src),
+    _filename(src._filename),
+    _format(src._format)
+{
+}
+
+
+std::shared_ptr<Node> NodeFileOutput::Clone() const
+{
+  return std::make_shared<NodeFileOutput>(*this);
 }
 
 
 NodeFileOutput::~NodeFileOutput()
 {
-  delete _file;
 }
 
 
@@ -46,36 +56,84 @@ void NodeFileOutput::SetFilename(const std::string & filename)
 }
 
 
-double NodeFileOutput::ProcessInput([[maybe_unused]] double time, double form)
+WavWriter::Format NodeFileOutput::GetFormat() const
 {
-  auto ind = _file->samples[0u].size();
-  _file->setNumSamplesPerChannel(static_cast<int>(ind + 1));
-  _file->samples[0u][ind] = form;
+  return _format;
+}
+
+
+void NodeFileOutput::SetFormat(WavWriter::Format format)
+{
+  _format = format;
+}
+
+
+const AsyncWavWriter & NodeFileOutput::GetWriter() const
+{
+  return _writer;
+}
 
+
+double NodeFileOutput::ProcessInput([[maybe_unused]] double time, double form)
+{
+  Write(&form, 1);
   return form;
 }
 
 
-void NodeFileOutput::OnEOF()
+void NodeFileOutput::ProcessBlock([[maybe_unused]] long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, [[maybe_unused]] const sample_t * aux, sample_t * output)
 {
-  if(!_filename.empty())
+  for(unsigned int i = 0; i < frames; i++)
+    output[i] = amplitude[i] * form[i];
+#if LIBFMSYNTH_FLOAT_SAMPLES
+  // The samples are written as doubles, like the frames of ProcessInput():
+  thread_local std::vector<double> samples;
+  samples.assign(output, output + frames);
+  Write(samples.data(), frames);
+#else
+  Write(output, frames);
+#endif
+}
+
+
+void NodeFileOutput::Write(const double * samples, unsigned int frames)
+{
+  if(!_writer.IsOpen())
     {
-      std::cout << "Writing " << _filename << std::endl;
-      _file->save(_filename);
+      if(_filename.empty())
+        return;
+      _writer.Open(_filename, GetSamplesPerSecond(), 1, _format);
+      if(!_writer.IsOpen())
+        return;
     }
-  _file->setNumSamplesPerChannel(0);
-}    
+  _writer.Write(samples, frames);
+}
+
+
+void NodeFileOutput::OnEOF()
+{
+  if(_writer.IsOpen())
+    _writer.Close();
+}
 
 
 json11::Json NodeFileOutput::to_json() const
 {
   auto rv = Node::to_json().object_items();
   rv["fileoutput_filename"] = _filename;
+  rv["fileoutput_format"]   = WavWriter::GetFormatName(_format);
   return rv;
 }
 
 void NodeFileOutput::SetFromJson(const json11::Json & json)
 {
   Node::SetFromJson(json);
-  _filename = json["constant_value"].string_value();
+  _filename = json["fileoutput_filename"].string_value();
+  _format = WavWriter::GetFormatByName(json["fileoutput_format"].string_value()).value_or(WavWriter::Format::PCM16);
+}
+
+
+bool NodeFileOutput::HasSideEffects() const
+{
+  return true;
 }
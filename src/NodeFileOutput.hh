@@ -13,8 +13,7 @@
 */
 
 #include "Node.hh"
-
-template <class T> class AudioFile;
+#include "AsyncWavWriter.hh"
 
 namespace fmsynth
 {
@@ -22,26 +21,39 @@ namespace fmsynth
   {
   public:
     NodeFileOutput();
-    NodeFileOutput(const NodeFileOutput & src)             = delete;
+    NodeFileOutput(const NodeFileOutput & src); // Copies the file name and the format, the copy writes its own file.
     NodeFileOutput(NodeFileOutput && src)                  = delete;
     ~NodeFileOutput();
 
     NodeFileOutput & operator=(const NodeFileOutput & rhs) = delete;
     NodeFileOutput & operator=(NodeFileOutput && rhs)      = delete;
 
-    [[nodiscard]] const std::string & GetFilename() const;
-    void                              SetFilename(const std::string & filename);
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
+
+    [[nodiscard]] bool HasSideEffects() const override;
+
+    // The file is opened when the first sample is written, and closed at the end of the blueprint.
+    // The file is written by a thread of its own, the audio thread does not wait for it:
+    [[nodiscard]] const std::string &    GetFilename() const;
+    void                                 SetFilename(const std::string & filename);
+    [[nodiscard]] WavWriter::Format      GetFormat() const;
+    void                                 SetFormat(WavWriter::Format format);
+    [[nodiscard]] const AsyncWavWriter & GetWriter() const; // For the statistics of the writer thread.
 
     [[nodiscard]] json11::Json to_json() const                        override;
     void                       SetFromJson(const json11::Json & json) override;
   
   protected:
     [[nodiscard]] double ProcessInput(double time, double form) override;
+    void                 ProcessBlock(long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output) override;
     void                 OnEOF() override;
 
   private:
-    AudioFile<double> * _file;
-    std::string         _filename;
+    AsyncWavWriter    _writer;
+    std::string       _filename;
+    WavWriter::Format _format;
+
+    void Write(const double * samples, unsigned int frames);
   };
 }
 
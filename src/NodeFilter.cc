@@ -11,21 +11,42 @@
 */
 
 #include "NodeFilter.hh"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <numbers>
 
 using namespace fmsynth;
 
 
+static bool IsSame(double a, double b)
+{
+  return !(a < b) && !(a > b);
+}
+
+
 NodeFilter::NodeFilter()
   : Node("Filter"),
     _type(Type::LOW_PASS),
     _filter(0.5),
+    _resonance(std::numbers::sqrt2 / 2.0),
     _first(true),
     _lowpass_previous(0),
     _highpass_previous_input(0),
-    _highpass_previous_filtered(0)
+    _highpass_previous_filtered(0),
+    _bank(1),
+    _bank_valid(false),
+    _bank_type(Type::LOW_PASS),
+    _bank_value(0),
+    _bank_resonance(0),
+    _bank_samples_per_second(0)
+{
+}
+
+
+std::shared_ptr<Node> NodeFilter::Clone() const
 {
+  return std::make_shared<NodeFilter>(*this);
 }
 
 
@@ -41,6 +62,12 @@ double NodeFilter::GetFilterValue() const
 }
 
 
+double NodeFilter::GetFilterResonance() const
+{
+  return _resonance;
+}
+
+
 void NodeFilter::SetFilterType(Type type)
 {
   _type = type;
@@ -53,6 +80,51 @@ void NodeFilter::SetFilterValue(double value)
 }
 
 
+void NodeFilter::SetFilterResonance(double resonance)
+{
+  _resonance = resonance;
+}
+
+
+double NodeFilter::GetCutoffFrequency(double value)
+{
+  return 20.0 * std::pow(1000.0, std::clamp(value, 0.0, 1.0));
+}
+
+
+bool NodeFilter::IsStateVariable() const
+{
+  return _type != Type::LOW_PASS && _type != Type::HIGH_PASS;
+}
+
+
+void NodeFilter::UpdateBank(double filter)
+{
+  if(_bank_valid
+     && _bank_type == _type
+     && IsSame(_bank_value, filter)
+     && IsSame(_bank_resonance, _resonance)
+     && _bank_samples_per_second == GetSamplesPerSecond())
+    return;
+
+  FilterBank::Mode mode;
+  switch(_type)
+    {
+    case Type::RESONANT_HIGH_PASS: mode = FilterBank::Mode::HighPass; break;
+    case Type::BAND_PASS:          mode = FilterBank::Mode::BandPass; break;
+    case Type::NOTCH:              mode = FilterBank::Mode::Notch;    break;
+    default:                       mode = FilterBank::Mode::LowPass;  break;
+    }
+  _bank.SetFilter(0, mode, GetCutoffFrequency(filter) / static_cast<double>(GetSamplesPerSecond()), _resonance);
+
+  _bank_valid              = true;
+  _bank_type               = _type;
+  _bank_value              = filter;
+  _bank_resonance          = _resonance;
+  _bank_samples_per_second = GetSamplesPerSecond();
+}
+
+
 double NodeFilter::ProcessInput([[maybe_unused]] double time, double form)
 {
   auto filter = _filter;
@@ -64,11 +136,170 @@ double NodeFilter::ProcessInput([[maybe_unused]] double time, double form)
     {
     case Type::LOW_PASS:  form = LowPass(filter, form);  break;
     case Type::HIGH_PASS: form = HighPass(filter, form); break;
+    case Type::RESONANT_LOW_PASS:
+    case Type::RESONANT_HIGH_PASS:
+    case Type::BAND_PASS:
+    case Type::NOTCH:
+      {
+        UpdateBank(filter);
+        auto sample = ToSample(form);
+        _bank.Process(&sample, &sample, 1);
+        form = ToDouble(sample);
+      }
+      break;
     }
   return form;
 }
 
 
+void NodeFilter::ProcessBlock([[maybe_unused]] long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output)
+{
+  bool has_aux = GetInput(Channel::Aux)->GetInputNodes().size() > 0;
+
+  if(IsStateVariable())
+    {
+      // Process the runs of frames with the same filter value at once, the coefficients change only between them:
+      unsigned int start = 0;
+      while(start < frames)
+        {
+          double filter = has_aux ? ToDouble(aux[start]) : _filter;
+          unsigned int end = start + 1;
+          if(has_aux)
+            while(end < frames && IsSame(ToDouble(aux[end]), filter))
+              end++;
+          else
+            end = frames;
+
+          UpdateBank(filter);
+          _bank.Process(form + start, output + start, end - start);
+          start = end;
+        }
+    }
+  else
+    {
+      // The state of the one-pole filters is kept in double, a float state would not reach the input at low filter values:
+      unsigned int i = 0;
+      if(_first)
+        { // Only the first frame after the creation is special, keep the branch out of the loop:
+          double filter = has_aux ? ToDouble(aux[0]) : _filter;
+          double input  = ToDouble(form[0]);
+          output[0] = ToSample(_type == Type::LOW_PASS ? LowPass(filter, input) : HighPass(filter, input));
+          i = 1;
+        }
+      for(; i < frames; i++)
+        {
+          double filter = has_aux ? ToDouble(aux[i]) : _filter;
+          double input  = ToDouble(form[i]);
+          if(_type == Type::LOW_PASS)
+            {
+              _lowpass_previous = _lowpass_previous + filter * (input - _lowpass_previous);
+              output[i] = ToSample(_lowpass_previous);
+            }
+          else
+            {
+              _highpass_previous_filtered = filter * (_highpass_previous_filtered + input - _highpass_previous_input);
+              _highpass_previous_input    = input;
+              output[i] = ToSample(_highpass_previous_filtered);
+            }
+        }
+    }
+
+  for(unsigned int i = 0; i < frames; i++)
+    output[i] *= amplitude[i];
+}
+
+
+void NodeFilter::ProcessVoices(Node * const * nodes, unsigned int count, const long * time_indices, unsigned int frames,
+                               const sample_t * const * amplitude, const sample_t * const * form, const sample_t * const * aux, sample_t * const * output)
+{
+  // The state variable filters with a fixed filter value are gathered into one bank, which filters all the voices in one pass:
+  _voices.clear();
+  for(unsigned int v = 0; v < count; v++)
+    {
+      auto node = static_cast<NodeFilter *>(nodes[v]);
+      if(node->IsStateVariable() && node->GetInput(Channel::Aux)->GetInputNodes().empty())
+        _voices.push_back(v);
+      else
+        node->ProcessBlock(time_indices[v], frames, amplitude[v], form[v], aux[v], output[v]);
+    }
+  if(_voices.size() < 2)
+    {
+      for(auto v : _voices)
+        static_cast<NodeFilter *>(nodes[v])->ProcessBlock(time_indices[v], frames, amplitude[v], form[v], aux[v], output[v]);
+      return;
+    }
+
+  auto channels = static_cast<unsigned int>(_voices.size());
+  if(_voices_bank.GetChannelCount() != channels)
+    _voices_bank.SetChannelCount(channels);
+  _voices_buffer.resize(channels * frames);
+  auto buffer = _voices_buffer.data();
+
+  for(unsigned int c = 0; c < channels; c++)
+    {
+      auto v = _voices[c];
+      auto node = static_cast<NodeFilter *>(nodes[v]);
+      node->UpdateBank(node->_filter);
+      _voices_bank.CopyChannel(c, node->_bank, 0);
+      for(unsigned int i = 0; i < frames; i++)
+        buffer[i * channels + c] = form[v][i];
+    }
+
+  _voices_bank.Process(buffer, buffer, frames);
+
+  for(unsigned int c = 0; c < channels; c++)
+    {
+      auto v = _voices[c];
+      auto node = static_cast<NodeFilter *>(nodes[v]);
+      node->_bank.CopyChannel(0, _voices_bank, c);
+      for(unsigned int i = 0; i < frames; i++)
+        output[v][i] = buffer[i * channels + c] * amplitude[v][i];
+    }
+}
+
+
+void NodeFilter::ResetTime()
+{
+  Node::ResetTime();
+  _bank.Reset();
+  _first = true;
+}
+
+
+long NodeFilter::GetHistoryLength() const
+{
+  // The frames it takes for the response of the filter to decay by 240dB, the filter value of the Aux input is not known:
+  const double decay = std::log(1e12);
+  if(!GetInput(Channel::Aux)->GetInputNodes().empty())
+    return -1;
+
+  double frames = 0;
+  if(IsStateVariable())
+    { // The poles of the state variable filter decay by exp(-w / 2Q) per frame:
+      double w = 2.0 * std::numbers::pi * GetCutoffFrequency(_filter) / static_cast<double>(GetSamplesPerSecond());
+      if(!(_resonance > 0) || !(w > 0))
+        return -1;
+      frames = decay * 2.0 * _resonance / w;
+    }
+  else
+    { // The pole of the one-pole filters:
+      double pole = _type == Type::LOW_PASS ? 1.0 - _filter : _filter;
+      if(!(std::abs(pole) < 1))
+        return -1;
+      if(std::abs(pole) > 0)
+        frames = decay / -std::log(std::abs(pole));
+    }
+  return static_cast<long>(std::ceil(frames)) + 1;
+}
+
+
+void NodeFilter::OnSkip()
+{
+  _bank.Reset();
+  _first = true;
+}
+
+
 double NodeFilter::LowPass(double filter, double input)
 {
   double output;
@@ -123,6 +354,7 @@ json11::Json NodeFilter::to_json() const
   auto rv = Node::to_json().object_items();
   rv["filter_type"]  = static_cast<int>(_type);
   rv["filter_value"] = _filter;
+  rv["filter_resonance"] = _resonance;
   return rv;
 }
 
@@ -132,4 +364,6 @@ void NodeFilter::SetFromJson(const json11::Json & json)
   Node::SetFromJson(json);
   _type   = static_cast<Type>(json["filter_type"].int_value());
   _filter = json["filter_value"].number_value();
+  if(json["filter_resonance"].is_number())
+    _resonance = json["filter_resonance"].number_value();
 }
@@ -12,7 +12,9 @@
   Complete license can be found in the LICENSE file.
 */
 
+#include "FilterBank.hh"
 #include "Node.hh"
+#include <vector>
 
 
 namespace fmsynth
@@ -21,16 +23,28 @@ namespace fmsynth
   {
   public:
     enum class Type {
-      LOW_PASS,
-      HIGH_PASS
+      LOW_PASS,  // One-pole, the filter value is the smoothing coefficient.
+      HIGH_PASS, // One-pole, the filter value is the smoothing coefficient.
+      RESONANT_LOW_PASS,
+      RESONANT_HIGH_PASS,
+      BAND_PASS,
+      NOTCH
     };
 
     NodeFilter();
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
 
-    [[nodiscard]] Type   GetFilterType()  const;
-    [[nodiscard]] double GetFilterValue() const;
+    [[nodiscard]] Type   GetFilterType()      const;
+    [[nodiscard]] double GetFilterValue()     const;
+    [[nodiscard]] double GetFilterResonance() const;
     void                 SetFilterType(Type type);
     void                 SetFilterValue(double value);
+    void                 SetFilterResonance(double resonance);
+    void                 ResetTime() override;
+    [[nodiscard]] long   GetHistoryLength() const override;
+
+    // The filter value in range [0, 1] of the state variable filter types maps exponentially to 20Hz - 20kHz:
+    [[nodiscard]] static double GetCutoffFrequency(double value);
 
     [[nodiscard]] Input::Range GetInputRange(Channel channel) const override;
     [[nodiscard]] Input::Range GetFormOutputRange() const override;
@@ -40,18 +54,36 @@ namespace fmsynth
   
   protected:
     [[nodiscard]] double ProcessInput(double time, double form) override;
+    void                 ProcessBlock(long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output) override;
+    void                 ProcessVoices(Node * const * nodes, unsigned int count, const long * time_indices, unsigned int frames,
+                                       const sample_t * const * amplitude, const sample_t * const * form, const sample_t * const * aux, sample_t * const * output) override;
+    void                 OnSkip() override;
 
   private:
     Type   _type;
     double _filter;
+    double _resonance; // Q factor of the state variable filter types.
   
     bool   _first;
     double _lowpass_previous;
     double _highpass_previous_input;
     double _highpass_previous_filtered;
 
+    FilterBank   _bank;           // Single channel, for the state variable filter types.
+    bool         _bank_valid;     // The coefficients of the bank are set from the values below.
+    Type         _bank_type;
+    double       _bank_value;
+    double       _bank_resonance;
+    unsigned int _bank_samples_per_second;
+
+    FilterBank                _voices_bank;   // The banks of the voices gathered by ProcessVoices(), a channel per voice.
+    std::vector<unsigned int> _voices;
+    std::vector<sample_t>     _voices_buffer; // The interleaved input and output of the voices.
+
     [[nodiscard]] double LowPass(double filter, double input);
     [[nodiscard]] double HighPass(double filter, double input);
+    [[nodiscard]] bool   IsStateVariable() const;
+    void                 UpdateBank(double filter);
   };
 }
 
@@ -0,0 +1,94 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "NodeFilter.hh"
+#include "Test.hh"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+
+static void Test()
+{
+#if LIBFMSYNTH_ENABLE_NODETESTING
+  const std::vector<std::pair<fmsynth::NodeFilter::Type, std::string>> types {
+    { fmsynth::NodeFilter::Type::LOW_PASS,           "low pass"           },
+    { fmsynth::NodeFilter::Type::HIGH_PASS,          "high pass"          },
+    { fmsynth::NodeFilter::Type::RESONANT_LOW_PASS,  "resonant low pass"  },
+    { fmsynth::NodeFilter::Type::RESONANT_HIGH_PASS, "resonant high pass" },
+    { fmsynth::NodeFilter::Type::BAND_PASS,          "band pass"          },
+    { fmsynth::NodeFilter::Type::NOTCH,              "notch"              },
+  };
+
+  {
+    const unsigned int sps = 48000;
+    const unsigned int frames = 1000;
+    std::vector<fmsynth::sample_t> amplitude(frames, 0.5);
+    std::vector<fmsynth::sample_t> form(frames);
+    std::vector<fmsynth::sample_t> aux(frames);
+    for(unsigned int i = 0; i < frames; i++)
+      {
+        form[i] = fmsynth::ToSample(std::sin(0.05 * i) + std::sin(0.7 * i));
+        aux[i] = fmsynth::ToSample(0.1 * (i / 100)); // Steps, the filter is set once for each of them.
+      }
+
+    for(auto use_aux : { false, true })
+      for(auto & [type, name] : types)
+        {
+          fmsynth::NodeFilter tick;
+          fmsynth::NodeFilter block;
+          for(auto f : { &tick, &block })
+            {
+              f->SetSamplesPerSecond(sps);
+              f->SetFilterType(type);
+              f->SetFilterValue(0.3);
+              f->SetFilterResonance(2);
+              f->AddInputNode(fmsynth::Node::Channel::Form, nullptr);
+              f->AddInputNode(fmsynth::Node::Channel::Amplitude, nullptr);
+              if(use_aux)
+                f->AddInputNode(fmsynth::Node::Channel::Aux, nullptr);
+            }
+
+          std::vector<fmsynth::sample_t> output(frames);
+          block.RenderBlock(0, frames, amplitude.data(), form.data(), aux.data(), output.data());
+
+          double maxdiff = 0;
+          for(unsigned int i = 0; i < frames; i++)
+            {
+              tick.PushInput(nullptr, fmsynth::Node::Channel::Form,      fmsynth::ToDouble(form[i]));
+              tick.PushInput(nullptr, fmsynth::Node::Channel::Amplitude, fmsynth::ToDouble(amplitude[i]));
+              if(use_aux)
+                tick.PushInput(nullptr, fmsynth::Node::Channel::Aux, fmsynth::ToDouble(aux[i]));
+              tick.FinishFrame(i);
+              maxdiff = std::max(maxdiff, std::abs(tick.GetLastFrame() - fmsynth::ToDouble(output[i])));
+            }
+          testComment << name << (use_aux ? " with aux" : "") << ": maxdiff=" << maxdiff << "\n";
+          testAssert("Block rendering matches the per frame output of " + name + (use_aux ? " with aux." : "."), maxdiff < 0.000001);
+        }
+  }
+
+  {
+    fmsynth::NodeFilter a;
+    a.SetFilterType(fmsynth::NodeFilter::Type::NOTCH);
+    a.SetFilterResonance(3.5);
+    fmsynth::NodeFilter b;
+    b.SetFromJson(a.to_json());
+    testAssert("Filter type and resonance are saved and loaded.", b.GetFilterType() == fmsynth::NodeFilter::Type::NOTCH && FloatEqual(b.GetFilterResonance(), 3.5, 0.0));
+  }
+#else
+  for(auto use_aux : { false, true })
+    for(auto name : { "low pass", "high pass", "resonant low pass", "resonant high pass", "band pass", "notch" })
+      testSkip(std::string("Block rendering matches the per frame output of ") + name + (use_aux ? " with aux." : "."), "NodeTesting is disabled.");
+  testSkip("Filter type and resonance are saved and loaded.", "NodeTesting is disabled.");
+#endif
+}
@@ -31,6 +31,12 @@ NodeGrowth::NodeGrowth()
 }
 
 
+std::shared_ptr<Node> NodeGrowth::Clone() const
+{
+  return std::make_shared<NodeGrowth>(*this);
+}
+
+
 double NodeGrowth::ProcessInput(double time, [[maybe_unused]] double form)
 {
   auto GetNextValue = [this, &time]() -> double
@@ -89,6 +95,66 @@ double NodeGrowth::ProcessInput(double time, [[maybe_unused]] double form)
 }
 
 
+const ConstantValue & NodeGrowth::GetStartValue() const
+{
+  return _start_value;
+}
+
+
+void NodeGrowth::SetStartValue(const ConstantValue & start_value)
+{
+  _start_value = start_value;
+}
+
+
+NodeGrowth::Formula NodeGrowth::GetGrowthFormula() const
+{
+  return _growth_formula;
+}
+
+
+void NodeGrowth::SetGrowthFormula(Formula growth_formula)
+{
+  _growth_formula = growth_formula;
+}
+
+
+const ConstantValue & NodeGrowth::GetGrowthAmount() const
+{
+  return _growth_amount;
+}
+
+
+void NodeGrowth::SetGrowthAmount(const ConstantValue & growth_amount)
+{
+  _growth_amount = growth_amount;
+}
+
+
+NodeGrowth::EndAction NodeGrowth::GetEndAction() const
+{
+  return _end_action;
+}
+
+
+void NodeGrowth::SetEndAction(EndAction end_action)
+{
+  _end_action = end_action;
+}
+
+
+const ConstantValue & NodeGrowth::GetEndValue() const
+{
+  return _end_value;
+}
+
+
+void NodeGrowth::SetEndValue(const ConstantValue & end_value)
+{
+  _end_value = end_value;
+}
+
+
 void NodeGrowth::ResetTime()
 {
   Node::ResetTime();
@@ -124,3 +190,28 @@ void NodeGrowth::SetFromJson(const json11::Json & json)
   _end_action = static_cast<EndAction>(json["growth_end_action"].int_value());
   _end_value.SetFromJson(json["growth_end_value"]);
 }
+
+
+bool NodeGrowth::HasSideEffects() const
+{
+  return true;
+}
+
+
+bool NodeGrowth::CanRunAtControlRate() const
+{
+  return true;
+}
+
+
+bool NodeGrowth::CanFinish() const
+{
+  return _end_action == EndAction::Stop;
+}
+
+
+long NodeGrowth::GetHistoryLength() const
+{
+  // The value is a function of the time, except that repeating the last value and restarting depend on when the growth ended:
+  return _end_action == EndAction::NoEnd || _end_action == EndAction::Stop ? 0 : -1;
+}
@@ -25,12 +25,23 @@ namespace fmsynth
     enum class EndAction { NoEnd, RepeatLast, RestartFromStart, Stop };
     
     NodeGrowth();
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
 
-    [[nodiscard]] ConstantValue & ParamStartValue()    { return _start_value;    }
-    [[nodiscard]] Formula &       ParamGrowthFormula() { return _growth_formula; }
-    [[nodiscard]] ConstantValue & ParamGrowthAmount()  { return _growth_amount;  }
-    [[nodiscard]] EndAction &     ParamEndAction()     { return _end_action;     }
-    [[nodiscard]] ConstantValue & ParamEndValue()      { return _end_value;      }
+    [[nodiscard]] bool HasSideEffects() const override;
+    [[nodiscard]] bool CanRunAtControlRate() const override;
+    [[nodiscard]] bool CanFinish() const override;
+    [[nodiscard]] long GetHistoryLength() const override;
+
+    [[nodiscard]] const ConstantValue & GetStartValue()    const;
+    void                                SetStartValue(const ConstantValue & start_value);
+    [[nodiscard]] Formula               GetGrowthFormula() const;
+    void                                SetGrowthFormula(Formula growth_formula);
+    [[nodiscard]] const ConstantValue & GetGrowthAmount()  const;
+    void                                SetGrowthAmount(const ConstantValue & growth_amount);
+    [[nodiscard]] EndAction             GetEndAction()     const;
+    void                                SetEndAction(EndAction end_action);
+    [[nodiscard]] const ConstantValue & GetEndValue()      const;
+    void                                SetEndValue(const ConstantValue & end_value);
 
     void                       ResetTime()                            override;
     [[nodiscard]] Input::Range GetFormOutputRange() const             override;
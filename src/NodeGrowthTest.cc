@@ -22,10 +22,10 @@ static void Test()
     bp.SetSamplesPerSecond(10);
     
     auto node = std::make_shared<fmsynth::NodeGrowth>();
-    node->ParamStartValue()    = { 0, fmsynth::ConstantValue::Unit::Absolute };
-    node->ParamGrowthFormula() = fmsynth::NodeGrowth::Formula::Linear;
-    node->ParamGrowthAmount()  = { 1, fmsynth::ConstantValue::Unit::Absolute };
-    node->ParamEndAction()     = fmsynth::NodeGrowth::EndAction::NoEnd;
+    node->SetStartValue({ 0, fmsynth::ConstantValue::Unit::Absolute });
+    node->SetGrowthFormula(fmsynth::NodeGrowth::Formula::Linear);
+    node->SetGrowthAmount({ 1, fmsynth::ConstantValue::Unit::Absolute });
+    node->SetEndAction(fmsynth::NodeGrowth::EndAction::NoEnd);
     bp.AddNode(node);
 
     std::string test_name = "Linear-NoEnd grows expectedly.";
@@ -48,11 +48,11 @@ static void Test()
     bp.SetSamplesPerSecond(10);
     
     auto node = std::make_shared<fmsynth::NodeGrowth>();
-    node->ParamStartValue()    = { 0, fmsynth::ConstantValue::Unit::Absolute };
-    node->ParamGrowthFormula() = fmsynth::NodeGrowth::Formula::Linear;
-    node->ParamGrowthAmount()  = { 1, fmsynth::ConstantValue::Unit::Absolute };
-    node->ParamEndAction()     = fmsynth::NodeGrowth::EndAction::RepeatLast;
-    node->ParamEndValue()      = { 1, fmsynth::ConstantValue::Unit::Absolute };
+    node->SetStartValue({ 0, fmsynth::ConstantValue::Unit::Absolute });
+    node->SetGrowthFormula(fmsynth::NodeGrowth::Formula::Linear);
+    node->SetGrowthAmount({ 1, fmsynth::ConstantValue::Unit::Absolute });
+    node->SetEndAction(fmsynth::NodeGrowth::EndAction::RepeatLast);
+    node->SetEndValue({ 1, fmsynth::ConstantValue::Unit::Absolute });
     bp.AddNode(node);
 
     std::string test_name = "Linear-RepeatLast grows expectedly.";
@@ -22,6 +22,12 @@ NodeInverse::NodeInverse()
 }
 
 
+std::shared_ptr<Node> NodeInverse::Clone() const
+{
+  return std::make_shared<NodeInverse>(*this);
+}
+
+
 double NodeInverse::ProcessInput([[maybe_unused]] double time, double form)
 {
   switch(GetInput(Channel::Form)->GetInputRange())
@@ -41,3 +47,9 @@ Input::Range NodeInverse::GetFormOutputRange() const
 {
   return GetInput(Channel::Form)->GetInputRange();
 }
+
+
+bool NodeInverse::IsStateless() const
+{
+  return true;
+}
@@ -21,6 +21,9 @@ namespace fmsynth
   {
   public:
     NodeInverse();
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
+
+    [[nodiscard]] bool IsStateless() const override;
 
     [[nodiscard]] Input::Range GetFormOutputRange() const       override;
   
@@ -11,13 +11,16 @@
 */
 
 #include "NodeMemoryBuffer.hh"
+#include <algorithm>
 
 using namespace fmsynth;
 
 
 NodeMemoryBuffer::NodeMemoryBuffer()
-  : Node("MemoryBuffer")
+  : Node("MemoryBuffer"),
+    _clear_buffer(false)
 {
+  _pending.reserve(64 * 1024);
   SetMaxLength(10);
   SetPreprocessAmplitude();
 }
@@ -32,6 +35,8 @@ void NodeMemoryBuffer::SetMaxLength(double seconds)
 
 const std::vector<double> NodeMemoryBuffer::GetData() const
 {
+  if(_clear_buffer)
+    return {};
   return _buffer;
 }
 
@@ -44,16 +49,59 @@ std::mutex & NodeMemoryBuffer::GetLockMutex()
 
 double NodeMemoryBuffer::ProcessInput([[maybe_unused]] double time, double form)
 {
-  std::lock_guard lock(_mutex);
-  if(_buffer.size() < _max_samples)
-    _buffer.push_back(form);
+  Store(&form, 1);
   return form;
 }
 
 
+void NodeMemoryBuffer::ProcessBlock([[maybe_unused]] long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, [[maybe_unused]] const sample_t * aux, sample_t * output)
+{
+  for(unsigned int i = 0; i < frames; i++)
+    output[i] = amplitude[i] * form[i];
+#if LIBFMSYNTH_FLOAT_SAMPLES
+  // The samples are stored as doubles, like the frames of ProcessInput():
+  thread_local std::vector<double> samples;
+  samples.assign(output, output + frames);
+  Store(samples.data(), frames);
+#else
+  Store(output, frames);
+#endif
+}
+
+
+void NodeMemoryBuffer::Store(const double * samples, unsigned int frames)
+{
+  std::unique_lock lock(_mutex, std::try_to_lock);
+  if(!lock.owns_lock())
+    { // The samples which do not fit in the reserved memory are dropped:
+      auto count = std::min(static_cast<size_t>(frames), _pending.capacity() - _pending.size());
+      _pending.insert(_pending.end(), samples, samples + count);
+      return;
+    }
+
+  if(_clear_buffer.exchange(false))
+    _buffer.clear();
+  Append(_pending.data(), _pending.size());
+  _pending.clear();
+  Append(samples, frames);
+}
+
+
+void NodeMemoryBuffer::Append(const double * samples, size_t count)
+{
+  count = std::min(count, _max_samples - std::min(_buffer.size(), static_cast<size_t>(_max_samples)));
+  _buffer.insert(_buffer.end(), samples, samples + count);
+}
+
+
 void NodeMemoryBuffer::ResetTime()
 {
-  _buffer.clear();
+  _pending.clear();
+  std::unique_lock lock(_mutex, std::try_to_lock);
+  if(lock.owns_lock())
+    _buffer.clear();
+  else
+    _clear_buffer = true;
 }
 
 
@@ -61,3 +109,9 @@ Input::Range NodeMemoryBuffer::GetFormOutputRange() const
 {
   return GetInput(Channel::Form)->GetInputRange();
 }
+
+
+bool NodeMemoryBuffer::HasSideEffects() const
+{
+  return true;
+}
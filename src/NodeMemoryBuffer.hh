@@ -13,6 +13,7 @@
 */
 
 #include "Node.hh"
+#include <atomic>
 #include <mutex>
 #include <vector>
 
@@ -24,6 +25,10 @@ namespace fmsynth
   public:
     NodeMemoryBuffer();
 
+    [[nodiscard]] bool HasSideEffects() const override;
+
+    // The editor holds the lock mutex while it reads the data. The audio thread does not wait for it, the
+    // samples rendered meanwhile are kept aside and added to the data when the mutex is free again:
     void                                    SetMaxLength(double seconds);
     void                                    Clear();
     [[nodiscard]] const std::vector<double> GetData() const;
@@ -36,10 +41,15 @@ namespace fmsynth
     unsigned int        _max_samples;
     std::vector<double> _buffer;
     std::mutex          _mutex;
+    std::vector<double> _pending;      // The samples waiting for the mutex, used only by the rendering thread.
+    std::atomic<bool>   _clear_buffer; // Set when the time is reset while the mutex is held by someone else.
   
     [[nodiscard]] double ProcessInput(double time, double form) override;
+    void                 ProcessBlock(long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output) override;
   
   private:
+    void Store(const double * samples, unsigned int frames);
+    void Append(const double * samples, size_t count);
   };
 }
 
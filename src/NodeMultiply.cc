@@ -23,6 +23,12 @@ NodeMultiply::NodeMultiply()
 }
 
 
+std::shared_ptr<Node> NodeMultiply::Clone() const
+{
+  return std::make_shared<NodeMultiply>(*this);
+}
+
+
 double NodeMultiply::GetMultiplier() const
 {
   return _multiplier;
@@ -32,6 +38,7 @@ double NodeMultiply::GetMultiplier() const
 void NodeMultiply::SetMultiplier(double multiplier)
 {
   _multiplier = multiplier;
+  InvalidateGraph();
 }
 
 
@@ -41,6 +48,14 @@ double NodeMultiply::ProcessInput([[maybe_unused]] double time, double form)
 }
 
 
+void NodeMultiply::ProcessBlock([[maybe_unused]] long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, [[maybe_unused]] const sample_t * aux, sample_t * output)
+{
+  auto multiplier = ToSample(_multiplier);
+  for(unsigned int i = 0; i < frames; i++)
+    output[i] = amplitude[i] * (form[i] * multiplier);
+}
+
+
 Input::Range NodeMultiply::GetFormOutputRange() const
 {
   return GetInput(Channel::Amplitude)->GetInputRange();
@@ -59,3 +74,9 @@ void NodeMultiply::SetFromJson(const json11::Json & json)
   Node::SetFromJson(json);
   _multiplier = json["multiply_value"].number_value();
 }
+
+
+bool NodeMultiply::IsStateless() const
+{
+  return true;
+}
@@ -21,6 +21,9 @@ namespace fmsynth
   {
   public:
     NodeMultiply();
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
+
+    [[nodiscard]] bool IsStateless() const override;
 
     [[nodiscard]] double GetMultiplier() const;
     void                 SetMultiplier(double multiplier);
@@ -32,6 +35,7 @@ namespace fmsynth
   
   protected:
     [[nodiscard]] double ProcessInput(double time, double form)       override;
+    void                 ProcessBlock(long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output) override;
   
   private:
     double _multiplier;
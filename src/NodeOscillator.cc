@@ -11,23 +11,42 @@
 */
 
 #include "NodeOscillator.hh"
+#include "Kernels.hh"
+#include "Wavetable.hh"
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
 #include <numbers>
 
 using namespace fmsynth;
 
 
+static double SawtoothLevel(double sawtooth)
+{ // Keep the level of the earlier additive sawtooth, which was scaled down to fit its overshoot of 0.05 into [-1, 1].
+  return (sawtooth + 1.0) / 1.05 - 1.0;
+}
+
+
 NodeOscillator::NodeOscillator()
   : Node("Oscillator"),
     _type(Type::SINE),
     _pulse_duty_cycle(0.5),
-    _random_generator(0),
-    _rdist(0, 1)
+    _phase_accumulator(false),
+    _phase(0),
+    _wavetable(false),
+    _noise_seed(NoiseSeedFromId(GetId()))
 {
   SetOutputRange(Input::Range::MinusOne_One);
 }
 
 
+std::shared_ptr<Node> NodeOscillator::Clone() const
+{
+  return std::make_shared<NodeOscillator>(*this);
+}
+
+
 NodeOscillator::Type NodeOscillator::GetType() const
 {
   return _type;
@@ -69,6 +88,11 @@ double NodeOscillator::GetPulseDutyCycle() const
   return _pulse_duty_cycle;
 }
 
+bool NodeOscillator::IsPhaseAccumulator() const
+{
+  return _phase_accumulator;
+}
+
 void NodeOscillator::SetType(Type type)
 {
   _type = type;
@@ -79,43 +103,118 @@ void NodeOscillator::SetPulseDutyCycle(double pulse_duty_cycle)
   _pulse_duty_cycle = pulse_duty_cycle;
 }
 
+void NodeOscillator::SetPhaseAccumulator(bool phase_accumulator)
+{
+  _phase_accumulator = phase_accumulator;
+}
+
+
+bool NodeOscillator::IsWavetable() const
+{
+  return _wavetable;
+}
+
+void NodeOscillator::SetWavetable(bool wavetable)
+{
+  _wavetable = wavetable;
+}
+
+
+uint64_t NodeOscillator::GetNoiseSeed() const
+{
+  return _noise_seed;
+}
+
+void NodeOscillator::SetNoiseSeed(uint64_t noise_seed)
+{
+  _noise_seed = noise_seed & MaxNoiseSeed;
+}
+
+
+uint64_t NodeOscillator::NoiseSeedFromId(const std::string & id)
+{ // FNV-1a, std::hash is not the same on all platforms.
+  uint64_t hash = 0xCBF29CE484222325;
+  for(auto c : id)
+    {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 0x100000001B3;
+    }
+  return hash & MaxNoiseSeed;
+}
+
+
+double NodeOscillator::GetPulseDuty() const
+{ // Duty in the range of sin(), the pulse is high while sin(phase) <= duty.
+  auto aux = GetInput(Channel::Aux);
+  if(aux->GetInputNodes().size() > 0)
+    return (aux->GetValue() - 0.5) * 2.0;
+  return _pulse_duty_cycle * 2.0 - 1.0;
+}
+
+
+void NodeOscillator::ResetTime()
+{
+  Node::ResetTime();
+  _phase = 0;
+}
+
+
+long NodeOscillator::GetHistoryLength() const
+{
+  // The phase is form * time, and the noise is hashed from the time, unless the phase is accumulated:
+  return _phase_accumulator ? -1 : 0;
+}
+
+
+void NodeOscillator::AdvancePhase(double & phase, double increment)
+{
+  phase += increment;
+  if(!(std::abs(phase) <= std::numbers::pi))
+    phase = std::remainder(phase, 2.0 * std::numbers::pi);
+}
+
 
 
 double NodeOscillator::ProcessInput(double time, double form)
 {
+  double phase = form * time;
+  double increment = form / static_cast<double>(GetSamplesPerSecond());
+  if(_phase_accumulator)
+    {
+      phase = _phase;
+      AdvancePhase(_phase, increment);
+    }
+
+  if(_wavetable)
+    switch(_type)
+      {
+      case Type::SINE:     return Wavetable::Get(Wavetable::Wave::Sine).Lookup(phase, increment);
+      case Type::TRIANGLE: return Wavetable::Get(Wavetable::Wave::Triangle).Lookup(phase, increment);
+      case Type::SAWTOOTH: return SawtoothLevel(Wavetable::Get(Wavetable::Wave::Sawtooth).Lookup(phase, increment));
+      case Type::PULSE:    return Wavetable::Pulse(phase, increment, GetPulseDuty());
+      case Type::NOISE:    break;
+      }
+
   switch(_type)
     {
     case Type::SINE:
-      return std::sin(form * time);
+      return std::sin(phase);
 
     case Type::PULSE:
       {
-        double duty;
-        auto aux = GetInput(Channel::Aux);
-        if(aux->GetInputNodes().size() > 0)
-          duty = (aux->GetValue() - 0.5) * 2.0;
-        else
-          duty = _pulse_duty_cycle * 2.0 - 1.0;
-        
+        double duty = GetPulseDuty();
         if(duty <= -1)
           return -1;
-        return std::sin(form * time) <= duty ? 1 : -1;
+        return (std::sin(phase) <= duty ? 1 : -1) + kernels::PulseEdges(phase, increment, duty);
       }
     case Type::TRIANGLE:
-      return 2.0 / std::numbers::pi * std::asin(std::sin(form * time));
+      return 2.0 / std::numbers::pi * std::asin(std::sin(phase));
 
     case Type::SAWTOOTH:
-      {
-        double rv = 0;
-        for(double k = 1; k < 100; k++)
-          rv += std::pow(-1.0, k) * std::sin(k * form * time) / k;
-        rv = 0.5 - 1.0 / std::numbers::pi * rv;
-        // Range for rv at this point is approximately [-0.05, 1.05].
-        return rv / 1.05 * 2.0 - 1.0;
-      }
+      return SawtoothLevel(kernels::Sawtooth(phase, increment));
 
     case Type::NOISE:
-      return 2.0 * _rdist(_random_generator) - 1.0;
+      return kernels::Noise(_noise_seed, static_cast<uint64_t>(GetTimeIndex()));
     }
   
   assert(false);
@@ -123,11 +222,194 @@ double NodeOscillator::ProcessInput(double time, double form)
 }
 
 
+void NodeOscillator::ProcessBlock(long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output)
+{
+#if LIBFMSYNTH_FLOAT_SAMPLES
+  // The kernels work in double, the blocks are converted in chunks:
+  std::array<double, 256> frequency;
+  std::array<double, 256> auxd;
+  std::array<double, 256> wave;
+  bool auxduty = _type == Type::PULSE && GetInput(Channel::Aux)->GetInputNodes().size() > 0;
+  for(unsigned int offset = 0; offset < frames; offset += static_cast<unsigned int>(wave.size()))
+    {
+      auto count = std::min(frames - offset, static_cast<unsigned int>(wave.size()));
+      for(unsigned int i = 0; i < count; i++)
+        frequency[i] = static_cast<double>(form[offset + i]);
+      if(auxduty)
+        for(unsigned int i = 0; i < count; i++)
+          auxd[i] = static_cast<double>(aux[offset + i]);
+      ProcessWave(time_index + offset, count, frequency.data(), auxd.data(), wave.data());
+      for(unsigned int i = 0; i < count; i++)
+        output[offset + i] = static_cast<sample_t>(wave[i]) * amplitude[offset + i];
+    }
+#else
+  ProcessWave(time_index, frames, form, aux, output);
+  for(unsigned int i = 0; i < frames; i++)
+    output[i] *= amplitude[i];
+#endif
+}
+
+
+void NodeOscillator::ProcessVoices(Node * const * nodes, unsigned int count, const long * time_indices, unsigned int frames,
+                                   const sample_t * const * amplitude, const sample_t * const * form, const sample_t * const * aux, sample_t * const * output)
+{
+  // The phases of the phase accumulating voices are gathered into an array, and each voice is advanced over the block
+  // from its phase, which the wave kernels then replace with the wave:
+  auto sps = GetSamplesPerSecond();
+  _voices.clear();
+  for(unsigned int v = 0; v < count; v++)
+    {
+      auto node = static_cast<NodeOscillator *>(nodes[v]);
+      if(node->_phase_accumulator && node->_type != Type::NOISE && node->GetSamplesPerSecond() == sps)
+        _voices.push_back(v);
+      else
+        node->ProcessBlock(time_indices[v], frames, amplitude[v], form[v], aux[v], output[v]);
+    }
+  if(_voices.size() < 2)
+    {
+      for(auto v : _voices)
+        static_cast<NodeOscillator *>(nodes[v])->ProcessBlock(time_indices[v], frames, amplitude[v], form[v], aux[v], output[v]);
+      return;
+    }
+
+  auto channels = static_cast<unsigned int>(_voices.size());
+  _voices_phase.resize(channels);
+  for(unsigned int c = 0; c < channels; c++)
+    _voices_phase[c] = static_cast<NodeOscillator *>(nodes[_voices[c]])->_phase;
+
+  for(unsigned int c = 0; c < channels; c++)
+    {
+      auto v    = _voices[c];
+      auto node = static_cast<NodeOscillator *>(nodes[v]);
+#if LIBFMSYNTH_FLOAT_SAMPLES
+      std::array<double, 256> frequency;
+      std::array<double, 256> auxd;
+      std::array<double, 256> wave;
+      bool auxduty = node->_type == Type::PULSE && node->GetInput(Channel::Aux)->GetInputNodes().size() > 0;
+      for(unsigned int offset = 0; offset < frames; offset += static_cast<unsigned int>(wave.size()))
+        {
+          auto chunk = std::min(frames - offset, static_cast<unsigned int>(wave.size()));
+          for(unsigned int i = 0; i < chunk; i++)
+            {
+              frequency[i] = static_cast<double>(form[v][offset + i]);
+              wave[i]      = _voices_phase[c];
+              AdvancePhase(_voices_phase[c], frequency[i] / static_cast<double>(sps));
+            }
+          if(auxduty)
+            for(unsigned int i = 0; i < chunk; i++)
+              auxd[i] = static_cast<double>(aux[v][offset + i]);
+          node->PhaseToWave(chunk, frequency.data(), auxd.data(), wave.data());
+          for(unsigned int i = 0; i < chunk; i++)
+            output[v][offset + i] = static_cast<sample_t>(wave[i]) * amplitude[v][offset + i];
+        }
+#else
+      for(unsigned int i = 0; i < frames; i++)
+        {
+          output[v][i] = _voices_phase[c];
+          AdvancePhase(_voices_phase[c], form[v][i] / static_cast<double>(sps));
+        }
+      node->PhaseToWave(frames, form[v], aux[v], output[v]);
+      for(unsigned int i = 0; i < frames; i++)
+        output[v][i] *= amplitude[v][i];
+#endif
+    }
+
+  for(unsigned int c = 0; c < channels; c++)
+    static_cast<NodeOscillator *>(nodes[_voices[c]])->_phase = _voices_phase[c];
+}
+
+
+void NodeOscillator::ProcessWave(long time_index, unsigned int frames, const double * form, const double * aux, double * output)
+{
+  if(_type == Type::NOISE)
+    {
+      kernels::Noise(_noise_seed, static_cast<uint64_t>(time_index), output, frames);
+      if(_phase_accumulator)
+        for(unsigned int i = 0; i < frames; i++)
+          AdvancePhase(_phase, form[i] / static_cast<double>(GetSamplesPerSecond()));
+      return;
+    }
+
+  // The phase is calculated into the output buffer, and the kernels replace it with the wave:
+  auto sps = static_cast<double>(GetSamplesPerSecond());
+  if(_phase_accumulator)
+    for(unsigned int i = 0; i < frames; i++)
+      {
+        output[i] = _phase;
+        AdvancePhase(_phase, form[i] / sps);
+      }
+  else
+    for(unsigned int i = 0; i < frames; i++)
+      output[i] = form[i] * (static_cast<double>(time_index + i) / sps);
+
+  PhaseToWave(frames, form, aux, output);
+}
+
+
+void NodeOscillator::PhaseToWave(unsigned int frames, const double * form, const double * aux, double * output) const
+{
+  assert(_type != Type::NOISE);
+  auto sps = static_cast<double>(GetSamplesPerSecond());
+  switch(_type)
+    {
+    case Type::SINE:
+      if(_wavetable)
+        Wavetable::Get(Wavetable::Wave::Sine).Lookup(output, form, sps, output, frames);
+      else
+        kernels::Sine(output, output, frames);
+      break;
+    case Type::TRIANGLE:
+      if(_wavetable)
+        Wavetable::Get(Wavetable::Wave::Triangle).Lookup(output, form, sps, output, frames);
+      else
+        kernels::Triangle(output, output, frames);
+      break;
+    case Type::SAWTOOTH:
+      if(_wavetable)
+        Wavetable::Get(Wavetable::Wave::Sawtooth).Lookup(output, form, sps, output, frames);
+      else
+        kernels::Sawtooth(output, form, sps, output, frames);
+      for(unsigned int i = 0; i < frames; i++)
+        output[i] = SawtoothLevel(output[i]);
+      break;
+    case Type::PULSE:
+      { // The edges need the phase, process in chunks to keep it:
+        bool auxduty = GetInput(Channel::Aux)->GetInputNodes().size() > 0;
+        std::array<double, 256> phase;
+        std::array<double, 256> duty;
+        duty.fill(_pulse_duty_cycle * 2.0 - 1.0);
+        for(unsigned int offset = 0; offset < frames; offset += static_cast<unsigned int>(phase.size()))
+          {
+            auto count = std::min(frames - offset, static_cast<unsigned int>(phase.size()));
+            std::copy_n(output + offset, count, phase.data());
+            if(auxduty)
+              for(unsigned int i = 0; i < count; i++)
+                duty[i] = (aux[offset + i] - 0.5) * 2.0;
+            if(_wavetable)
+              Wavetable::Pulse(phase.data(), form + offset, sps, duty.data(), output + offset, count);
+            else
+              {
+                kernels::Pulse(phase.data(), duty.data(), output + offset, count);
+                kernels::PulseEdges(phase.data(), form + offset, sps, duty.data(), output + offset, count);
+              }
+          }
+      }
+      break;
+    case Type::NOISE:
+      assert(false);
+      break;
+    }
+}
+
+
 json11::Json NodeOscillator::to_json() const
 {
   auto rv = Node::to_json().object_items();
   rv["oscillator_type"] = TypeToName(_type);
   rv["oscillator_pulse_duty_cycle"] = _pulse_duty_cycle;
+  rv["oscillator_phase_accumulator"] = _phase_accumulator;
+  rv["oscillator_wavetable"] = _wavetable;
+  rv["oscillator_noise_seed"] = static_cast<double>(_noise_seed);
   return rv;
 }
 
@@ -137,4 +419,10 @@ void NodeOscillator::SetFromJson(const json11::Json & json)
   Node::SetFromJson(json);
   _type = NameToType(json["oscillator_type"].string_value());
   _pulse_duty_cycle = json["oscillator_pulse_duty_cycle"].number_value();
+  _phase_accumulator = json["oscillator_phase_accumulator"].bool_value();
+  _wavetable = json["oscillator_wavetable"].bool_value();
+  if(json["oscillator_noise_seed"].is_number())
+    SetNoiseSeed(static_cast<uint64_t>(json["oscillator_noise_seed"].number_value()));
+  else
+    SetNoiseSeed(NoiseSeedFromId(GetId()));
 }
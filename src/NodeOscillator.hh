@@ -13,7 +13,8 @@
 */
 
 #include "Node.hh"
-#include <random>
+#include <cstdint>
+#include <vector>
 
 
 namespace fmsynth
@@ -30,25 +31,52 @@ namespace fmsynth
     };
   
     NodeOscillator();
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
 
     [[nodiscard]] Type        GetType()                                 const;
     [[nodiscard]] std::string TypeToName(Type type)                     const;
     [[nodiscard]] Type        NameToType(const std::string & type_name) const;
     [[nodiscard]] double      GetPulseDutyCycle()                       const;
+    [[nodiscard]] bool        IsPhaseAccumulator()                      const;
+    [[nodiscard]] bool        IsWavetable()                             const;
+    [[nodiscard]] uint64_t    GetNoiseSeed()                            const;
     void                      SetType(Type type);
     void                      SetPulseDutyCycle(double pulse_duty_cycle);
+    void                      SetPhaseAccumulator(bool phase_accumulator);
+    void                      SetWavetable(bool wavetable); // Use the shared band-limited wavetables instead of computing the waves.
+    void                      SetNoiseSeed(uint64_t noise_seed);
+
+    static constexpr uint64_t MaxNoiseSeed = (uint64_t(1) << 53) - 1; // JSON numbers are doubles.
+    [[nodiscard]] static uint64_t NoiseSeedFromId(const std::string & id);
+
+    void                       ResetTime()                            override;
+    [[nodiscard]] long         GetHistoryLength() const               override;
 
     [[nodiscard]] json11::Json to_json() const                        override;
     void                       SetFromJson(const json11::Json & json) override;
   
   protected:
     [[nodiscard]] double ProcessInput(double time, double form) override;
+    void                 ProcessBlock(long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output) override;
+    void                 ProcessVoices(Node * const * nodes, unsigned int count, const long * time_indices, unsigned int frames,
+                                       const sample_t * const * amplitude, const sample_t * const * form, const sample_t * const * aux, sample_t * const * output) override;
 
   private:
     Type   _type;
     double _pulse_duty_cycle; // Percentage signal is high.
-    std::mt19937_64                        _random_generator;
-    std::uniform_real_distribution<double> _rdist;
+    bool   _phase_accumulator; // Integrate the form input into _phase instead of using form * time as the phase.
+    double _phase;             // Wrapped to range [-pi, pi].
+    bool     _wavetable;
+    uint64_t _noise_seed;
+
+    std::vector<unsigned int> _voices; // The voices gathered by ProcessVoices().
+    std::vector<double>       _voices_phase;
+
+    static void          AdvancePhase(double & phase, double increment);
+    // The wave of ProcessBlock() without the amplitude. The phase is calculated into the output, and the kernels replace it with the wave:
+    void                 ProcessWave(long time_index, unsigned int frames, const double * form, const double * aux, double * output);
+    void                 PhaseToWave(unsigned int frames, const double * form, const double * aux, double * output) const; // Replaces the phases in the output with the wave.
+    [[nodiscard]] double GetPulseDuty() const;
 
   };
 }
@@ -13,6 +13,9 @@
 #include "Test.hh"
 #include "ConstantValue.hh"
 #include "NodeOscillator.hh"
+#include <cmath>
+#include <numbers>
+#include <vector>
 
 static void Test()
 {
@@ -47,8 +50,194 @@ static void Test()
     testAssert("Oscillator node returns nearly the same value after 1 second with 1Hz sine wave.", std::abs(first - o.GetLastFrame()) < 0.0001);
     testAssert("Oscillator node returns different values for most timesteps.", changes > sps / 2);
   }
+
+  {
+    const unsigned int sps = 44100;
+    fmsynth::ConstantValue hz { 10, fmsynth::ConstantValue::Unit::Hertz };
+
+    fmsynth::NodeOscillator o;
+    o.SetSamplesPerSecond(sps);
+    o.SetType(fmsynth::NodeOscillator::Type::SAWTOOTH);
+    o.AddInputNode(fmsynth::Node::Channel::Form, nullptr);
+
+    // The earlier implementation summed 99 harmonics:
+    auto Additive = [](double phase)
+    {
+      double rv = 0;
+      for(double k = 1; k < 100; k++)
+        rv += std::pow(-1.0, k) * std::sin(k * phase) / k;
+      rv = 0.5 - 1.0 / std::numbers::pi * rv;
+      return rv / 1.05 * 2.0 - 1.0;
+    };
+
+    double maxdiff = 0;
+    double sumdiff2 = 0;
+    for(long ind = 0; ind < sps; ind++)
+      {
+        o.PushInput(nullptr, fmsynth::Node::Channel::Form, hz.GetValue());
+        o.FinishFrame(ind);
+
+        double phase = hz.GetValue() * static_cast<double>(ind) / sps;
+        double diff = std::abs(o.GetLastFrame() - Additive(phase));
+        sumdiff2 += diff * diff;
+        // The discontinuity is at the half cycle, away from it the additive sawtooth ripples less:
+        double cycles = phase / (2.0 * std::numbers::pi);
+        if(std::abs(cycles - std::floor(cycles) - 0.5) > 0.2)
+          maxdiff = std::max(maxdiff, diff);
+      }
+    double rms = std::sqrt(sumdiff2 / sps);
+    testComment << "maxdiff=" << maxdiff << ", rms=" << rms << "\n";
+    testAssert("Band-limited sawtooth matches the additive sawtooth at low frequencies.", maxdiff < 0.01 && rms < 0.05);
+  }
+
+  {
+    std::string testname = "Block rendering matches the per frame output of ";
+    const unsigned int sps = 48000;
+    const unsigned int frames = 1000;
+    std::vector<fmsynth::sample_t> amplitude(frames, 0.5);
+    std::vector<fmsynth::sample_t> form(frames);
+    std::vector<fmsynth::sample_t> aux(frames, 0);
+    for(unsigned int i = 0; i < frames; i++)
+      form[i] = fmsynth::ToSample(fmsynth::ConstantValue(440.0 + i, fmsynth::ConstantValue::Unit::Hertz).GetValue());
+
+    for(auto type : { fmsynth::NodeOscillator::Type::SINE, fmsynth::NodeOscillator::Type::PULSE, fmsynth::NodeOscillator::Type::TRIANGLE, fmsynth::NodeOscillator::Type::SAWTOOTH, fmsynth::NodeOscillator::Type::NOISE })
+      {
+        fmsynth::NodeOscillator tick;
+        fmsynth::NodeOscillator block;
+        for(auto o : { &tick, &block })
+          {
+            o->SetSamplesPerSecond(sps);
+            o->SetType(type);
+            o->SetPulseDutyCycle(0.3);
+            o->SetNoiseSeed(42);
+            o->AddInputNode(fmsynth::Node::Channel::Form, nullptr);
+            o->AddInputNode(fmsynth::Node::Channel::Amplitude, nullptr);
+          }
+
+        std::vector<fmsynth::sample_t> output(frames);
+        block.RenderBlock(0, frames, amplitude.data(), form.data(), aux.data(), output.data());
+
+        double maxdiff = 0;
+        for(unsigned int i = 0; i < frames; i++)
+          {
+            tick.PushInput(nullptr, fmsynth::Node::Channel::Form,      fmsynth::ToDouble(form[i]));
+            tick.PushInput(nullptr, fmsynth::Node::Channel::Amplitude, fmsynth::ToDouble(amplitude[i]));
+            tick.FinishFrame(i);
+            maxdiff = std::max(maxdiff, std::abs(tick.GetLastFrame() - fmsynth::ToDouble(output[i])));
+          }
+        testComment << tick.TypeToName(type) << ": maxdiff=" << maxdiff << "\n";
+        testAssert(testname + tick.TypeToName(type) + ".", maxdiff < 0.000001);
+      }
+  }
+
+  {
+    const unsigned int sps = 44100;
+    fmsynth::NodeOscillator early;
+    fmsynth::NodeOscillator late;
+    for(auto o : { &early, &late })
+      {
+        o->SetSamplesPerSecond(sps);
+        o->SetType(fmsynth::NodeOscillator::Type::SINE);
+        o->SetPhaseAccumulator(true);
+        o->AddInputNode(fmsynth::Node::Channel::Form, nullptr);
+      }
+
+    const long late_start = 1000L * 365 * 24 * 60 * 60 * sps;
+    bool same = true;
+    double maxdiff = 0;
+    long double phase = 0;
+    for(long i = 0; i < sps; i++)
+      {
+        // Sweep the frequency from 100Hz to 10000Hz:
+        double hz = fmsynth::ConstantValue(100.0 + 9900.0 * static_cast<double>(i) / sps, fmsynth::ConstantValue::Unit::Hertz).GetValue();
+        early.PushInput(nullptr, fmsynth::Node::Channel::Form, hz);
+        late.PushInput(nullptr, fmsynth::Node::Channel::Form, hz);
+        early.FinishFrame(i);
+        late.FinishFrame(late_start + i);
+
+        if(early.GetLastFrame() < late.GetLastFrame() || early.GetLastFrame() > late.GetLastFrame())
+          same = false;
+        maxdiff = std::max(maxdiff, std::abs(early.GetLastFrame() - static_cast<double>(std::sin(phase))));
+        phase += static_cast<long double>(hz) / sps;
+      }
+    testComment << "maxdiff=" << maxdiff << "\n";
+    testAssert("Phase accumulator output does not depend on the time index.", same);
+    testAssert("Phase accumulator integrates the frequency.", maxdiff < 0.000001);
+
+    fmsynth::NodeOscillator o;
+    o.SetFromJson(early.to_json());
+    testAssert("Phase accumulator setting is saved and loaded.", o.IsPhaseAccumulator());
+  }
+
+  {
+    const unsigned int sps = 44100;
+    fmsynth::NodeOscillator computed;
+    fmsynth::NodeOscillator table;
+    table.SetWavetable(true);
+    for(auto o : { &computed, &table })
+      {
+        o->SetSamplesPerSecond(sps);
+        o->SetType(fmsynth::NodeOscillator::Type::TRIANGLE);
+        o->AddInputNode(fmsynth::Node::Channel::Form, nullptr);
+      }
+    double maxdiff = 0;
+    for(long i = 0; i < sps; i++)
+      {
+        for(auto o : { &computed, &table })
+          {
+            o->PushInput(nullptr, fmsynth::Node::Channel::Form, fmsynth::ConstantValue(110, fmsynth::ConstantValue::Unit::Hertz).GetValue());
+            o->FinishFrame(i);
+          }
+        maxdiff = std::max(maxdiff, std::abs(computed.GetLastFrame() - table.GetLastFrame()));
+      }
+    testComment << "maxdiff=" << maxdiff << "\n";
+    testAssert("Wavetable oscillator matches the computed oscillator.", maxdiff < 0.01);
+
+    fmsynth::NodeOscillator o;
+    o.SetFromJson(table.to_json());
+    testAssert("Wavetable setting is saved and loaded.", o.IsWavetable());
+  }
+
+  {
+    fmsynth::NodeOscillator a;
+    fmsynth::NodeOscillator b;
+    for(auto o : { &a, &b })
+      {
+        o->SetSamplesPerSecond(44100);
+        o->SetType(fmsynth::NodeOscillator::Type::NOISE);
+        o->AddInputNode(fmsynth::Node::Channel::Form, nullptr);
+      }
+    unsigned int same = 0;
+    for(long i = 0; i < 1000; i++)
+      {
+        for(auto o : { &a, &b })
+          {
+            o->PushInput(nullptr, fmsynth::Node::Channel::Form, 1);
+            o->FinishFrame(i);
+          }
+        if(FloatEqual(a.GetLastFrame(), b.GetLastFrame(), 0.0))
+          same++;
+      }
+    testComment << "ids=" << a.GetId() << "," << b.GetId() << ", seeds=" << a.GetNoiseSeed() << "," << b.GetNoiseSeed() << ", same=" << same << "\n";
+    testAssert("Noise of different nodes is different.", a.GetNoiseSeed() != b.GetNoiseSeed() && same == 0);
+
+    fmsynth::NodeOscillator o;
+    a.SetNoiseSeed(fmsynth::NodeOscillator::MaxNoiseSeed);
+    o.SetFromJson(a.to_json());
+    testAssert("Noise seed is saved and loaded.", o.GetNoiseSeed() == fmsynth::NodeOscillator::MaxNoiseSeed);
+  }
 #else
   testSkip("Oscillator node returns nearly the same value after 1 second with 1Hz sine wave.", "NodeTesting is disabled.");
   testSkip("Oscillator node returns different values for most timesteps.", "NodeTesting is disabled.");
+  testSkip("Band-limited sawtooth matches the additive sawtooth at low frequencies.", "NodeTesting is disabled.");
+  testSkip("Phase accumulator output does not depend on the time index.", "NodeTesting is disabled.");
+  testSkip("Phase accumulator integrates the frequency.", "NodeTesting is disabled.");
+  testSkip("Phase accumulator setting is saved and loaded.", "NodeTesting is disabled.");
+  testSkip("Wavetable oscillator matches the computed oscillator.", "NodeTesting is disabled.");
+  testSkip("Wavetable setting is saved and loaded.", "NodeTesting is disabled.");
+  testSkip("Noise of different nodes is different.", "NodeTesting is disabled.");
+  testSkip("Noise seed is saved and loaded.", "NodeTesting is disabled.");
+  for(auto name : { "Sine", "Pulse", "Triangle", "Sawtooth", "Noise" })
+    testSkip(std::string("Block rendering matches the per frame output of ") + name + ".", "NodeTesting is disabled.");
 #endif
 }
@@ -24,6 +24,12 @@ NodeRangeConvert::NodeRangeConvert()
 }
 
 
+std::shared_ptr<Node> NodeRangeConvert::Clone() const
+{
+  return std::make_shared<NodeRangeConvert>(*this);
+}
+
+
 const Range & NodeRangeConvert::GetFrom() const
 {
   return _from;
@@ -39,12 +45,14 @@ const Range & NodeRangeConvert::GetTo() const
 void NodeRangeConvert::SetFrom(const Range & range)
 {
   _from = range;
+  InvalidateGraph();
 }
 
 
 void NodeRangeConvert::SetTo(const Range & range)
 {
   _to = range;
+  InvalidateGraph();
 }
 
 
@@ -54,6 +62,16 @@ double NodeRangeConvert::ProcessInput([[maybe_unused]] double time, double form)
 }
 
 
+void NodeRangeConvert::ProcessBlock([[maybe_unused]] long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, [[maybe_unused]] const sample_t * aux, sample_t * output)
+{
+  // The conversion is linear, output = form * scale + offset:
+  auto offset = ToSample(_from.ConvertTo(0, _to));
+  auto scale  = ToSample(_from.ConvertTo(1, _to) - _from.ConvertTo(0, _to));
+  for(unsigned int i = 0; i < frames; i++)
+    output[i] = amplitude[i] * (form[i] * scale + offset);
+}
+
+
 
 
 Range::Range(double min, double max)
@@ -80,6 +98,11 @@ double Range::GetMax() const
   return _max;
 }
 
+bool Range::operator==(const Range & other) const
+{
+  return !(_min < other._min) && !(_min > other._min) && !(_max < other._max) && !(_max > other._max);
+}
+
 void Range::Set(double min, double max)
 {
   _min = min;
@@ -89,15 +112,7 @@ void Range::Set(double min, double max)
 
 Input::Range NodeRangeConvert::GetFormOutputRange() const
 {
-  auto min = _to.GetMin();
-  auto max = _to.GetMax();
-
-  if(min >= 0 && max <= 1)
-    return Input::Range::Zero_One;
-  else if(min >= -1 && max <= 1)
-    return Input::Range::MinusOne_One;
-  else
-    return Input::Range::Inf_Inf;
+  return Input::GetValueRange(_to.GetMin(), _to.GetMax());
 }
 
 
@@ -118,4 +133,11 @@ void NodeRangeConvert::SetFromJson(const json11::Json & json)
 
   auto & cto = json["range_convert_custom_to"];
   _to.Set(cto[0].number_value(), cto[1].number_value());
+  InvalidateGraph();
+}
+
+
+bool NodeRangeConvert::IsStateless() const
+{
+  return true;
 }
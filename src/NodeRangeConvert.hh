@@ -27,6 +27,8 @@ namespace fmsynth
     [[nodiscard]] double GetMax() const;
 
     void                 Set(double min, double max);
+
+    [[nodiscard]] bool   operator==(const Range & other) const;
   
   private:
     double _min;
@@ -38,6 +40,9 @@ namespace fmsynth
   {
   public:
     NodeRangeConvert();
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
+
+    [[nodiscard]] bool IsStateless() const override;
 
     [[nodiscard]] const Range & GetFrom() const; // todo: Add the "Range" word to these method names: "GetRangeFrom()" etc.
     [[nodiscard]] const Range & GetTo()   const;
@@ -51,6 +56,7 @@ namespace fmsynth
   
   protected:
     [[nodiscard]] double ProcessInput(double time, double form)       override;
+    void                 ProcessBlock(long time_index, unsigned int frames, const sample_t * amplitude, const sample_t * form, const sample_t * aux, sample_t * output) override;
   
   private:
     Range _from;
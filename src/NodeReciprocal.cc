@@ -21,7 +21,19 @@ NodeReciprocal::NodeReciprocal()
 }
 
 
+std::shared_ptr<Node> NodeReciprocal::Clone() const
+{
+  return std::make_shared<NodeReciprocal>(*this);
+}
+
+
 double NodeReciprocal::ProcessInput([[maybe_unused]] double time, double form)
 {
   return 1.0 / form;
 }
+
+
+bool NodeReciprocal::IsStateless() const
+{
+  return true;
+}
@@ -21,6 +21,9 @@ namespace fmsynth
   {
   public:
     NodeReciprocal();
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
+
+    [[nodiscard]] bool IsStateless() const override;
   
   protected:
     [[nodiscard]] double ProcessInput(double time, double form) override;
@@ -23,6 +23,12 @@ NodeSmooth::NodeSmooth()
 }
 
 
+std::shared_ptr<Node> NodeSmooth::Clone() const
+{
+  return std::make_shared<NodeSmooth>(*this);
+}
+
+
 int NodeSmooth::GetWindowSize() const
 {
   return static_cast<int>(_window.size());
@@ -45,30 +51,111 @@ void NodeSmooth::ResetTime()
 }
 
 
-double NodeSmooth::ProcessInput([[maybe_unused]] double time, double form)
+long NodeSmooth::GetHistoryLength() const
+{
+  return static_cast<long>(_window.size());
+}
+
+
+void NodeSmooth::OnSkip()
+{
+  _position = 0;
+  _datasize = 0;
+  _lastsum  = 0;
+}
+
+
+// Appends the input to the window of size values, and returns the average of the window:
+static double Average(double * window, int size, int & position, int & datasize, double & sum, double form)
 {
   // Remove the oldest data from the sum:
-  if(_datasize == static_cast<int>(_window.size()))
+  if(datasize == size)
     {
-      int oldestpos = _position - _datasize;
+      int oldestpos = position - datasize;
       if(oldestpos < 0)
-        oldestpos += static_cast<int>(_window.size());
+        oldestpos += size;
       assert(oldestpos >= 0);
-      assert(oldestpos < static_cast<int>(_window.size()));
-      _lastsum -= _window[static_cast<unsigned int>(oldestpos)];
+      assert(oldestpos < size);
+      sum -= window[static_cast<unsigned int>(oldestpos)];
     }
   // Add the new data to sum:
-  _lastsum += form;
+  sum += form;
   
   // Append the data:
-  _window[static_cast<unsigned int>(_position)] = form;
-  _position++;
-  if(_position >= static_cast<int>(_window.size()))
-    _position = 0;
-  if(_datasize < static_cast<int>(_window.size()))
-    _datasize++;
+  window[static_cast<unsigned int>(position)] = form;
+  position++;
+  if(position >= size)
+    position = 0;
+  if(datasize < size)
+    datasize++;
   
-  return _lastsum / static_cast<double>(_datasize);
+  return sum / static_cast<double>(datasize);
+}
+
+
+double NodeSmooth::ProcessInput([[maybe_unused]] double time, double form)
+{
+  return Average(_window.data(), static_cast<int>(_window.size()), _position, _datasize, _lastsum, form);
+}
+
+
+void NodeSmooth::ProcessVoices(Node * const * nodes, unsigned int count, const long * time_indices, unsigned int frames,
+                               const sample_t * const * amplitude, const sample_t * const * form, const sample_t * const * aux, sample_t * const * output)
+{
+  // The windows of the voices with the window size of this node are gathered into one array,
+  // and each voice is averaged over the block in its part of the array:
+  _voices.clear();
+  for(unsigned int v = 0; v < count; v++)
+    {
+      auto node = static_cast<NodeSmooth *>(nodes[v]);
+      if(node->_window.size() == _window.size() && !_window.empty())
+        _voices.push_back(v);
+      else
+        node->ProcessBlock(time_indices[v], frames, amplitude[v], form[v], aux[v], output[v]);
+    }
+  if(_voices.size() < 2)
+    {
+      for(auto v : _voices)
+        static_cast<NodeSmooth *>(nodes[v])->ProcessBlock(time_indices[v], frames, amplitude[v], form[v], aux[v], output[v]);
+      return;
+    }
+
+  auto channels = static_cast<unsigned int>(_voices.size());
+  auto size     = static_cast<unsigned int>(_window.size());
+  _voices_window.resize(channels * size);
+  _voices_position.resize(channels);
+  _voices_datasize.resize(channels);
+  _voices_sum.resize(channels);
+  auto window = _voices_window.data();
+  for(unsigned int c = 0; c < channels; c++)
+    {
+      auto node = static_cast<NodeSmooth *>(nodes[_voices[c]]);
+      for(unsigned int i = 0; i < size; i++)
+        window[c * size + i] = node->_window[i];
+      _voices_position[c] = node->_position;
+      _voices_datasize[c] = node->_datasize;
+      _voices_sum[c]      = node->_lastsum;
+    }
+
+  for(unsigned int c = 0; c < channels; c++)
+    {
+      auto v = _voices[c];
+      for(unsigned int i = 0; i < frames; i++)
+        {
+          auto average = Average(window + c * size, static_cast<int>(size), _voices_position[c], _voices_datasize[c], _voices_sum[c], ToDouble(form[v][i]));
+          output[v][i] = ToSample(ToDouble(amplitude[v][i]) * average);
+        }
+    }
+
+  for(unsigned int c = 0; c < channels; c++)
+    {
+      auto node = static_cast<NodeSmooth *>(nodes[_voices[c]]);
+      for(unsigned int i = 0; i < size; i++)
+        node->_window[i] = window[c * size + i];
+      node->_position = _voices_position[c];
+      node->_datasize = _voices_datasize[c];
+      node->_lastsum  = _voices_sum[c];
+    }
 }
 
 
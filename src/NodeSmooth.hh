@@ -21,11 +21,13 @@ namespace fmsynth
   {
   public:
     NodeSmooth();
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
 
     [[nodiscard]] int          GetWindowSize()      const;
     void                       SetWindowSize(int size);
 
     void                       ResetTime()                            override;
+    [[nodiscard]] long         GetHistoryLength() const               override;
     [[nodiscard]] Input::Range GetFormOutputRange() const             override;
 
     [[nodiscard]] json11::Json to_json() const                        override;
@@ -33,12 +35,21 @@ namespace fmsynth
 
   protected:
     [[nodiscard]] double ProcessInput(double time, double form) override;
+    void                 ProcessVoices(Node * const * nodes, unsigned int count, const long * time_indices, unsigned int frames,
+                                       const sample_t * const * amplitude, const sample_t * const * form, const sample_t * const * aux, sample_t * const * output) override;
+    void                 OnSkip() override;
 
   private:
     std::vector<double> _window;
     int                 _position;
     int                 _datasize;
     double              _lastsum;
+
+    std::vector<unsigned int> _voices;          // The voices gathered by ProcessVoices().
+    std::vector<double>       _voices_window;   // The windows of the voices, one after another.
+    std::vector<int>          _voices_position;
+    std::vector<int>          _voices_datasize;
+    std::vector<double>       _voices_sum;
   };
 }
 
@@ -16,11 +16,18 @@ using namespace fmsynth;
 
 NodeTimeScale::NodeTimeScale()
   : Node("TimeScale"),
-    _scale(1)
+    _scale(1),
+    _front(0)
 {
 }
 
 
+std::shared_ptr<Node> NodeTimeScale::Clone() const
+{
+  return std::make_shared<NodeTimeScale>(*this);
+}
+
+
 double NodeTimeScale::GetScale() const
 {
   return _scale;
@@ -36,8 +43,57 @@ void NodeTimeScale::SetScale(double scale)
 void NodeTimeScale::ResetTime()
 {
   Node::ResetTime();
+  Clear();
+}
+
+
+void NodeTimeScale::OnSkip()
+{
+  Clear();
+}
+
+
+void NodeTimeScale::Clear()
+{
   _samplebuffer.clear();
   _timebuffer.clear();
+  _front = 0;
+}
+
+
+void NodeTimeScale::Compact()
+{
+  if(_front < 4096 || _front < _samplebuffer.size() / 2)
+    return;
+  _samplebuffer.erase(_samplebuffer.begin(), _samplebuffer.begin() + static_cast<std::ptrdiff_t>(_front));
+  _timebuffer.erase(_timebuffer.begin(), _timebuffer.begin() + static_cast<std::ptrdiff_t>(_front));
+  _front = 0;
+}
+
+
+// Extends the input to longer output. The buffers hold the input up to the sample of the current frame at last,
+// the samples before front are no longer used:
+static double Extend(const double * samples, const double * times, size_t & front, size_t last, double time, double scale, double time_per_sample)
+{
+  double current_time = time * scale;
+  if(front < last)
+    if(current_time <= times[front])
+      { // Time has moved backwards, reset:
+        front = last;
+      }
+
+  if(time <= 0.0)
+    return samples[front];
+
+  double alpha = (current_time - times[front]) / time_per_sample;
+  if(alpha > 1.0)
+    {
+      alpha -= 1.0;
+      front++;
+    }
+  if(front == last)
+    return samples[front];
+  return (1.0-alpha)*samples[front] + alpha*samples[front + 1];
 }
 
 
@@ -49,30 +105,12 @@ double NodeTimeScale::ProcessInput([[maybe_unused]] double time, double form)
       return form;
     }
   else if(_scale < 1.0)
-    { // Extend the input to longer output.
-      double current_time = time * _scale;
-      if(not _timebuffer.empty())
-        if(current_time <= _timebuffer[0])
-          { // Time has moved backwards, reset:
-            _samplebuffer.clear();
-            _timebuffer.clear();
-          }
-
+    {
       _samplebuffer.push_back(form);
       _timebuffer.push_back(time);
-
-      if(time <= 0.0)
-        return _samplebuffer[0];
-      
-      double time_per_sample = 1.0 / GetSamplesPerSecond();
-      double alpha = (current_time - _timebuffer[0]) / time_per_sample;
-      if(alpha > 1.0)
-        {
-          alpha -= 1.0;
-          _samplebuffer.pop_front();
-          _timebuffer.pop_front();
-        }
-      return (1.0-alpha)*_samplebuffer[0] + alpha*_samplebuffer[1];
+      double value = Extend(_samplebuffer.data(), _timebuffer.data(), _front, _samplebuffer.size() - 1, time, _scale, 1.0 / GetSamplesPerSecond());
+      Compact();
+      return value;
     }
   else
     { // No-op.
@@ -81,6 +119,63 @@ double NodeTimeScale::ProcessInput([[maybe_unused]] double time, double form)
 }
 
 
+void NodeTimeScale::ProcessVoices(Node * const * nodes, unsigned int count, const long * time_indices, unsigned int frames,
+                                  const sample_t * const * amplitude, const sample_t * const * form, const sample_t * const * aux, sample_t * const * output)
+{
+  // The read positions of the voices extending their input are gathered into an array. The input of the block is
+  // appended to the buffers of a voice at once, and the voice is then advanced over the block with its read position:
+  _voices.clear();
+  for(unsigned int v = 0; v < count; v++)
+    {
+      auto node = static_cast<NodeTimeScale *>(nodes[v]);
+      if(node->_scale < 1.0)
+        _voices.push_back(v);
+      else
+        node->ProcessBlock(time_indices[v], frames, amplitude[v], form[v], aux[v], output[v]);
+    }
+  if(_voices.size() < 2)
+    {
+      for(auto v : _voices)
+        static_cast<NodeTimeScale *>(nodes[v])->ProcessBlock(time_indices[v], frames, amplitude[v], form[v], aux[v], output[v]);
+      return;
+    }
+
+  auto channels = static_cast<unsigned int>(_voices.size());
+  _voices_front.resize(channels);
+  for(unsigned int c = 0; c < channels; c++)
+    _voices_front[c] = static_cast<NodeTimeScale *>(nodes[_voices[c]])->_front;
+
+  for(unsigned int c = 0; c < channels; c++)
+    {
+      auto v     = _voices[c];
+      auto node  = static_cast<NodeTimeScale *>(nodes[v]);
+      auto sps   = static_cast<double>(node->GetSamplesPerSecond());
+      auto first = node->_samplebuffer.size();
+      node->_samplebuffer.resize(first + frames);
+      node->_timebuffer.resize(first + frames);
+      auto samples = node->_samplebuffer.data();
+      auto times   = node->_timebuffer.data();
+      for(unsigned int i = 0; i < frames; i++)
+        {
+          samples[first + i] = ToDouble(form[v][i]);
+          times[first + i]   = static_cast<double>(time_indices[v] + i) / sps;
+        }
+      for(unsigned int i = 0; i < frames; i++)
+        {
+          auto value = Extend(samples, times, _voices_front[c], first + i, times[first + i], node->_scale, 1.0 / sps);
+          output[v][i] = ToSample(ToDouble(amplitude[v][i]) * value);
+        }
+    }
+
+  for(unsigned int c = 0; c < channels; c++)
+    {
+      auto node = static_cast<NodeTimeScale *>(nodes[_voices[c]]);
+      node->_front = _voices_front[c];
+      node->Compact();
+    }
+}
+
+
 Input::Range NodeTimeScale::GetFormOutputRange() const
 {
   return GetInput(Channel::Form)->GetInputRange();
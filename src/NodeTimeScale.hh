@@ -13,7 +13,7 @@
 */
 
 #include "Node.hh"
-#include <deque>
+#include <vector>
 
 
 namespace fmsynth
@@ -22,6 +22,7 @@ namespace fmsynth
   {
   public:
     NodeTimeScale();
+    [[nodiscard]] std::shared_ptr<Node> Clone() const override;
 
     [[nodiscard]] double       GetScale()           const;
     void                       SetScale(double scale);
@@ -34,11 +35,21 @@ namespace fmsynth
 
   protected:
     [[nodiscard]] double ProcessInput(double time, double form) override;
+    void                 ProcessVoices(Node * const * nodes, unsigned int count, const long * time_indices, unsigned int frames,
+                                       const sample_t * const * amplitude, const sample_t * const * form, const sample_t * const * aux, sample_t * const * output) override;
+    void                 OnSkip() override;
 
   private:
-    double             _scale;
-    std::deque<double> _samplebuffer;
-    std::deque<double> _timebuffer;
+    double              _scale;
+    std::vector<double> _samplebuffer;
+    std::vector<double> _timebuffer;
+    size_t              _front; // The index of the oldest sample still in use in the buffers.
+
+    std::vector<unsigned int> _voices; // The voices gathered by ProcessVoices().
+    std::vector<size_t>       _voices_front;
+
+    void Clear();
+    void Compact(); // Removes the samples before the front from the buffers.
   };
 }
 
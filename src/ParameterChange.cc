@@ -0,0 +1,36 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "ParameterChange.hh"
+
+using namespace fmsynth;
+
+
+ParameterChange::ParameterChange()
+  : _node(nullptr),
+    _apply(nullptr),
+    _storage()
+{
+}
+
+
+Node * ParameterChange::GetNode() const
+{
+  return _node;
+}
+
+
+void ParameterChange::Apply() const
+{
+  if(_apply)
+    _apply(_node, _storage);
+}
@@ -0,0 +1,61 @@
+#ifndef PARAMETER_CHANGE_HH_
+#define PARAMETER_CHANGE_HH_
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "Node.hh"
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace fmsynth
+{
+  // A call to one of the setters of a node, passed from the editor to the audio thread with Blueprint::PostParameterChange().
+  //
+  // The values given to the setter are copied into the change itself, so making, copying and applying
+  // changes does not allocate memory. For example:
+  //   auto change = ParameterChange::Make<&NodeFilter::SetFilterValue>(filter, 440.0);
+  class ParameterChange
+  {
+  public:
+    static constexpr size_t MaxValuesSize = 64; // Bytes.
+
+    ParameterChange(); // Does nothing when applied.
+
+    template<auto Setter, typename NodeType, typename ... Values> [[nodiscard]] static ParameterChange Make(NodeType * node, Values ... values)
+    {
+      static_assert(std::is_base_of_v<Node, NodeType>);
+      auto call = [values ...](Node * target) { (static_cast<NodeType *>(target)->*Setter)(values ...); };
+      using Call = decltype(call);
+      static_assert(std::is_trivially_copyable_v<Call> && sizeof(Call) <= MaxValuesSize,
+                    "The values of a parameter change must be small and trivially copyable.");
+      static_assert(alignof(Call) <= alignof(std::max_align_t));
+
+      ParameterChange change;
+      change._node  = node;
+      // The storage is aligned for any Call, it is read back through a void pointer instead of an aligning cast:
+      change._apply = [](Node * target, const void * stored) { (*std::launder(static_cast<const Call *>(stored)))(target); };
+      new (change._storage) Call(call);
+      return change;
+    }
+
+    [[nodiscard]] Node * GetNode() const;
+    void                 Apply() const;
+
+  private:
+    Node * _node;
+    void (*_apply)(Node * node, const void * storage);
+    alignas(std::max_align_t) std::byte _storage[MaxValuesSize];
+  };
+}
+
+#endif
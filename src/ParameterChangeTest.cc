@@ -0,0 +1,104 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "Blueprint.hh"
+#include "NodeADHSR.hh"
+#include "NodeAudioDeviceOutput.hh"
+#include "NodeConstant.hh"
+#include "ParameterChange.hh"
+#include "Test.hh"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+static void Test()
+{
+  {
+    fmsynth::ParameterChange change;
+    change.Apply();
+    testAssert("Default change does nothing.", change.GetNode() == nullptr);
+  }
+
+  {
+    fmsynth::NodeADHSR node;
+    auto change = fmsynth::ParameterChange::Make<&fmsynth::NodeADHSR::Set>(&node, 0.1, 0.2, 0.3, 0.4, 0.5, fmsynth::NodeADHSR::EndAction::NOP);
+    auto copy = change;
+    testAssert("Change is not applied when made.", change.GetNode() == &node && node.GetAttackTime() < 0.09);
+    copy.Apply();
+    testAssert("Copy of a change calls the setter with the values.",
+               node.GetAttackTime()   > 0.09 && node.GetAttackTime()   < 0.11 &&
+               node.GetSustainLevel() > 0.39 && node.GetSustainLevel() < 0.41 &&
+               node.GetReleaseTime()  > 0.49 && node.GetReleaseTime()  < 0.51 &&
+               node.GetEndAction() == fmsynth::NodeADHSR::EndAction::NOP);
+  }
+
+  {
+    fmsynth::Blueprint bp;
+    auto constant = std::make_shared<fmsynth::NodeConstant>();
+    auto output = std::make_shared<fmsynth::NodeAudioDeviceOutput>();
+    bp.AddNode(constant);
+    bp.AddNode(output);
+    bp.ConnectNodes(fmsynth::Node::Channel::Form, constant.get(), fmsynth::Node::Channel::Form, output.get());
+    bp.SetBlockSize(16);
+
+    // The values are kept in the range of the output, from -1 to 0, so that they are not normalized:
+    auto Make = [&constant](double value)
+    {
+      return fmsynth::ParameterChange::Make<&fmsynth::NodeConstant::SetValue>(constant.get(), fmsynth::ConstantValue(value, fmsynth::ConstantValue::Unit::Absolute));
+    };
+
+    bool ok = bp.PostParameterChange(Make(-0.25)) && bp.PostParameterChange(Make(-0.5));
+    testAssert("Changes are queued.", ok && bp.HasParameterChanges() && constant->GetValue().GetValue() > 0.5);
+    std::vector<double> samples(16);
+    auto count = bp.Render(samples.data(), samples.size());
+    testAssert("Queued changes are applied in order before rendering.", count == 16 && !bp.HasParameterChanges() && samples[0] < -0.49 && samples[15] > -0.51);
+
+    for(unsigned int i = 0; i < 2000; i++)
+      ok = ok && bp.PostParameterChange(Make(-1));
+    testAssert("Changes which do not fit in the queue are not posted.", !ok);
+    bp.ApplyParameterChanges();
+
+    // One thread changes the value while another renders:
+    const unsigned int changes = 10000;
+    std::atomic<bool> done(false);
+    std::thread editor([&]()
+    {
+      for(unsigned int i = 1; i <= changes;)
+        if(bp.PostParameterChange(Make(-1.0 + static_cast<double>(i) / (changes + 1))))
+          i++;
+        else
+          std::this_thread::yield();
+      done = true;
+    });
+
+    samples.resize(100 * 16);
+    bool blockwise = true;
+    bool increasing = true;
+    double previous = -1;
+    while(!done || bp.HasParameterChanges())
+      {
+        count = bp.Render(samples.data(), samples.size());
+        for(unsigned int i = 0; i < count; i++)
+          {
+            if(i % 16 > 0)
+              blockwise = blockwise && !(samples[i] < samples[i - 1] || samples[i] > samples[i - 1]);
+            increasing = increasing && samples[i] >= previous;
+            previous = samples[i];
+          }
+      }
+    editor.join();
+    count = bp.Render(samples.data(), 16);
+    testAssert("Changes are applied at the block boundaries.", blockwise);
+    testAssert("Changes from another thread are applied in order.", increasing && samples[0] > -0.001 && samples[0] < 0);
+  }
+}
@@ -25,9 +25,9 @@ Player * ProgramPlayer = nullptr;
 Player::Player()
   : _thread(nullptr),
     _is_playing(false),
-    _device(-1),
-    _next_program(std::nullopt)
+    _device(-1)
 {
+  _device.SetCrossfadeFrames(256);
 }
 
 
@@ -37,7 +37,7 @@ void Player::Start()
   {
     while(!st.stop_requested())
       {
-        TickProgramChange();
+        _device.CollectGarbage();
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
       }
   });
@@ -79,32 +79,7 @@ void Player::SetAudioDevice(int device_id)
 void Player::SetNextProgram(std::shared_ptr<fmsynth::Blueprint> program)
 {
   _is_playing = program ? true : false;
-  {
-    std::lock_guard lock(_next_program_mutex);
-    _next_program = std::make_optional(program);
-  }
-}
-
-
-
-void Player::TickProgramChange()
-{
-  std::shared_ptr<fmsynth::Blueprint> newprog;
-  bool change = false;
-  {
-    std::lock_guard lock(_next_program_mutex);
-    if(_next_program.has_value())
-      {
-        change = true;
-        newprog = _next_program.value();
-        _next_program = std::nullopt;
-      }
-  }
-  if(change)
-    {
-      _device.Stop();
-      _device.Play(newprog);
-    }      
+  _device.Play(program);
 }
 
 
@@ -14,8 +14,6 @@
 
 #include "AudioDevice.hh"
 #include <memory>
-#include <mutex>
-#include <optional>
 #include <string>
 #include <thread>
 #include <vector>
@@ -38,22 +36,12 @@ public:
   void                              SetAudioDevice(int device_id);
   [[nodiscard]] const AudioDevice * GetAudioDevice() const;
   [[nodiscard]] bool                IsPlaying() const;
-  void                              SetNextProgram(std::shared_ptr<fmsynth::Blueprint> program);
+  void                              SetNextProgram(std::shared_ptr<fmsynth::Blueprint> program); // Played from the next audio buffer on.
 
 private:
-  // Caller thread data:
-  std::jthread * _thread;
+  std::jthread * _thread; // Frees the programs the audio thread is done with.
   bool           _is_playing;
-
-  // Player thread data:
-  std::shared_ptr<fmsynth::Blueprint> _now_playing;
-  AudioDevice                         _device;
-
-  // Communication between threads:
-  std::optional<std::shared_ptr<fmsynth::Blueprint>> _next_program;
-  std::mutex                                         _next_program_mutex;
-
-  void   TickProgramChange();
+  AudioDevice    _device;
 };
 
 extern Player * ProgramPlayer;
@@ -0,0 +1,102 @@
+#ifndef RING_BUFFER_HH_
+#define RING_BUFFER_HH_
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <vector>
+
+namespace fmsynth
+{
+  // Lock-free queue of a fixed capacity, for passing items from one producer thread to one consumer thread.
+  //
+  // Push() is called only by the producer, GetFront(), PopFront() and Pop() only by the consumer. Neither
+  // of them waits for the other or allocates memory, so the queue can be used from the audio thread.
+  // The read and write positions count the items from the start, they are masked when the items are accessed.
+  template<typename T> class RingBuffer
+  {
+  public:
+    explicit RingBuffer(size_t capacity) // Rounded up to a power of two.
+      : _items(std::bit_ceil(std::max(capacity, static_cast<size_t>(1)))),
+        _mask(_items.size() - 1),
+        _write(0),
+        _read(0)
+    {
+    }
+
+    [[nodiscard]] size_t GetCapacity() const
+    {
+      return _items.size();
+    }
+
+    // The number of items in the queue, it may be out of date when called from the other thread:
+    [[nodiscard]] size_t GetSize() const
+    {
+      return _write.load(std::memory_order_acquire) - _read.load(std::memory_order_acquire);
+    }
+
+    // Adds either all of the items or none of them if there is not enough room:
+    [[nodiscard]] bool Push(const T * items, size_t count)
+    {
+      auto write = _write.load(std::memory_order_relaxed);
+      if(count > GetCapacity() - (write - _read.load(std::memory_order_acquire)))
+        return false;
+
+      for(size_t i = 0; i < count; i++)
+        _items[(write + i) & _mask] = items[i];
+      _write.store(write + count, std::memory_order_release);
+      return true;
+    }
+
+    [[nodiscard]] bool Push(const T & item)
+    {
+      return Push(&item, 1);
+    }
+
+    // Removes at most count items, returns the number of items removed:
+    size_t Pop(T * items, size_t count)
+    {
+      auto read = _read.load(std::memory_order_relaxed);
+      count = std::min(count, _write.load(std::memory_order_acquire) - read);
+      for(size_t i = 0; i < count; i++)
+        items[i] = _items[(read + i) & _mask];
+      _read.store(read + count, std::memory_order_release);
+      return count;
+    }
+
+    // The oldest item, nullptr if the queue is empty. The item stays valid until PopFront():
+    [[nodiscard]] T * GetFront()
+    {
+      auto read = _read.load(std::memory_order_relaxed);
+      if(read == _write.load(std::memory_order_acquire))
+        return nullptr;
+      return &_items[read & _mask];
+    }
+
+    void PopFront()
+    {
+      assert(GetFront());
+      _read.store(_read.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+  private:
+    std::vector<T>                  _items;
+    size_t                          _mask;
+    alignas(64) std::atomic<size_t> _write; // The producer and the consumer update the positions on separate cache lines.
+    alignas(64) std::atomic<size_t> _read;
+  };
+}
+
+#endif
@@ -0,0 +1,85 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "RingBuffer.hh"
+#include "Test.hh"
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+
+static void Test()
+{
+  {
+    fmsynth::RingBuffer<int> ring(5);
+    testAssert("Capacity is rounded up to a power of two.", ring.GetCapacity() == 8);
+
+    std::vector<int> items(8);
+    std::iota(items.begin(), items.end(), 0);
+    bool ok = ring.Push(items.data(), 6);
+    testAssert("Items are pushed.", ok && ring.GetSize() == 6);
+    testAssert("Items which do not fit are not pushed.", !ring.Push(items.data(), 3) && ring.GetSize() == 6);
+
+    std::vector<int> popped(8);
+    auto count = ring.Pop(popped.data(), 4);
+    testAssert("Items are popped in order.", count == 4 && popped[0] == 0 && popped[3] == 3 && ring.GetSize() == 2);
+
+    // The write position wraps around the end:
+    ok = ring.Push(items.data(), 6);
+    count = ring.Pop(popped.data(), 8);
+    testAssert("Items wrap around.", ok && count == 8 && popped == std::vector<int>({ 4, 5, 0, 1, 2, 3, 4, 5 }));
+    testAssert("Popping an empty ring buffer returns nothing.", ring.Pop(popped.data(), 8) == 0 && ring.GetFront() == nullptr);
+
+    ok = ring.Push(7) && ring.Push(8);
+    auto front = ring.GetFront();
+    testAssert("The front item is the oldest.", ok && front && *front == 7);
+    ring.PopFront();
+    front = ring.GetFront();
+    testAssert("PopFront() removes the front item.", front && *front == 8 && ring.GetSize() == 1);
+  }
+
+  {
+    // One thread pushes blocks of different sizes while another pops them:
+    const unsigned int total = 1000000;
+    fmsynth::RingBuffer<unsigned int> ring(256);
+    std::thread producer([&ring]()
+    {
+      std::vector<unsigned int> block(100);
+      unsigned int next = 0;
+      unsigned int size = 1;
+      while(next < total)
+        {
+          size = std::min(size % 100 + 1, total - next);
+          std::iota(block.begin(), block.begin() + size, next);
+          if(ring.Push(block.data(), size))
+            next += size;
+          else
+            std::this_thread::yield();
+        }
+    });
+
+    std::vector<unsigned int> block(64);
+    unsigned int next = 0;
+    bool ordered = true;
+    while(next < total)
+      {
+        auto count = ring.Pop(block.data(), block.size());
+        for(size_t i = 0; i < count; i++)
+          ordered = ordered && block[i] == next++;
+        if(count == 0)
+          std::this_thread::yield();
+      }
+    producer.join();
+    testAssert("Items pushed by one thread are popped by another in order.", ordered && next == total && ring.GetSize() == 0);
+  }
+}
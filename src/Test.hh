@@ -12,6 +12,7 @@
   Complete license can be found in the LICENSE file.
 */
 
+#include "Sample.hh"
 #include <iostream>
 #include <cassert>
 
@@ -60,4 +61,11 @@ int main()
 
 #define FloatEqual(a, b, tolerance) (std::abs((a) - (b)) <= tolerance)
 
+// The tolerance of comparing the output rendered in blocks to the output ticked one frame at a time in double:
+#if LIBFMSYNTH_FLOAT_SAMPLES
+static const double SampleTolerance = 0.001;
+#else
+static const double SampleTolerance = 0.000000001;
+#endif
+
 #endif
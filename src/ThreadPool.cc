@@ -0,0 +1,110 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <cassert>
+
+using namespace fmsynth;
+
+
+ThreadPool::ThreadPool(unsigned int threads)
+  : _task(nullptr),
+    _task_count(0),
+    _next_task(0),
+    _working(0),
+    _job(0),
+    _quit(false)
+{
+  if(threads == 0)
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+  for(unsigned int i = 1; i < threads; i++)
+    _threads.emplace_back(&ThreadPool::Work, this);
+}
+
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard lock(_mutex);
+    _quit = true;
+  }
+  _job_started.notify_all();
+  for(auto & thread : _threads)
+    thread.join();
+}
+
+
+unsigned int ThreadPool::GetThreadCount() const
+{
+  return static_cast<unsigned int>(_threads.size() + 1);
+}
+
+
+void ThreadPool::Run(unsigned int count, const std::function<void(unsigned int)> & task)
+{
+  if(count == 0)
+    return;
+  if(_threads.empty() || count == 1)
+    {
+      for(unsigned int i = 0; i < count; i++)
+        task(i);
+      return;
+    }
+
+  {
+    std::lock_guard lock(_mutex);
+    assert(_working == 0);
+    _task       = &task;
+    _task_count = count;
+    _next_task  = 0;
+    _working    = static_cast<unsigned int>(_threads.size());
+    _job++;
+  }
+  _job_started.notify_all();
+
+  RunTasks(task, count);
+
+  std::unique_lock lock(_mutex);
+  _job_finished.wait(lock, [this]() { return _working == 0; });
+  _task = nullptr;
+}
+
+
+void ThreadPool::Work()
+{
+  unsigned long job = 0;
+  std::unique_lock lock(_mutex);
+  while(true)
+    {
+      _job_started.wait(lock, [this, job]() { return _quit || _job != job; });
+      if(_quit)
+        break;
+      job = _job;
+      auto task = _task;
+      auto count = _task_count;
+
+      lock.unlock();
+      RunTasks(*task, count);
+      lock.lock();
+
+      if(--_working == 0)
+        _job_finished.notify_one();
+    }
+}
+
+
+void ThreadPool::RunTasks(const std::function<void(unsigned int)> & task, unsigned int count)
+{
+  for(auto i = _next_task++; i < count; i = _next_task++)
+    task(i);
+}
@@ -0,0 +1,64 @@
+#ifndef THREAD_POOL_HH_
+#define THREAD_POOL_HH_
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fmsynth
+{
+  // Persistent worker threads running the independent tasks of a job together with the calling thread.
+  //
+  // The tasks of a job are numbered, and each thread takes the next task number from a shared counter
+  // when it has finished its previous task, so the threads which get the short tasks run more of them.
+  // The workers wait for the next job between the jobs, so the pool can be kept for the whole playback.
+  // One job is run at a time, from one thread at a time.
+  class ThreadPool
+  {
+  public:
+    explicit ThreadPool(unsigned int threads); // The number of threads including the calling thread, 0 uses all the cores.
+    ThreadPool(const ThreadPool & src)             = delete;
+    ThreadPool(ThreadPool && src)                  = delete;
+    ~ThreadPool();
+
+    ThreadPool & operator=(const ThreadPool & rhs) = delete;
+    ThreadPool & operator=(ThreadPool && rhs)      = delete;
+
+    [[nodiscard]] unsigned int GetThreadCount() const;
+    // Calls task(i) for each i from 0 to count - 1, and returns when all the calls have returned:
+    void                       Run(unsigned int count, const std::function<void(unsigned int)> & task);
+
+  private:
+    std::vector<std::thread> _threads;
+
+    // Communication between threads:
+    std::mutex                                _mutex;
+    std::condition_variable                   _job_started;
+    std::condition_variable                   _job_finished;
+    const std::function<void(unsigned int)> * _task;
+    unsigned int                              _task_count;
+    std::atomic<unsigned int>                 _next_task;
+    unsigned int                              _working; // The workers which have not finished the current job.
+    unsigned long                             _job;     // Incremented for each job.
+    bool                                      _quit;
+
+    void Work();
+    void RunTasks(const std::function<void(unsigned int)> & task, unsigned int count);
+  };
+}
+
+#endif
@@ -0,0 +1,63 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "Test.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+
+static void Test()
+{
+  {
+    fmsynth::ThreadPool pool(1);
+    std::vector<unsigned int> order;
+    pool.Run(5, [&order](unsigned int i) { order.push_back(i); });
+    testAssert("Pool of one thread runs the tasks in order in the calling thread.", pool.GetThreadCount() == 1 && order == std::vector<unsigned int>({ 0, 1, 2, 3, 4 }));
+  }
+
+  {
+    fmsynth::ThreadPool pool(4);
+    testAssert("Pool has the requested number of threads.", pool.GetThreadCount() == 4);
+
+    std::vector<unsigned int> counts(1000, 0);
+    bool once = true;
+    for(unsigned int job = 0; job < 100; job++)
+      {
+        pool.Run(static_cast<unsigned int>(counts.size()), [&counts](unsigned int i) { counts[i]++; });
+        once = once && std::all_of(counts.cbegin(), counts.cend(), [job](unsigned int c) { return c == job + 1; });
+      }
+    testAssert("Each task of each job is run once, and the job has finished when Run() returns.", once);
+
+    // The tasks wait for each other, so they can only finish if they are run in different threads:
+    std::atomic<unsigned int> started(0);
+    std::set<std::thread::id> threads;
+    std::mutex mutex;
+    pool.Run(4, [&](unsigned int)
+    {
+      started++;
+      while(started < 4)
+        std::this_thread::yield();
+      std::lock_guard lock(mutex);
+      threads.insert(std::this_thread::get_id());
+    });
+    testAssert("Tasks are run in all the threads.", threads.size() == 4 && threads.contains(std::this_thread::get_id()));
+  }
+
+  {
+    fmsynth::ThreadPool pool(0);
+    testAssert("Pool of 0 threads uses all the cores.", pool.GetThreadCount() == std::max(std::thread::hardware_concurrency(), 1u));
+  }
+}
@@ -0,0 +1,292 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "VoiceEngine.hh"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace fmsynth;
+
+
+VoiceEngine::VoiceEngine(unsigned int voice_count)
+  : _ids(voice_count, NoVoice),
+    _states(voice_count, State::Free),
+    _volumes(voice_count, 0),
+    _gains(voice_count, 0),
+    _next_volumes(voice_count, 0),
+    _released_early(voice_count, false),
+    _triggered(voice_count, 0),
+    _buffers(static_cast<size_t>(voice_count) * Blueprint::MaxBlockSize),
+    _next_id(NoVoice + 1),
+    _trigger_count(0),
+    _stolen_count(0),
+    _release_time(0.05),
+    _samples_per_second(44100)
+{
+  assert(voice_count > 0);
+  _active.reserve(voice_count);
+  _active_blueprints.reserve(voice_count);
+  _active_outputs.reserve(voice_count);
+  _active_rendered.reserve(voice_count);
+}
+
+
+bool VoiceEngine::Load(const json11::Json & json, unsigned int samples_per_second)
+{
+  _samples_per_second = samples_per_second;
+  _blueprints.clear();
+  std::fill(_states.begin(), _states.end(), State::Free);
+  std::fill(_ids.begin(), _ids.end(), NoVoice);
+
+  // The first voice is loaded from the file, the others are copies of it:
+  for(unsigned int i = 0; i < GetVoiceCount(); i++)
+    {
+      auto blueprint = std::make_unique<Blueprint>();
+      if(!(i == 0 ? blueprint->Load(json) : blueprint->LoadCopy(*_blueprints[0])))
+        {
+          _blueprints.clear();
+          return false;
+        }
+      blueprint->SetSamplesPerSecond(samples_per_second);
+      _blueprints.push_back(std::move(blueprint));
+    }
+
+  if(!ShareProgram())
+    {
+      _blueprints.clear();
+      return false;
+    }
+  return true;
+}
+
+
+bool VoiceEngine::ShareProgram()
+{
+  auto program = _blueprints[0]->GetProgram();
+  if(!program)
+    return false;
+  for(size_t i = 1; i < _blueprints.size(); i++)
+    if(!_blueprints[i]->UseProgram(program))
+      return false;
+  return true;
+}
+
+
+void VoiceEngine::SetBlockSize(unsigned int frames)
+{
+  for(auto & blueprint : _blueprints)
+    blueprint->SetBlockSize(frames);
+}
+
+
+void VoiceEngine::SetControlPeriod(unsigned int frames)
+{
+  for(auto & blueprint : _blueprints)
+    blueprint->SetControlPeriod(frames);
+  if(!_blueprints.empty())
+    {
+      [[maybe_unused]] auto ok = ShareProgram();
+      assert(ok);
+    }
+}
+
+
+void VoiceEngine::SetReleaseTime(double seconds)
+{
+  assert(seconds >= 0);
+  _release_time = seconds;
+}
+
+
+VoiceEngine::VoiceId VoiceEngine::Trigger(double volume)
+{
+  if(_blueprints.empty())
+    return NoVoice;
+
+  // A free voice, or the one which is the furthest in its release, or the oldest one:
+  int free      = -1;
+  int releasing = -1;
+  int oldest    = -1;
+  for(unsigned int i = 0; i < GetVoiceCount(); i++)
+    if(_states[i] == State::Free)
+      {
+        free = static_cast<int>(i);
+        break;
+      }
+    else if(_states[i] == State::Releasing)
+      {
+        if(releasing < 0 || _gains[i] < _gains[static_cast<unsigned int>(releasing)])
+          releasing = static_cast<int>(i);
+      }
+    else if(oldest < 0 || _triggered[i] < _triggered[static_cast<unsigned int>(oldest)])
+      oldest = static_cast<int>(i);
+  auto v = static_cast<unsigned int>(free >= 0 ? free : (releasing >= 0 ? releasing : oldest));
+
+  _released_early[v] = false;
+  if(_states[v] == State::Free)
+    Restart(v, volume);
+  else
+    { // The previous sound is faded out by Render() first:
+      _stolen_count++;
+      if(_states[v] == State::Playing)
+        _gains[v] = 1;
+      _states[v]       = State::Stealing;
+      _next_volumes[v] = volume;
+    }
+  _ids[v]       = _next_id++;
+  _triggered[v] = _trigger_count++;
+  return _ids[v];
+}
+
+
+void VoiceEngine::Restart(unsigned int v, double volume)
+{
+  _blueprints[v]->ResetTime();
+  _states[v]  = _released_early[v] ? State::Releasing : State::Playing;
+  _volumes[v] = volume;
+  _gains[v]   = 1;
+  _released_early[v] = false;
+}
+
+
+void VoiceEngine::Release(VoiceId voice)
+{
+  auto v = FindVoice(voice);
+  if(v >= 0 && _states[static_cast<unsigned int>(v)] == State::Playing)
+    _states[static_cast<unsigned int>(v)] = State::Releasing;
+  else if(v >= 0 && _states[static_cast<unsigned int>(v)] == State::Stealing)
+    _released_early[static_cast<unsigned int>(v)] = true;
+}
+
+
+void VoiceEngine::Stop(VoiceId voice)
+{
+  auto v = FindVoice(voice);
+  if(v >= 0)
+    {
+      _states[static_cast<unsigned int>(v)] = State::Free;
+      _ids[static_cast<unsigned int>(v)] = NoVoice;
+    }
+}
+
+
+bool VoiceEngine::IsPlaying(VoiceId voice) const
+{
+  return FindVoice(voice) >= 0;
+}
+
+
+Blueprint * VoiceEngine::GetBlueprint(VoiceId voice)
+{
+  auto v = FindVoice(voice);
+  if(v < 0)
+    return nullptr;
+  return _blueprints[static_cast<unsigned int>(v)].get();
+}
+
+
+int VoiceEngine::FindVoice(VoiceId voice) const
+{
+  if(voice == NoVoice)
+    return -1;
+  for(unsigned int i = 0; i < GetVoiceCount(); i++)
+    if(_ids[i] == voice)
+      return static_cast<int>(i);
+  return -1;
+}
+
+
+void VoiceEngine::Render(double * output, size_t frames)
+{
+  std::fill_n(output, frames, 0.0);
+
+  // The gain of a released voice decreases by this much each frame:
+  double fade = 1.0;
+  if(_release_time > 0)
+    fade = 1.0 / (_release_time * _samples_per_second);
+  const double steal_fade = 1.0 / (StealTime * _samples_per_second);
+
+  size_t chunk;
+  for(size_t done = 0; done < frames; done += chunk)
+    {
+      chunk = std::min(frames - done, static_cast<size_t>(Blueprint::MaxBlockSize));
+
+      _active.clear();
+      _active_blueprints.clear();
+      _active_outputs.clear();
+      for(unsigned int v = 0; v < GetVoiceCount(); v++)
+        if(_states[v] != State::Free)
+          {
+            _active.push_back(v);
+            _active_blueprints.push_back(_blueprints[v].get());
+            _active_outputs.push_back(_buffers.data() + static_cast<size_t>(v) * Blueprint::MaxBlockSize);
+            // The chunk ends where the stolen voice has faded out, so that its new sound starts without a delay:
+            if(_states[v] == State::Stealing)
+              chunk = std::min(chunk, std::max(static_cast<size_t>(1), static_cast<size_t>(std::ceil(_gains[v] / steal_fade))));
+          }
+      if(_active.empty())
+        break;
+
+      _active_rendered.resize(_active.size());
+      Blueprint::RenderVoices(_active_blueprints.data(), static_cast<unsigned int>(_active.size()), _active_outputs.data(), _active_rendered.data(), chunk);
+
+      for(size_t i = 0; i < _active.size(); i++)
+        {
+          auto v = _active[i];
+          auto samples = _active_outputs[i];
+          auto count = _active_rendered[i];
+          auto out = output + done;
+          if(_states[v] == State::Playing)
+            for(size_t j = 0; j < count; j++)
+              out[j] += _volumes[v] * samples[j];
+          else
+            {
+              auto step = _states[v] == State::Stealing ? steal_fade : fade;
+              for(size_t j = 0; j < count && _gains[v] > 0; j++)
+                {
+                  _gains[v] = std::max(0.0, _gains[v] - step);
+                  out[j] += _volumes[v] * _gains[v] * samples[j];
+                }
+            }
+
+          if(_states[v] == State::Stealing)
+            {
+              if(count < chunk || !(_gains[v] > 0))
+                Restart(v, _next_volumes[v]);
+            }
+          else if(count < chunk || !(_gains[v] > 0))
+            {
+              _states[v] = State::Free;
+              _ids[v] = NoVoice;
+            }
+        }
+    }
+}
+
+
+unsigned int VoiceEngine::GetVoiceCount() const
+{
+  return static_cast<unsigned int>(_states.size());
+}
+
+
+unsigned int VoiceEngine::GetActiveVoiceCount() const
+{
+  return static_cast<unsigned int>(std::count_if(_states.begin(), _states.end(), [](State state) { return state != State::Free; }));
+}
+
+
+unsigned long VoiceEngine::GetStolenVoiceCount() const
+{
+  return _stolen_count;
+}
@@ -0,0 +1,97 @@
+#ifndef VOICE_ENGINE_HH_
+#define VOICE_ENGINE_HH_
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "Blueprint.hh"
+#include <memory>
+#include <vector>
+
+namespace fmsynth
+{
+  // Plays many instances of the same blueprint at once, such as the sound effects of a game.
+  //
+  // The first voice is loaded from the file, the other voices are copies of it made with Node::Clone(),
+  // and all of them share one compiled program. Trigger() starts a free voice from
+  // the beginning, and when all the voices are playing, takes over the one which is the furthest
+  // in its release, or the oldest one. The voice which is taken over is faded out in a few
+  // milliseconds before its blueprint is restarted, so that cutting the sound does not click. A voice
+  // ends when its blueprint finishes, or when it has faded out after Release(). The voices are
+  // rendered together one block at a time, see Blueprint::RenderVoices(). The state the engine keeps
+  // of the voices is stored in arrays with a value per voice.
+  //
+  // The engine is not thread safe, the voices are triggered and released from the rendering thread.
+  class VoiceEngine
+  {
+  public:
+    typedef unsigned long VoiceId; // Identifies a triggered sound, a voice gets a new id each time it is triggered.
+    static constexpr VoiceId NoVoice = 0;
+
+    explicit VoiceEngine(unsigned int voice_count);
+
+    // Fails if the blueprint can not be loaded, or if the voices can not share the program:
+    [[nodiscard]] bool Load(const json11::Json & json, unsigned int samples_per_second);
+    void               SetBlockSize(unsigned int frames);
+    void               SetControlPeriod(unsigned int frames);
+    void               SetReleaseTime(double seconds); // The fade out of the released voices.
+
+    [[nodiscard]] VoiceId    Trigger(double volume = 1);
+    void                     Release(VoiceId voice);
+    void                     Stop(VoiceId voice); // Ends the voice immediately.
+    [[nodiscard]] bool       IsPlaying(VoiceId voice) const;
+    [[nodiscard]] Blueprint * GetBlueprint(VoiceId voice); // nullptr if the voice has ended, for changing the parameters of one voice.
+
+    // Renders the mix of the playing voices:
+    void Render(double * output, size_t frames);
+
+    [[nodiscard]] unsigned int GetVoiceCount()       const;
+    [[nodiscard]] unsigned int GetActiveVoiceCount() const;
+    [[nodiscard]] unsigned long GetStolenVoiceCount() const; // The voices taken over by Trigger() while playing.
+
+  private:
+    enum class State : unsigned char
+      {
+        Free,
+        Playing,
+        Releasing,
+        Stealing   // Fading out the previous sound, the blueprint is restarted when the gain reaches 0.
+      };
+    static constexpr double StealTime = 0.005; // The fade out of the stolen voices, in seconds.
+
+    std::vector<std::unique_ptr<Blueprint>> _blueprints;
+    std::vector<VoiceId>       _ids;
+    std::vector<State>         _states;
+    std::vector<double>        _volumes;
+    std::vector<double>        _gains;    // The fade out of the released and stolen voices, from 1 to 0.
+    std::vector<double>        _next_volumes; // The volume of the sound which starts when the stolen voice has faded out.
+    std::vector<bool>          _released_early; // Release() was called before the stolen voice was restarted.
+    std::vector<unsigned long> _triggered; // The order in which the voices were triggered.
+    std::vector<double>        _buffers;  // The output of each voice for one block.
+    VoiceId                    _next_id;
+    unsigned long              _trigger_count;
+    unsigned long              _stolen_count;
+    double                     _release_time;
+    unsigned int               _samples_per_second;
+
+    // The voices being rendered:
+    std::vector<unsigned int> _active;
+    std::vector<Blueprint *>  _active_blueprints;
+    std::vector<double *>     _active_outputs;
+    std::vector<size_t>       _active_rendered;
+
+    [[nodiscard]] int  FindVoice(VoiceId voice) const; // -1 if the voice has ended.
+    [[nodiscard]] bool ShareProgram();
+    void               Restart(unsigned int v, double volume);
+  };
+}
+
+#endif
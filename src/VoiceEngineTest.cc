@@ -0,0 +1,151 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "Blueprint.hh"
+#include "Test.hh"
+#include "Util.hh"
+#include "VoiceEngine.hh"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+// A filtered sawtooth with an envelope which stops the blueprint after 0.16 seconds:
+static const char * const FilteredSawtooth = R"({"links": [
+  {"from": "c", "to": "o", "to_channel": "Form"},
+  {"from": "o", "to": "f", "to_channel": "Form"},
+  {"from": "f", "to": "e", "to_channel": "Form"},
+  {"from": "e", "to": "out", "to_channel": "Form"}],
+ "nodes": [
+  {"constant": {"unit": 1, "value": 220}, "enabled": true, "node_id": "c", "node_type": "Constant"},
+  {"enabled": true, "node_id": "o", "node_type": "Oscillator", "oscillator_pulse_duty_cycle": 0.5, "oscillator_type": "Sawtooth"},
+  {"enabled": true, "filter_type": 2, "filter_value": 0.4, "node_id": "f", "node_type": "Filter"},
+  {"adhsr_attack": 0.01, "adhsr_decay": 0, "adhsr_end_action": 0, "adhsr_hold": 0.1, "adhsr_max_time_range": 1, "adhsr_release": 0.05, "adhsr_sustain": 1, "enabled": true, "node_id": "e", "node_type": "ADHSR"},
+  {"audiodeviceoutput_muted": false, "audiodeviceoutput_volume": 0.5, "enabled": true, "node_id": "out", "node_type": "AudioDeviceOutput"}]})";
+
+// A phase accumulating sine, smoothed and slowed down, with the envelope of the filtered sawtooth:
+static const char * const StretchedSine = R"({"links": [
+  {"from": "c", "to": "o", "to_channel": "Form"},
+  {"from": "o", "to": "s", "to_channel": "Form"},
+  {"from": "s", "to": "t", "to_channel": "Form"},
+  {"from": "t", "to": "e", "to_channel": "Form"},
+  {"from": "e", "to": "out", "to_channel": "Form"}],
+ "nodes": [
+  {"constant": {"unit": 1, "value": 330}, "enabled": true, "node_id": "c", "node_type": "Constant"},
+  {"enabled": true, "node_id": "o", "node_type": "Oscillator", "oscillator_phase_accumulator": true, "oscillator_pulse_duty_cycle": 0.5, "oscillator_type": "Sine"},
+  {"enabled": true, "node_id": "s", "node_type": "Smooth", "windowsize": 8},
+  {"enabled": true, "node_id": "t", "node_type": "TimeScale", "scale": 0.5},
+  {"adhsr_attack": 0.01, "adhsr_decay": 0, "adhsr_end_action": 0, "adhsr_hold": 0.1, "adhsr_max_time_range": 1, "adhsr_release": 0.05, "adhsr_sustain": 1, "enabled": true, "node_id": "e", "node_type": "ADHSR"},
+  {"audiodeviceoutput_muted": false, "audiodeviceoutput_volume": 0.5, "enabled": true, "node_id": "out", "node_type": "AudioDeviceOutput"}]})";
+
+
+static void TestVoices(const char * blueprint)
+{
+  std::string error;
+  auto json = json11::Json::parse(blueprint, error);
+  testAssert("Test blueprint is parsed.", error.empty());
+
+  const unsigned int blocksize = 64;
+  const unsigned int voices = 4;
+  fmsynth::VoiceEngine engine(voices);
+  bool loaded = engine.Load(json, 44100);
+  testAssert("Voices are loaded.", loaded && engine.GetVoiceCount() == voices && engine.GetActiveVoiceCount() == 0);
+  engine.SetBlockSize(blocksize);
+
+  fmsynth::Blueprint single;
+  loaded = single.Load(json);
+  single.SetSamplesPerSecond(44100);
+  single.SetBlockSize(blocksize);
+  std::vector<double> expected(44100);
+  auto length = single.Render(expected.data(), expected.size());
+  testAssert("The test blueprint finishes.", loaded && length > 7000 && length < 7100);
+
+  std::vector<double> output(44100);
+  auto voice = engine.Trigger();
+  testAssert("Triggered voice is playing.", voice != fmsynth::VoiceEngine::NoVoice && engine.IsPlaying(voice) && engine.GetBlueprint(voice) && engine.GetActiveVoiceCount() == 1);
+  engine.Render(output.data(), output.size());
+  testAssert("Voice produces the same output as the blueprint.", std::equal(expected.cbegin(), expected.cend(), output.cbegin(),
+                                                                             [](double a, double b) { return std::abs(a - b) < 0.000000001; }));
+  testAssert("Voice ends when its blueprint finishes.", !engine.IsPlaying(voice) && !engine.GetBlueprint(voice) && engine.GetActiveVoiceCount() == 0);
+
+  // The voices are triggered one block apart, and rendered together:
+  std::vector<double> mixed(44100, 0.0);
+  for(unsigned int v = 0; v < voices; v++)
+    {
+      [[maybe_unused]] auto id = engine.Trigger();
+      engine.Render(output.data(), blocksize);
+      std::copy_n(output.cbegin(), blocksize, mixed.begin() + v * blocksize);
+    }
+  engine.Render(output.data(), output.size() - voices * blocksize);
+  std::copy(output.cbegin(), output.cend() - voices * blocksize, mixed.begin() + voices * blocksize);
+  for(unsigned int v = 0; v < voices; v++)
+    for(size_t i = 0; i + v * blocksize < mixed.size(); i++)
+      mixed[i + v * blocksize] -= expected[i];
+  testAssert("Voices rendered together produce the same output as the blueprints rendered one by one.",
+             std::all_of(mixed.cbegin(), mixed.cend(), [](double v) { return std::abs(v) < 0.000000001; }));
+  testAssert("All voices have ended.", engine.GetActiveVoiceCount() == 0 && engine.GetStolenVoiceCount() == 0);
+}
+
+
+static void Test()
+{
+  TestVoices(FilteredSawtooth);
+  TestVoices(StretchedSine);
+
+  {
+    std::string testname = "Oldest voice is stolen when all voices are playing.";
+    auto [hello, loaderror] = fmsynth::util::LoadJsonFile(srcdir + "/../examples/HelloWorld.sbp");
+    if(hello)
+      {
+        fmsynth::VoiceEngine engine(2);
+        bool loaded = engine.Load(*hello, 44100);
+        engine.SetReleaseTime(0.01);
+        std::vector<double> output(1000);
+
+        auto a = engine.Trigger();
+        engine.Render(output.data(), output.size());
+        auto b = engine.Trigger();
+        engine.Render(output.data(), output.size());
+        auto c = engine.Trigger();
+        testAssert(testname, loaded && !engine.IsPlaying(a) && engine.IsPlaying(b) && engine.IsPlaying(c) && engine.GetStolenVoiceCount() == 1);
+
+        engine.Render(output.data(), output.size());
+        engine.Release(c);
+        engine.Render(output.data(), 100);
+        std::vector<double> joined(output.cbegin() + 98, output.cbegin() + 100);
+        auto d = engine.Trigger();
+        testAssert("Released voice is stolen before the playing ones.", engine.IsPlaying(b) && !engine.IsPlaying(c) && engine.IsPlaying(d) && engine.GetStolenVoiceCount() == 2);
+
+        // The stolen voice is faded out before its sine restarts from zero. The second differences of the output stay
+        // below 0.003, except for the start of the new sine, 0.02. Restarting the voice without the fade leaves a step:
+        engine.Render(output.data(), output.size());
+        joined.insert(joined.end(), output.cbegin(), output.cend());
+        bool smooth = true;
+        for(size_t i = 2; i < joined.size(); i++)
+          smooth = smooth && std::abs(joined[i] - 2 * joined[i - 1] + joined[i - 2]) < 0.035;
+        testAssert("Stolen voice fades out before its new sound starts.", smooth);
+
+        engine.Stop(b);
+        engine.Release(d);
+        testAssert("Released voice plays until it has faded out.", engine.IsPlaying(d) && engine.GetActiveVoiceCount() == 1);
+        engine.Render(output.data(), output.size());
+        auto peak = [&output](long from, long to) { return std::abs(*std::max_element(output.cbegin() + from, output.cbegin() + to,
+                                                                                       [](double x, double y) { return std::abs(x) < std::abs(y); })); };
+        testAssert("Released voice fades out.", peak(0, 100) > 0.2 && peak(0, 100) < 0.33 && peak(400, 441) < 0.033);
+        testAssert("Voice ends after the release time.", !engine.IsPlaying(d) && engine.GetActiveVoiceCount() == 0 &&
+                   std::all_of(output.cbegin() + 441, output.cend(), [](double v) { return !(std::abs(v) > 0); }));
+      }
+    else
+      testSkip(testname, loaderror);
+    delete hello;
+  }
+}
@@ -0,0 +1,227 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "WavWriter.hh"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+using namespace fmsynth;
+
+
+namespace
+{
+  const uint16_t WAVE_FORMAT_PCM        = 1;
+  const uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+
+
+  // The WAV files are little endian, the values are stored byte by byte:
+  unsigned char * Store(unsigned char * p, uint32_t value, unsigned int bytes)
+  {
+    for(unsigned int i = 0; i < bytes; i++)
+      *p++ = static_cast<unsigned char>(value >> (8 * i));
+    return p;
+  }
+
+  unsigned char * Store(unsigned char * p, const char * tag)
+  {
+    return std::copy_n(tag, 4, p);
+  }
+
+  uint32_t Size(std::streamoff size)
+  { // The sizes of a file larger than 4 GiB do not fit in, the readers are expected to read until the end of the file.
+    return static_cast<uint32_t>(std::min(size, static_cast<std::streamoff>(std::numeric_limits<uint32_t>::max())));
+  }
+}
+
+
+const char * WavWriter::GetFormatName(Format format)
+{
+  switch(format)
+    {
+    case Format::PCM16:   return "pcm16";
+    case Format::PCM24:   return "pcm24";
+    case Format::Float32: return "float32";
+    }
+  assert(false);
+  return "";
+}
+
+
+std::optional<WavWriter::Format> WavWriter::GetFormatByName(const std::string & name)
+{
+  for(auto format : { Format::PCM16, Format::PCM24, Format::Float32 })
+    if(name == GetFormatName(format))
+      return format;
+  return std::nullopt;
+}
+
+
+unsigned int WavWriter::GetBytesPerSample(Format format)
+{
+  switch(format)
+    {
+    case Format::PCM16:   return 2;
+    case Format::PCM24:   return 3;
+    case Format::Float32: return 4;
+    }
+  assert(false);
+  return 0;
+}
+
+
+WavWriter::WavWriter()
+  : _format(Format::PCM16),
+    _channels(1),
+    _fact_offset(0),
+    _data_offset(0),
+    _frames(0),
+    _buffer(ChunkSize),
+    _buffer_used(0)
+{
+}
+
+
+WavWriter::~WavWriter()
+{
+  if(IsOpen())
+    Close();
+}
+
+
+bool WavWriter::Open(const std::string & filename, unsigned int samples_per_second, unsigned int channels, Format format)
+{
+  assert(channels > 0);
+  if(IsOpen())
+    Close();
+
+  _format = format;
+  _channels = channels;
+  _frames = 0;
+  _buffer_used = 0;
+  _file.clear();
+  _file.open(filename, std::ios::binary | std::ios::trunc);
+  if(!_file.is_open())
+    return false;
+
+  // The sizes are written as 0 and patched by Close(). The non-PCM formats have the cbSize field and a fact chunk.
+  bool pcm = format != Format::Float32;
+  auto bytes = GetBytesPerSample(format);
+  unsigned char header[58];
+  auto p = header;
+  p = Store(p, "RIFF");
+  p = Store(p, 0, 4);
+  p = Store(p, "WAVE");
+  p = Store(p, "fmt ");
+  p = Store(p, pcm ? 16 : 18, 4);
+  p = Store(p, pcm ? WAVE_FORMAT_PCM : WAVE_FORMAT_IEEE_FLOAT, 2);
+  p = Store(p, channels, 2);
+  p = Store(p, samples_per_second, 4);
+  p = Store(p, samples_per_second * channels * bytes, 4);
+  p = Store(p, channels * bytes, 2);
+  p = Store(p, 8 * bytes, 2);
+  if(!pcm)
+    {
+      p = Store(p, 0, 2);
+      p = Store(p, "fact");
+      p = Store(p, 4, 4);
+      _fact_offset = p - header;
+      p = Store(p, 0, 4);
+    }
+  else
+    _fact_offset = 0;
+  p = Store(p, "data");
+  p = Store(p, 0, 4);
+  _data_offset = p - header;
+
+  _file.write(reinterpret_cast<const char *>(header), _data_offset);
+  return _file.good();
+}
+
+
+bool WavWriter::IsOpen() const
+{
+  return _file.is_open();
+}
+
+
+void WavWriter::Write(const double * samples, size_t frames)
+{
+  assert(IsOpen());
+  auto bytes = GetBytesPerSample(_format);
+  for(size_t i = 0; i < frames * _channels; i++)
+    {
+      if(_buffer_used + bytes > ChunkSize)
+        Flush();
+
+      auto p = _buffer.data() + _buffer_used;
+      switch(_format)
+        {
+        case Format::PCM16:
+          Store(p, static_cast<uint32_t>(std::lround(std::clamp(samples[i], -1.0, 1.0) * 32767.0)), 2);
+          break;
+        case Format::PCM24:
+          Store(p, static_cast<uint32_t>(std::lround(std::clamp(samples[i], -1.0, 1.0) * 8388607.0)), 3);
+          break;
+        case Format::Float32:
+          Store(p, std::bit_cast<uint32_t>(static_cast<float>(samples[i])), 4);
+          break;
+        }
+      _buffer_used += bytes;
+    }
+  _frames += frames;
+}
+
+
+void WavWriter::Flush()
+{
+  _file.write(reinterpret_cast<const char *>(_buffer.data()), static_cast<std::streamsize>(_buffer_used));
+  _buffer_used = 0;
+}
+
+
+bool WavWriter::Close()
+{
+  assert(IsOpen());
+  Flush();
+
+  // The data chunk is padded to an even size:
+  auto datasize = static_cast<std::streamoff>(_frames * _channels * GetBytesPerSample(_format));
+  if(datasize % 2)
+    _file.put(0);
+
+  unsigned char size[4];
+  _file.seekp(4);
+  Store(size, Size(_data_offset - 8 + datasize + datasize % 2), 4);
+  _file.write(reinterpret_cast<const char *>(size), 4);
+  if(_fact_offset > 0)
+    {
+      _file.seekp(_fact_offset);
+      Store(size, Size(static_cast<std::streamoff>(_frames)), 4);
+      _file.write(reinterpret_cast<const char *>(size), 4);
+    }
+  _file.seekp(_data_offset - 4);
+  Store(size, Size(datasize), 4);
+  _file.write(reinterpret_cast<const char *>(size), 4);
+
+  bool ok = _file.good();
+  _file.close();
+  return ok && !_file.fail();
+}
+
+
+size_t WavWriter::GetFrameCount() const
+{
+  return _frames;
+}
@@ -0,0 +1,75 @@
+#ifndef WAV_WRITER_HH_
+#define WAV_WRITER_HH_
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace fmsynth
+{
+  // Writes a WAV file while the samples are rendered.
+  //
+  // The header is written when the file is opened, the samples are converted into a buffer of ChunkSize bytes
+  // which is appended to the file whenever it fills up, and the sizes in the header are patched when the file
+  // is closed. The memory use does not depend on the length of the file.
+  class WavWriter
+  {
+  public:
+    enum class Format
+      {
+        PCM16,
+        PCM24,
+        Float32
+      };
+
+    static constexpr size_t ChunkSize = 64 * 1024;
+
+    [[nodiscard]] static const char *           GetFormatName(Format format);
+    [[nodiscard]] static std::optional<Format>  GetFormatByName(const std::string & name);
+    [[nodiscard]] static unsigned int           GetBytesPerSample(Format format);
+
+    WavWriter();
+    WavWriter(const WavWriter & src)             = delete;
+    WavWriter(WavWriter && src)                  = delete;
+    ~WavWriter(); // Closes the file.
+
+    WavWriter & operator=(const WavWriter & rhs) = delete;
+    WavWriter & operator=(WavWriter && rhs)      = delete;
+
+    [[nodiscard]] bool Open(const std::string & filename, unsigned int samples_per_second, unsigned int channels = 1, Format format = Format::PCM16);
+    [[nodiscard]] bool IsOpen() const;
+    // The samples of the channels are interleaved. The values are clamped to -1..1 for the PCM formats.
+    void               Write(const double * samples, size_t frames);
+    // Returns false if writing any part of the file failed.
+    bool               Close();
+
+    [[nodiscard]] size_t GetFrameCount() const;
+
+  private:
+    std::ofstream              _file;
+    Format                     _format;
+    unsigned int               _channels;
+    std::streamoff             _fact_offset; // The position of the frame count in the fact chunk, 0 if there is no fact chunk.
+    std::streamoff             _data_offset; // The position of the first sample.
+    size_t                     _frames;
+    std::vector<unsigned char> _buffer;
+    size_t                     _buffer_used;
+
+    void Flush();
+  };
+}
+
+#endif
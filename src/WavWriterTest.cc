@@ -0,0 +1,130 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "WavWriter.hh"
+#include "Test.hh"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+
+static std::vector<unsigned char> ReadFile(const std::string & filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+
+static uint32_t Get(const std::vector<unsigned char> & data, size_t offset, unsigned int bytes)
+{
+  uint32_t value = 0;
+  for(unsigned int i = 0; i < bytes; i++)
+    value |= static_cast<uint32_t>(data[offset + i]) << (8 * i);
+  return value;
+}
+
+
+static bool HasTag(const std::vector<unsigned char> & data, size_t offset, const std::string & tag)
+{
+  return std::string(data.cbegin() + static_cast<long>(offset), data.cbegin() + static_cast<long>(offset + 4)) == tag;
+}
+
+
+static double GetSample(const std::vector<unsigned char> & data, size_t offset, fmsynth::WavWriter::Format format)
+{
+  switch(format)
+    {
+    case fmsynth::WavWriter::Format::PCM16:
+      return static_cast<int16_t>(Get(data, offset, 2)) / 32767.0;
+    case fmsynth::WavWriter::Format::PCM24:
+      return static_cast<int32_t>(Get(data, offset, 3) << 8) / 256 / 8388607.0;
+    case fmsynth::WavWriter::Format::Float32:
+      return static_cast<double>(std::bit_cast<float>(Get(data, offset, 4)));
+    }
+  return 0;
+}
+
+
+static void Test()
+{
+  using Format = fmsynth::WavWriter::Format;
+  auto filename = (std::filesystem::temp_directory_path() / "WavWriterTest.wav").string();
+
+  for(auto format : { Format::PCM16, Format::PCM24, Format::Float32 })
+    for(unsigned int channels : { 1u, 2u })
+      {
+        std::string name = std::string(fmsynth::WavWriter::GetFormatName(format)) + (channels == 1 ? " mono" : " stereo");
+        auto bytes = fmsynth::WavWriter::GetBytesPerSample(format);
+
+        // More samples than fit in one chunk, written in blocks of different sizes, with an odd number of frames:
+        const auto frames = static_cast<unsigned int>(3 * fmsynth::WavWriter::ChunkSize / bytes / channels + 1);
+        std::vector<double> samples(frames * channels);
+        for(unsigned int i = 0; i < samples.size(); i++)
+          samples[i] = 1.2 * std::sin(0.001 * i);
+
+        fmsynth::WavWriter writer;
+        bool ok = writer.Open(filename, 48000, channels, format);
+        for(unsigned int done = 0, block = 1; done < frames; block = block * 2 + 1)
+          {
+            auto n = std::min(block, frames - done);
+            writer.Write(samples.data() + done * channels, n);
+            done += n;
+          }
+        testAssert(name + ": All frames are written.", writer.GetFrameCount() == frames);
+        ok = writer.Close() && ok;
+        testAssert(name + ": File is written.", ok && !writer.IsOpen());
+
+        auto data = ReadFile(filename);
+        size_t datasize = frames * channels * bytes;
+        size_t header = format == Format::Float32 ? 58 : 44;
+        testComment << name << ": file size=" << data.size() << "\n";
+        testAssert(name + ": File size matches the samples.", data.size() == header + datasize + datasize % 2);
+        if(data.size() != header + datasize + datasize % 2)
+          continue;
+
+        testAssert(name + ": RIFF size is patched.", HasTag(data, 0, "RIFF") && HasTag(data, 8, "WAVE") && Get(data, 4, 4) == data.size() - 8);
+        testAssert(name + ": Format chunk is set.",
+                   HasTag(data, 12, "fmt ")
+                   && Get(data, 20, 2) == (format == Format::Float32 ? 3 : 1)
+                   && Get(data, 22, 2) == channels
+                   && Get(data, 24, 4) == 48000
+                   && Get(data, 28, 4) == 48000 * channels * bytes
+                   && Get(data, 32, 2) == channels * bytes
+                   && Get(data, 34, 2) == 8 * bytes);
+        if(format == Format::Float32)
+          testAssert(name + ": Fact chunk has the frame count.", HasTag(data, 38, "fact") && Get(data, 46, 4) == frames);
+        testAssert(name + ": Data size is patched.", HasTag(data, header - 8, "data") && Get(data, header - 4, 4) == datasize);
+
+        double maxdiff = 0;
+        for(size_t i = 0; i < samples.size(); i++)
+          {
+            double expected = format == Format::Float32 ? samples[i] : std::clamp(samples[i], -1.0, 1.0);
+            maxdiff = std::max(maxdiff, std::abs(GetSample(data, header + i * bytes, format) - expected));
+          }
+        testComment << name << ": maxdiff=" << maxdiff << "\n";
+        double tolerance = format == Format::PCM16 ? 0.5 / 32767.0 : format == Format::PCM24 ? 0.5 / 8388607.0 : 1e-7;
+        testAssert(name + ": Samples are written" + (format == Format::Float32 ? "." : " and clamped."), maxdiff <= tolerance);
+      }
+
+  {
+    fmsynth::WavWriter writer;
+    testAssert("Writing to a file which can not be created fails.", !writer.Open("/nonexistent/directory/WavWriterTest.wav", 48000));
+  }
+
+  std::filesystem::remove(filename);
+}
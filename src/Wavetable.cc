@@ -0,0 +1,173 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "Wavetable.hh"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+using namespace fmsynth;
+
+static_assert(std::has_single_bit(Wavetable::Size));
+static_assert(std::has_single_bit(Wavetable::MaxHarmonics) && Wavetable::MaxHarmonics <= Wavetable::Size / 2);
+
+
+namespace
+{
+  std::atomic<size_t> memory_usage { 0 };
+
+
+  double Coefficient(Wavetable::Wave wave, unsigned int harmonic)
+  { // Fourier series, sin(harmonic * phase) multiplied by this.
+    auto k = static_cast<double>(harmonic);
+    switch(wave)
+      {
+      case Wavetable::Wave::Sine:
+        return harmonic == 1 ? 1.0 : 0.0;
+      case Wavetable::Wave::Triangle:
+        if(harmonic % 2 == 0)
+          return 0;
+        return (harmonic % 4 == 1 ? 8.0 : -8.0) / (std::numbers::pi * std::numbers::pi * k * k);
+      case Wavetable::Wave::Sawtooth:
+        return (harmonic % 2 == 1 ? 2.0 : -2.0) / (std::numbers::pi * k);
+      }
+    assert(false);
+    return 0;
+  }
+}
+
+
+Wavetable::Wavetable(Wave wave)
+  : _wave(wave),
+    _levels(wave == Wave::Sine ? 1 : static_cast<unsigned int>(std::countr_zero(MaxHarmonics) + 1))
+{
+  std::vector<double> sine(Size);
+  for(unsigned int i = 0; i < Size; i++)
+    sine[i] = std::sin(2.0 * std::numbers::pi * static_cast<double>(i) / Size);
+
+  // Build the levels from the one with the fewest harmonics, adding the missing harmonics for each next level:
+  _samples.resize(_levels * (Size + 1));
+  std::vector<double> sum(Size, 0.0);
+  unsigned int harmonics = 0;
+  for(unsigned int level = _levels; level-- > 0;)
+    {
+      unsigned int top = wave == Wave::Sine ? 1 : MaxHarmonics >> level;
+      for(unsigned int k = harmonics + 1; k <= top; k++)
+        {
+          double a = Coefficient(wave, k);
+          if(!(std::abs(a) > 0))
+            continue;
+          for(unsigned int i = 0; i < Size; i++)
+            sum[i] += a * sine[(k * i) % Size];
+        }
+      harmonics = top;
+
+      auto samples = _samples.begin() + level * (Size + 1);
+      std::copy(sum.cbegin(), sum.cend(), samples);
+      samples[Size] = sum[0];
+    }
+
+  memory_usage += GetSize();
+}
+
+
+const Wavetable & Wavetable::Get(Wave wave)
+{
+  switch(wave)
+    {
+    case Wave::Sine:     { static const Wavetable table(Wave::Sine);     return table; }
+    case Wave::Triangle: { static const Wavetable table(Wave::Triangle); return table; }
+    case Wave::Sawtooth: { static const Wavetable table(Wave::Sawtooth); return table; }
+    }
+  assert(false);
+  return Get(Wave::Sine);
+}
+
+
+size_t Wavetable::GetMemoryUsage()
+{
+  return memory_usage;
+}
+
+
+Wavetable::Wave Wavetable::GetWave() const
+{
+  return _wave;
+}
+
+
+unsigned int Wavetable::GetLevelCount() const
+{
+  return _levels;
+}
+
+
+size_t Wavetable::GetSize() const
+{
+  return sizeof *this + _samples.capacity() * sizeof(double);
+}
+
+
+unsigned int Wavetable::GetLevel(double increment) const
+{
+  // The level l has MaxHarmonics / 2^l harmonics, the highest harmonic must stay below 0.5 cycles per frame:
+  double cycles = std::abs(increment) * (0.5 / std::numbers::pi);
+  if(!(cycles > 0))
+    return 0;
+
+  int exponent;
+  std::frexp(cycles, &exponent); // cycles < 2^exponent
+  int level = std::countr_zero(MaxHarmonics) + 1 + exponent;
+  return static_cast<unsigned int>(std::clamp(level, 0, static_cast<int>(_levels) - 1));
+}
+
+
+double Wavetable::Lookup(double phase, double increment) const
+{
+  double position = phase * (Size * 0.5 / std::numbers::pi);
+  double index = std::floor(position);
+  double fraction = position - index;
+  auto i = static_cast<unsigned long>(static_cast<long>(index)) & (Size - 1);
+  auto samples = _samples.data() + GetLevel(increment) * (Size + 1) + i;
+  return samples[0] + fraction * (samples[1] - samples[0]);
+}
+
+
+void Wavetable::Lookup(const double * phase, const double * frequency, double samples_per_second, double * output, unsigned int count) const
+{
+  for(unsigned int i = 0; i < count; i++)
+    output[i] = Lookup(phase[i], frequency[i] / samples_per_second);
+}
+
+
+double Wavetable::Pulse(double phase, double increment, double duty)
+{
+  if(duty <= -1)
+    return -1;
+  if(duty >= 1)
+    return 1;
+
+  // The sawtooth falls by 2 at pi, the pulse rises by 2 at pi - asin(duty) and falls by 2 at asin(duty):
+  auto & sawtooth = Get(Wave::Sawtooth);
+  double edge = std::asin(duty);
+  return sawtooth.Lookup(phase + std::numbers::pi - edge, increment) - sawtooth.Lookup(phase + edge, increment) + 2.0 / std::numbers::pi * edge;
+}
+
+
+void Wavetable::Pulse(const double * phase, const double * frequency, double samples_per_second, const double * duty, double * output, unsigned int count)
+{
+  for(unsigned int i = 0; i < count; i++)
+    output[i] = Pulse(phase[i], frequency[i] / samples_per_second, duty[i]);
+}
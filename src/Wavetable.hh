@@ -0,0 +1,69 @@
+#ifndef WAVETABLE_HH_
+#define WAVETABLE_HH_
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include <cstddef>
+#include <vector>
+
+namespace fmsynth
+{
+  // Immutable, band-limited single cycle wavetable, shared by the whole process.
+  //
+  // The tables are built on the first use of each wave, and after that they are read
+  // by all the threads without locking. Each table has mip levels of halving number of
+  // harmonics, and the level is selected by the phase increment per frame, so that no
+  // harmonics go above the Nyquist frequency. Because the levels depend only on the
+  // increment, the same tables serve all the sample rates.
+  //
+  // The phase is in radians, and the waves have the same phase as the kernels in Kernels.hh.
+  class Wavetable
+  {
+  public:
+    enum class Wave
+      {
+        Sine,
+        Triangle,
+        Sawtooth
+      };
+
+    static constexpr unsigned int Size         = 4096; // Samples per cycle.
+    static constexpr unsigned int MaxHarmonics = 1024; // Harmonics in the first level, halved for each next level.
+
+    [[nodiscard]] static const Wavetable & Get(Wave wave);
+    [[nodiscard]] static size_t            GetMemoryUsage(); // Bytes used by the tables built so far.
+
+    [[nodiscard]] Wave         GetWave()       const;
+    [[nodiscard]] unsigned int GetLevelCount() const;
+    [[nodiscard]] size_t       GetSize()       const; // Bytes used by this table.
+
+    [[nodiscard]] double Lookup(double phase, double increment) const;
+    void                 Lookup(const double * phase, const double * frequency, double samples_per_second, double * output, unsigned int count) const;
+
+    // Band-limited sin(phase) <= duty ? 1 : -1, made of two sawtooths:
+    [[nodiscard]] static double Pulse(double phase, double increment, double duty);
+    static void                 Pulse(const double * phase, const double * frequency, double samples_per_second, const double * duty, double * output, unsigned int count);
+
+    Wavetable(const Wavetable &)             = delete;
+    Wavetable & operator=(const Wavetable &) = delete;
+
+  private:
+    Wave                _wave;
+    unsigned int        _levels;
+    std::vector<double> _samples; // Size + 1 samples for each level, the last sample repeats the first.
+
+    explicit Wavetable(Wave wave);
+    [[nodiscard]] unsigned int GetLevel(double increment) const;
+  };
+}
+
+#endif
@@ -0,0 +1,91 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "Kernels.hh"
+#include "Test.hh"
+#include "Wavetable.hh"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <thread>
+#include <vector>
+
+
+static void Test()
+{
+  using fmsynth::Wavetable;
+
+  testAssert("No memory is used before the tables are used.", Wavetable::GetMemoryUsage() == 0);
+
+  {
+    std::vector<const Wavetable *> tables(8, nullptr);
+    std::vector<std::thread> threads;
+    for(unsigned int i = 0; i < tables.size(); i++)
+      threads.emplace_back([&tables, i]() { tables[i] = &Wavetable::Get(Wavetable::Wave::Sawtooth); });
+    for(auto & t : threads)
+      t.join();
+    testAssert("All the threads get the same table.", std::all_of(tables.cbegin(), tables.cend(), [&tables](auto t) { return t == tables[0]; }));
+
+    auto usage = Wavetable::GetMemoryUsage();
+    testComment << "memory usage=" << usage << "\n";
+    testAssert("Memory usage of the built table is reported.", usage == tables[0]->GetSize() && usage > Wavetable::Size * sizeof(double));
+    for(unsigned int i = 0; i < 100; i++)
+      [[maybe_unused]] auto & table = Wavetable::Get(Wavetable::Wave::Sawtooth);
+    testAssert("Using a table again does not use more memory.", Wavetable::GetMemoryUsage() == usage);
+  }
+
+  {
+    const double sps = 44100;
+    double sine_error = 0;
+    double triangle_error = 0;
+    double sawtooth_error = 0;
+    double pulse_error = 0;
+    double increment = 2.0 * std::numbers::pi * 20.0 / sps;
+    auto & sine = Wavetable::Get(Wavetable::Wave::Sine);
+    auto & triangle = Wavetable::Get(Wavetable::Wave::Triangle);
+    auto & sawtooth = Wavetable::Get(Wavetable::Wave::Sawtooth);
+    for(unsigned int i = 0; i < sps; i++)
+      {
+        double phase = increment * i;
+        sine_error = std::max(sine_error, std::abs(sine.Lookup(phase, increment) - std::sin(phase)));
+        // Band-limiting rounds the corners and the edges, compare only away from them:
+        double cycles = phase / (2.0 * std::numbers::pi);
+        cycles -= std::floor(cycles);
+        if(std::abs(cycles - 0.25) > 0.05 && std::abs(cycles - 0.75) > 0.05)
+          triangle_error = std::max(triangle_error, std::abs(triangle.Lookup(phase, increment) - 2.0 / std::numbers::pi * std::asin(std::sin(phase))));
+        if(std::abs(cycles - 0.5) > 0.05)
+          sawtooth_error = std::max(sawtooth_error, std::abs(sawtooth.Lookup(phase, increment) - fmsynth::kernels::Sawtooth(phase, increment)));
+        if(std::abs(std::sin(phase) - 0.5) > 0.1)
+          pulse_error = std::max(pulse_error, std::abs(Wavetable::Pulse(phase, increment, 0.5) - (std::sin(phase) <= 0.5 ? 1.0 : -1.0)));
+      }
+    testComment << "errors: sine=" << sine_error << ", triangle=" << triangle_error << ", sawtooth=" << sawtooth_error << ", pulse=" << pulse_error << "\n";
+    testAssert("Sine table is accurate.", sine_error < 0.000001);
+    testAssert("Triangle table is accurate at 20Hz.", triangle_error < 0.001);
+    testAssert("Sawtooth table is accurate at 20Hz.", sawtooth_error < 0.01);
+    testAssert("Pulse made of the sawtooth table is accurate at 20Hz.", pulse_error < 0.02);
+  }
+
+  {
+    // At 0.2 cycles per frame, only the harmonics 1 and 2 are below the Nyquist frequency:
+    double increment = 2.0 * std::numbers::pi * 0.2;
+    auto & sawtooth = Wavetable::Get(Wavetable::Wave::Sawtooth);
+    double error = 0;
+    for(unsigned int i = 0; i < 1000; i++)
+      {
+        double phase = 0.01 * i;
+        double expected = 2.0 / std::numbers::pi * (std::sin(phase) - std::sin(2.0 * phase) / 2.0);
+        error = std::max(error, std::abs(sawtooth.Lookup(phase, increment) - expected));
+      }
+    testComment << "error=" << error << "\n";
+    testAssert("High frequencies use a level without harmonics above the Nyquist frequency.", error < 0.00001);
+  }
+}
@@ -41,6 +41,7 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <unordered_map>
 #include "QtIncludeBegin.hh"
 #include <QFileDialog>
 #include <QtGui/QDrag>
@@ -243,6 +244,7 @@ WidgetNode * WidgetBlueprint::AddNode(int x, int y, const std::string & node_typ
         std::lock_guard lock(_blueprint->GetLockMutex());
         _nodes.push_back(nodewidget);
         _blueprint->AddNode(nodewidget->GetSharedNode());
+        UpdateProgram();
       }
     }
 
@@ -258,6 +260,7 @@ void WidgetBlueprint::AddLink(WidgetNode * from_node, WidgetNode * to_node, fmsy
   {
     std::lock_guard lock(_blueprint->GetLockMutex());
     _links.push_back(new Link(this, from_node, to_node, to_channel));
+    UpdateProgram();
   }
   
   // todo: Update only the connectors that actually change, not all connectors of both nodes.
@@ -288,6 +291,7 @@ void WidgetBlueprint::DeleteNode(WidgetNode * node)
     std::lock_guard lock(_blueprint->GetLockMutex());
 
     _blueprint->RemoveNode(node->GetNode());
+    UpdateProgram();
   
     for(unsigned int i = 0; i < _nodes.size(); i++)
       if(_nodes[i] == node)
@@ -295,36 +299,37 @@ void WidgetBlueprint::DeleteNode(WidgetNode * node)
 
     if(node)
       node->deleteLater();
-    
-    PostEdit();
   }
+  PostEdit();
 }
 
 
 void WidgetBlueprint::DeleteLink(std::function<bool(const Link *)> match_callback)
 {
   std::set<QWidget *> edited_nodes;
-  std::lock_guard lock(_blueprint->GetLockMutex());
+  {
+    std::lock_guard lock(_blueprint->GetLockMutex());
 
-  for(unsigned int i = 0; i < _links.size(); i++)
-    {
-      auto link = _links[i];
-      if(link && match_callback(link))
-        {
-          auto from_node = link->GetFromNode();
-          auto to_node = link->GetToNode();
+    for(unsigned int i = 0; i < _links.size(); i++)
+      {
+        auto link = _links[i];
+        if(link && match_callback(link))
+          {
+            auto from_node = link->GetFromNode();
+            auto to_node = link->GetToNode();
 
-          delete link;
-          _links[i] = nullptr;
+            delete link;
+            _links[i] = nullptr;
 
-          from_node->UpdateConnectorStates();
-          to_node->UpdateConnectorStates();
+            from_node->UpdateConnectorStates();
+            to_node->UpdateConnectorStates();
           
-          edited_nodes.insert(from_node);
-          edited_nodes.insert(to_node);
-        }
-    }
-
+            edited_nodes.insert(from_node);
+            edited_nodes.insert(to_node);
+          }
+      }
+    UpdateProgram();
+  }
   PostEdit(edited_nodes);
 }
 
@@ -465,6 +470,10 @@ void WidgetBlueprint::Save(const std::string & filename)
 json11::Json WidgetBlueprint::to_json()
 {
   UpdateNodesData();
+
+  // The nodes are read with the audio thread locked out, after the changes posted to them have been applied:
+  std::lock_guard lock(_blueprint->GetLockMutex());
+  _blueprint->ApplyParameterChanges();
   
   json11::Json::array nodes;
   for(auto n : _nodes)
@@ -591,13 +600,14 @@ void WidgetBlueprint::Load(const json11::Json & json)
       node->SetFromJson(n);
     }
 
-  auto FindNodeById = [this](const std::string & node_id) -> WidgetNode *
+  std::unordered_map<std::string, WidgetNode *> nodes_by_id;
+  for(auto n : _nodes)
+    nodes_by_id.try_emplace(n->GetNodeId(), n);
+  auto FindNodeById = [&nodes_by_id](const std::string & node_id) -> WidgetNode *
   {
-    for(auto n : _nodes)
-      if(n->GetNodeId() == node_id)
-        return n;
-    assert(false);
-    return nullptr;
+    auto it = nodes_by_id.find(node_id);
+    assert(it != nodes_by_id.cend());
+    return it != nodes_by_id.cend() ? it->second : nullptr;
   };
   
   for(auto l : links)
@@ -656,6 +666,34 @@ void WidgetBlueprint::PostEdit()
 }
 
 
+void WidgetBlueprint::PostParameterChange(const fmsynth::ParameterChange & change, bool changes_range)
+{
+  // The new values of the folded nodes are copied into the program by the audio thread:
+  if(IsPlaying() && !changes_range && _blueprint->PostParameterChange(change))
+    return;
+
+  // The queued changes are applied first to keep them in order:
+  std::lock_guard lock(_blueprint->GetLockMutex());
+  _blueprint->ApplyParameterChanges();
+  change.Apply();
+  UpdateProgram();
+}
+
+
+bool WidgetBlueprint::IsPlaying() const
+{
+  return ProgramPlayer->IsPlaying() && ProgramPlayer->GetAudioDevice()->GetBlueprint() == _blueprint;
+}
+
+
+void WidgetBlueprint::UpdateProgram()
+{
+  // The program of a blueprint which is not played is compiled when it is played:
+  if(IsPlaying())
+    _blueprint->UpdateProgram();
+}
+
+
 void WidgetBlueprint::UpdateWindowTitle()
 {
   std::string title;
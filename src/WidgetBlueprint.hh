@@ -23,6 +23,7 @@
 namespace fmsynth
 {
   class Blueprint;
+  class ParameterChange;
 }
 class Link;
 class QScrollArea;
@@ -75,6 +76,13 @@ public:
   void PostEdit();
   void PostEdit(QWidget * edited_node);
   void PostEdit(const std::set<QWidget *> & edited_nodes);
+  // While the blueprint is played, the change is applied by the audio thread at the start of its next block. A change
+  // which gives a node another output range needs a new program, it is set here and UpdateProgram() is called:
+  void PostParameterChange(const fmsynth::ParameterChange & change, bool changes_range = false);
+  [[nodiscard]] bool IsPlaying() const;
+  // Compiles the program of the blueprint being played after an edit, so that the audio thread does not need to.
+  // Called with the lock of the blueprint held:
+  void UpdateProgram();
   
   void               Undo();
   void               Redo();
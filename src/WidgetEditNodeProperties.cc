@@ -92,6 +92,7 @@ void WidgetEditNodeProperties::ApplyChanges()
       auto bp = _nodewidget->GetWidgetBlueprint()->GetBlueprint();
       std::lock_guard lock(bp->GetLockMutex());
       node->SetEnabled(bp->GetRoot(), _ui->_enabled->isChecked());
+      _nodewidget->GetWidgetBlueprint()->UpdateProgram();
     }
 
   _nodewidget->GetWidgetBlueprint()->SetDirty(true);
@@ -71,6 +71,7 @@ WidgetNode::WidgetNode(QWidget * parent, std::shared_ptr<fmsynth::Node> node, bo
                 auto bp = GetWidgetBlueprint()->GetBlueprint();
                 std::lock_guard lock(bp->GetLockMutex());
                 _node->SetEnabled(bp->GetRoot(), _ui_node->_enabled->isChecked());
+                GetWidgetBlueprint()->UpdateProgram();
               }
           });
 
@@ -191,7 +192,11 @@ void WidgetNode::SetNodeId(const std::string & id)
 {
   auto node = GetNode();
   if(node)
-    node->SetId(id);
+    {
+      auto bp = GetWidgetBlueprint()->GetBlueprint();
+      std::lock_guard lock(bp->GetLockMutex());
+      bp->SetNodeId(node, id);
+    }
   else
     _editor_only_node_id = id;
   UpdateNodeId();
@@ -221,6 +226,12 @@ WidgetBlueprint * WidgetNode::GetWidgetBlueprint() const
 }
 
 
+void WidgetNode::PostParameterChange(const fmsynth::ParameterChange & change, bool changes_range)
+{
+  GetWidgetBlueprint()->PostParameterChange(change, changes_range);
+}
+
+
 void WidgetNode::SetIsMultiInput(fmsynth::Node::Channel channel)
 {
   QWidget * w = nullptr;
@@ -13,7 +13,9 @@
 */
 
 #include "Node.hh"
+#include "ParameterChange.hh"
 #include "Ui.hh"
+#include <type_traits>
 #include <json11.hpp>
 #include "QtIncludeBegin.hh"
 #include <QtWidgets/QWidget>
@@ -72,6 +74,27 @@ protected:
   void SetConnectorsRangesRecursively();
 
   void ListenWidgetChanges(const std::vector<QWidget *> & widgets);
+
+  // Calls the setter of the node, through the audio thread if the blueprint is being played:
+  template<auto Setter, typename NodeType, typename ... Values> void SetNodeParameter(NodeType * node, Values ... values)
+  {
+    PostParameterChange(fmsynth::ParameterChange::Make<Setter>(node, values ...));
+  }
+  // SetNodeParameter() only if the value differs from the last value, which is the value last posted to the node or read from it.
+  // The changes_range is true if the new value gives the node another output range, see WidgetBlueprint::PostParameterChange():
+  template<auto Setter, typename NodeType, typename Value> void SetNodeParameterIfChanged(NodeType * node, Value & last, Value value, bool changes_range = false)
+  {
+    if constexpr(std::is_floating_point_v<Value>)
+      {
+        if(!(value < last) && !(value > last))
+          return;
+      }
+    else if(value == last)
+      return;
+    last = value;
+    PostParameterChange(fmsynth::ParameterChange::Make<Setter>(node, value), changes_range);
+  }
+  void PostParameterChange(const fmsynth::ParameterChange & change, bool changes_range = false);
   
 private:
   std::shared_ptr<fmsynth::Node> _node;
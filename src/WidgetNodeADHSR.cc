@@ -23,7 +23,13 @@
 WidgetNodeADHSR::WidgetNodeADHSR(QWidget * parent)
   : WidgetNode(parent, std::make_shared<fmsynth::NodeADHSR>(), true, true),
     _node_adhsr(dynamic_cast<fmsynth::NodeADHSR *>(GetNode())),
-    _ui_node_adhsr(new Ui::NodeADHSR)
+    _ui_node_adhsr(new Ui::NodeADHSR),
+    _attack_time(_node_adhsr->GetAttackTime()),
+    _decay_time(_node_adhsr->GetDecayTime()),
+    _hold_time(_node_adhsr->GetHoldTime()),
+    _sustain_level(_node_adhsr->GetSustainLevel()),
+    _release_time(_node_adhsr->GetReleaseTime()),
+    _end_action(_node_adhsr->GetEndAction())
 {
   SetNodeType("ADHSR", "ADSR");
   _ui_node->_title->setText("ADHSR envelope");
@@ -65,25 +71,30 @@ WidgetNodeADHSR::WidgetNodeADHSR(QWidget * parent)
 void WidgetNodeADHSR::NodeToWidget()
 {
   WidgetNode::NodeToWidget();
-  _ui_node_adhsr->_attack->setValue(           _node_adhsr->GetAttackTime());
-  _ui_node_adhsr->_decay->setValue(            _node_adhsr->GetDecayTime());
-  _ui_node_adhsr->_hold->setValue(             _node_adhsr->GetHoldTime());
-  _ui_node_adhsr->_sustain->setValue(          _node_adhsr->GetSustainLevel());
-  _ui_node_adhsr->_release->setValue(          _node_adhsr->GetReleaseTime());
-  _ui_node_adhsr->_end_action->setCurrentIndex(static_cast<int>(_node_adhsr->GetEndAction()));
+  _attack_time   = _node_adhsr->GetAttackTime();
+  _decay_time    = _node_adhsr->GetDecayTime();
+  _hold_time     = _node_adhsr->GetHoldTime();
+  _sustain_level = _node_adhsr->GetSustainLevel();
+  _release_time  = _node_adhsr->GetReleaseTime();
+  _end_action    = _node_adhsr->GetEndAction();
+  _ui_node_adhsr->_attack->setValue(           _attack_time);
+  _ui_node_adhsr->_decay->setValue(            _decay_time);
+  _ui_node_adhsr->_hold->setValue(             _hold_time);
+  _ui_node_adhsr->_sustain->setValue(          _sustain_level);
+  _ui_node_adhsr->_release->setValue(          _release_time);
+  _ui_node_adhsr->_end_action->setCurrentIndex(static_cast<int>(_end_action));
 }
 
 
 void WidgetNodeADHSR::WidgetToNode()
 {
   WidgetNode::WidgetToNode();
-  _node_adhsr->Set(_ui_node_adhsr->_attack->value(),
-                   _ui_node_adhsr->_decay->value(),
-                   _ui_node_adhsr->_hold->value(),
-                   _ui_node_adhsr->_sustain->value(),
-                   _ui_node_adhsr->_release->value(),
-                   static_cast<fmsynth::NodeADHSR::EndAction>(_ui_node_adhsr->_end_action->currentIndex())
-                   );
+  SetNodeParameterIfChanged<&fmsynth::NodeADHSR::SetAttackTime>(  _node_adhsr, _attack_time,   _ui_node_adhsr->_attack->value());
+  SetNodeParameterIfChanged<&fmsynth::NodeADHSR::SetDecayTime>(   _node_adhsr, _decay_time,    _ui_node_adhsr->_decay->value());
+  SetNodeParameterIfChanged<&fmsynth::NodeADHSR::SetHoldTime>(    _node_adhsr, _hold_time,     _ui_node_adhsr->_hold->value());
+  SetNodeParameterIfChanged<&fmsynth::NodeADHSR::SetSustainLevel>(_node_adhsr, _sustain_level, _ui_node_adhsr->_sustain->value());
+  SetNodeParameterIfChanged<&fmsynth::NodeADHSR::SetReleaseTime>( _node_adhsr, _release_time,  _ui_node_adhsr->_release->value());
+  SetNodeParameterIfChanged<&fmsynth::NodeADHSR::SetEndAction>(   _node_adhsr, _end_action,    static_cast<fmsynth::NodeADHSR::EndAction>(_ui_node_adhsr->_end_action->currentIndex()));
 }
 
 
@@ -14,11 +14,7 @@
 
 
 #include "WidgetNode.hh"
-
-namespace fmsynth
-{
-  class NodeADHSR;
-}
+#include "NodeADHSR.hh"
 
 class QDoubleSpinBox;
 class QSlider;
@@ -38,6 +34,13 @@ public:
 private:
   fmsynth::NodeADHSR * _node_adhsr;
   Ui::NodeADHSR *      _ui_node_adhsr;
+  // The values last posted to the node, or read from it:
+  double                        _attack_time;
+  double                        _decay_time;
+  double                        _hold_time;
+  double                        _sustain_level;
+  double                        _release_time;
+  fmsynth::NodeADHSR::EndAction _end_action;
 
   void SetSlidersFromSpinboxes();
   void SetSpinboxesFromSliders();
@@ -21,7 +21,8 @@
 WidgetNodeAdd::WidgetNodeAdd(QWidget * parent)
   : WidgetNode(parent, std::make_shared<fmsynth::NodeAdd>(), true, true),
     _node_add(dynamic_cast<fmsynth::NodeAdd *>(GetNode())),
-    _ui_node_add(new Ui::NodeAdd)
+    _ui_node_add(new Ui::NodeAdd),
+    _value(_node_add->GetValue())
 {
   SetNodeType("Add");
   SetIsMultiInput(fmsynth::Node::Channel::Form);
@@ -37,12 +38,13 @@ WidgetNodeAdd::WidgetNodeAdd(QWidget * parent)
 void WidgetNodeAdd::WidgetToNode()
 {
   WidgetNode::WidgetToNode();
-  _node_add->SetValue(_ui_node_add->_value->value());
+  SetNodeParameterIfChanged<&fmsynth::NodeAdd::SetValue>(_node_add, _value, _ui_node_add->_value->value());
 }
 
 
 void WidgetNodeAdd::NodeToWidget()
 {
   WidgetNode::NodeToWidget();
-  _ui_node_add->_value->setValue(_node_add->GetValue());
+  _value = _node_add->GetValue();
+  _ui_node_add->_value->setValue(_value);
 }
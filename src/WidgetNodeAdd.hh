@@ -31,6 +31,7 @@ public:
 private:
   fmsynth::NodeAdd * _node_add;
   Ui::NodeAdd *      _ui_node_add;
+  double             _value; // The value last posted to the node, or read from it.
 };
 
 
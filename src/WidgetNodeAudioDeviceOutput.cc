@@ -67,5 +67,5 @@ void WidgetNodeAudioDeviceOutput::NodeToWidget()
 void WidgetNodeAudioDeviceOutput::WidgetToNode()
 {
   WidgetNode::WidgetToNode();
-  _node_audio_device_output->SetVolume(static_cast<double>(_ui_node_audio_device_output->_volume->value()) / 100.0);
+  SetNodeParameter<&fmsynth::NodeAudioDeviceOutput::SetVolume>(_node_audio_device_output, static_cast<double>(_ui_node_audio_device_output->_volume->value()) / 100.0);
 }
@@ -22,7 +22,9 @@
 WidgetNodeClamp::WidgetNodeClamp(QWidget * parent)
   : WidgetNode(parent, std::make_shared<fmsynth::NodeClamp>(), true, true),
     _node_clamp(dynamic_cast<fmsynth::NodeClamp *>(GetNode())),
-    _ui_node_clamp(new Ui::NodeClamp)
+    _ui_node_clamp(new Ui::NodeClamp),
+    _min(_node_clamp->GetMin()),
+    _max(_node_clamp->GetMax())
 {
   SetNodeType("Clamp");
   _ui_node->_input_amplitude->setVisible(false);
@@ -50,14 +52,20 @@ WidgetNodeClamp::WidgetNodeClamp(QWidget * parent)
 void WidgetNodeClamp::NodeToWidget()
 {
   WidgetNode::NodeToWidget();
-  _ui_node_clamp->_min->setText(QString::number(_node_clamp->GetMin()));
-  _ui_node_clamp->_max->setText(QString::number(_node_clamp->GetMax()));
+  _min = _node_clamp->GetMin();
+  _max = _node_clamp->GetMax();
+  _ui_node_clamp->_min->setText(QString::number(_min));
+  _ui_node_clamp->_max->setText(QString::number(_max));
 }
 
 
 void WidgetNodeClamp::WidgetToNode()
 {
   WidgetNode::WidgetToNode();
-  _node_clamp->SetMin(_ui_node_clamp->_min->text().toDouble());
-  _node_clamp->SetMax(_ui_node_clamp->_max->text().toDouble());
+  auto min = _ui_node_clamp->_min->text().toDouble();
+  auto max = _ui_node_clamp->_max->text().toDouble();
+  auto range = fmsynth::Input::GetValueRange(_min, _max);
+  SetNodeParameterIfChanged<&fmsynth::NodeClamp::SetMin>(_node_clamp, _min, min, fmsynth::Input::GetValueRange(min, _max) != range);
+  range = fmsynth::Input::GetValueRange(_min, _max);
+  SetNodeParameterIfChanged<&fmsynth::NodeClamp::SetMax>(_node_clamp, _max, max, fmsynth::Input::GetValueRange(_min, max) != range);
 }
@@ -14,11 +14,7 @@
 
 
 #include "WidgetNode.hh"
-
-namespace fmsynth
-{
-  class NodeClamp;
-}
+#include "NodeClamp.hh"
 
 
 class WidgetNodeClamp : public WidgetNode
@@ -32,6 +28,9 @@ public:
 private:
   fmsynth::NodeClamp * _node_clamp;
   Ui::NodeClamp *      _ui_node_clamp;
+  // The values last posted to the node, or read from it:
+  double               _min;
+  double               _max;
 };
 
 
@@ -21,7 +21,8 @@
 WidgetNodeConstant::WidgetNodeConstant(QWidget * parent)
   : WidgetNode(parent, std::make_shared<fmsynth::NodeConstant>(), false, true),
     _node_constant(dynamic_cast<fmsynth::NodeConstant *>(GetNode())),
-    _ui_node_constant(new Ui::NodeConstant)
+    _ui_node_constant(new Ui::NodeConstant),
+    _value(_node_constant->GetValue())
 {
   SetNodeType("Constant");
   _ui_node->_input_amplitude->SetIsOptional();
@@ -37,12 +38,15 @@ WidgetNodeConstant::WidgetNodeConstant(QWidget * parent)
 void WidgetNodeConstant::NodeToWidget()
 {
   WidgetNode::NodeToWidget();
-  _ui_node_constant->_constant->SetConstantValue(_node_constant->GetValue());
+  _value = _node_constant->GetValue();
+  _ui_node_constant->_constant->SetConstantValue(_value);
 }
 
 
 void WidgetNodeConstant::WidgetToNode()
 {
   WidgetNode::WidgetToNode();
-  _node_constant->GetValue() = _ui_node_constant->_constant->GetConstantValue();
+  auto value = _ui_node_constant->_constant->GetConstantValue();
+  auto Range = [](const fmsynth::ConstantValue & c) { return fmsynth::Input::GetValueRange(c.GetValue(), c.GetValue()); };
+  SetNodeParameterIfChanged<&fmsynth::NodeConstant::SetValue>(_node_constant, _value, value, Range(value) != Range(_value));
 }
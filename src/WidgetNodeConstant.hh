@@ -14,11 +14,7 @@
 
 
 #include "WidgetNode.hh"
-
-namespace fmsynth
-{
-  class NodeConstant;
-}
+#include "NodeConstant.hh"
 
 
 class WidgetNodeConstant : public WidgetNode
@@ -32,6 +28,7 @@ public:
 private:
   fmsynth::NodeConstant * _node_constant;
   Ui::NodeConstant *      _ui_node_constant;
+  fmsynth::ConstantValue  _value; // The value last posted to the node, or read from it.
 };
 
 
@@ -21,28 +21,49 @@
 WidgetNodeDelay::WidgetNodeDelay(QWidget * parent)
   : WidgetNode(parent, std::make_shared<fmsynth::NodeDelay>(), true, true),
     _node_delay(dynamic_cast<fmsynth::NodeDelay *>(GetNode())),
-    _ui_node_delay(new Ui::NodeDelay)
+    _ui_node_delay(new Ui::NodeDelay),
+    _delay_time(_node_delay->GetDelayTime()),
+    _interpolation(_node_delay->GetInterpolation())
 {
   SetNodeType("Delay");
   _ui_node->_input_amplitude->setVisible(false);
   _ui_node->_input_form->setToolTip("Value in");
+  AddAuxInput();
+  _ui_node->_input_aux->setToolTip("Delay time scale in");
   SetConnectorsRanges();
 
   _ui_node_delay->setupUi(_ui_node->_content);
+  _ui_node_delay->_interpolation->addItem("Linear");
+  _ui_node_delay->_interpolation->addItem("Cubic");
+  _ui_node_delay->_interpolation->addItem("Allpass");
+  // Size the delay line for the longest delay the spinbox allows, so that changing the delay while playing does not allocate:
+  _node_delay->SetMaxDelayTime(_ui_node_delay->_delay->maximum());
   adjustSize();
-  ListenWidgetChanges({ _ui_node_delay->_delay });
+  ListenWidgetChanges({
+      _ui_node_delay->_delay,
+      _ui_node_delay->_interpolation
+    });
 }
 
 
 void WidgetNodeDelay::NodeToWidget()
 {
   WidgetNode::NodeToWidget();
-  _ui_node_delay->_delay->setValue(_node_delay->GetDelayTime());
+  _delay_time    = _node_delay->GetDelayTime();
+  _interpolation = _node_delay->GetInterpolation();
+  if(_delay_time > _ui_node_delay->_delay->maximum())
+    { // A longer delay loaded from a file, the node has already sized its buffer for it:
+      _ui_node_delay->_delay->setMaximum(_delay_time);
+      _node_delay->SetMaxDelayTime(_delay_time);
+    }
+  _ui_node_delay->_delay->setValue(_delay_time);
+  _ui_node_delay->_interpolation->setCurrentIndex(static_cast<int>(_interpolation));
 }
 
 
 void WidgetNodeDelay::WidgetToNode()
 {
   WidgetNode::WidgetToNode();
-  _node_delay->SetDelayTime(_ui_node_delay->_delay->value());
+  SetNodeParameterIfChanged<&fmsynth::NodeDelay::SetDelayTime>(_node_delay, _delay_time, _ui_node_delay->_delay->value());
+  SetNodeParameterIfChanged<&fmsynth::NodeDelay::SetInterpolation>(_node_delay, _interpolation, static_cast<fmsynth::NodeDelay::Interpolation>(_ui_node_delay->_interpolation->currentIndex()));
 }
@@ -14,11 +14,7 @@
 
 
 #include "WidgetNode.hh"
-
-namespace fmsynth
-{
-  class NodeDelay;
-}
+#include "NodeDelay.hh"
 
 
 class WidgetNodeDelay : public WidgetNode
@@ -32,6 +28,9 @@ public:
 private:
   fmsynth::NodeDelay * _node_delay;
   Ui::NodeDelay *      _ui_node_delay;
+  // The values last posted to the node, or read from it:
+  double                            _delay_time;
+  fmsynth::NodeDelay::Interpolation _interpolation;
 };
 
 
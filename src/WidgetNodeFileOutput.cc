@@ -11,8 +11,11 @@
 */
 
 #include "WidgetNodeFileOutput.hh"
+#include "Blueprint.hh"
 #include "NodeFileOutput.hh"
+#include "WidgetBlueprint.hh"
 #include <filesystem>
+#include <mutex>
 #include "QtIncludeBegin.hh"
 #include "UiNode.hh"
 #include "UiNodeFileOutput.hh"
@@ -60,5 +63,12 @@ void WidgetNodeFileOutput::NodeToWidget()
 void WidgetNodeFileOutput::WidgetToNode()
 {
   WidgetNode::WidgetToNode();
-  _node_file_output->SetFilename(_ui_node_file_output->_filename->text().toStdString());
+  auto filename = _ui_node_file_output->_filename->text().toStdString();
+  if(filename == _node_file_output->GetFilename())
+    return;
+
+  // The values of a ParameterChange are trivially copyable, the filename is set while the audio thread is locked out instead:
+  auto bp = GetWidgetBlueprint()->GetBlueprint();
+  std::lock_guard lock(bp->GetLockMutex());
+  _node_file_output->SetFilename(filename);
 }
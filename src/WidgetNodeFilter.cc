@@ -29,7 +29,10 @@ WidgetNodeFilter::WidgetNodeFilter(QWidget * parent, fmsynth::NodeFilter::Type t
   : WidgetNode(parent, std::make_shared<fmsynth::NodeFilter>(), true, true),
     _type(type),
     _node_filter(dynamic_cast<fmsynth::NodeFilter *>(GetNode())),
-    _ui_node_filter(new Ui::NodeFilter)
+    _ui_node_filter(new Ui::NodeFilter),
+    _filter_type(_node_filter->GetFilterType()),
+    _filter_value(_node_filter->GetFilterValue()),
+    _filter_resonance(_node_filter->GetFilterResonance())
 {
   AddAuxInput();
   _ui_node->_input_aux->setToolTip("Filter value in");
@@ -39,6 +42,10 @@ WidgetNodeFilter::WidgetNodeFilter(QWidget * parent, fmsynth::NodeFilter::Type t
 
   _ui_node_filter->_type->addItem("Low pass");
   _ui_node_filter->_type->addItem("High pass");
+  _ui_node_filter->_type->addItem("Resonant low pass");
+  _ui_node_filter->_type->addItem("Resonant high pass");
+  _ui_node_filter->_type->addItem("Band pass");
+  _ui_node_filter->_type->addItem("Notch");
   UpdateFilterType();
 
   connect(_ui_node_filter->_type, QOverload<int>::of(&QComboBox::currentIndexChanged),
@@ -48,6 +55,10 @@ WidgetNodeFilter::WidgetNodeFilter(QWidget * parent, fmsynth::NodeFilter::Type t
               {
               case 0: _type = fmsynth::NodeFilter::Type::LOW_PASS;  break;
               case 1: _type = fmsynth::NodeFilter::Type::HIGH_PASS; break;
+              case 2: _type = fmsynth::NodeFilter::Type::RESONANT_LOW_PASS;  break;
+              case 3: _type = fmsynth::NodeFilter::Type::RESONANT_HIGH_PASS; break;
+              case 4: _type = fmsynth::NodeFilter::Type::BAND_PASS;          break;
+              case 5: _type = fmsynth::NodeFilter::Type::NOTCH;              break;
               }
             UpdateFilterType();
           });
@@ -55,7 +66,8 @@ WidgetNodeFilter::WidgetNodeFilter(QWidget * parent, fmsynth::NodeFilter::Type t
   adjustSize();
   ListenWidgetChanges({
       _ui_node_filter->_type,
-      _ui_node_filter->_value
+      _ui_node_filter->_value,
+      _ui_node_filter->_resonance
     });
 }
 
@@ -63,8 +75,12 @@ WidgetNodeFilter::WidgetNodeFilter(QWidget * parent, fmsynth::NodeFilter::Type t
 void WidgetNodeFilter::NodeToWidget()
 {
   WidgetNode::NodeToWidget();
-  _type = _node_filter->GetFilterType();
-  _ui_node_filter->_value->setValue(_node_filter->GetFilterValue());
+  _filter_type      = _node_filter->GetFilterType();
+  _filter_value     = _node_filter->GetFilterValue();
+  _filter_resonance = _node_filter->GetFilterResonance();
+  _type = _filter_type;
+  _ui_node_filter->_value->setValue(_filter_value);
+  _ui_node_filter->_resonance->setValue(_filter_resonance);
   UpdateFilterType();
 }
 
@@ -72,8 +88,9 @@ void WidgetNodeFilter::NodeToWidget()
 void WidgetNodeFilter::WidgetToNode()
 {
   WidgetNode::WidgetToNode();
-  _node_filter->SetFilterType(_type);
-  _node_filter->SetFilterValue(_ui_node_filter->_value->value());
+  SetNodeParameterIfChanged<&fmsynth::NodeFilter::SetFilterType>(_node_filter, _filter_type, _type);
+  SetNodeParameterIfChanged<&fmsynth::NodeFilter::SetFilterValue>(_node_filter, _filter_value, _ui_node_filter->_value->value());
+  SetNodeParameterIfChanged<&fmsynth::NodeFilter::SetFilterResonance>(_node_filter, _filter_resonance, _ui_node_filter->_resonance->value());
 }
 
 
@@ -92,6 +109,10 @@ std::string WidgetNodeFilter::FilterTypeString(fmsynth::NodeFilter::Type type) c
     {
     case fmsynth::NodeFilter::Type::LOW_PASS:  rv = "LowPass";  break;
     case fmsynth::NodeFilter::Type::HIGH_PASS: rv = "HighPass"; break;
+    case fmsynth::NodeFilter::Type::RESONANT_LOW_PASS:  rv = "ResonantLowPass";  break;
+    case fmsynth::NodeFilter::Type::RESONANT_HIGH_PASS: rv = "ResonantHighPass"; break;
+    case fmsynth::NodeFilter::Type::BAND_PASS:          rv = "BandPass";         break;
+    case fmsynth::NodeFilter::Type::NOTCH:              rv = "Notch";            break;
     }
   return rv;
 }
@@ -101,6 +122,10 @@ fmsynth::NodeFilter::Type WidgetNodeFilter::FilterTypeFromString(const std::stri
 {
   if(string == "LowPass")  return fmsynth::NodeFilter::Type::LOW_PASS;
   if(string == "HighPass") return fmsynth::NodeFilter::Type::HIGH_PASS;
+  if(string == "ResonantLowPass")  return fmsynth::NodeFilter::Type::RESONANT_LOW_PASS;
+  if(string == "ResonantHighPass") return fmsynth::NodeFilter::Type::RESONANT_HIGH_PASS;
+  if(string == "BandPass")         return fmsynth::NodeFilter::Type::BAND_PASS;
+  if(string == "Notch")            return fmsynth::NodeFilter::Type::NOTCH;
   assert(false);
   return fmsynth::NodeFilter::Type::LOW_PASS;
 }
@@ -113,7 +138,24 @@ void WidgetNodeFilter::UpdateFilterType()
     {
     case fmsynth::NodeFilter::Type::LOW_PASS:  sind = 0; break;
     case fmsynth::NodeFilter::Type::HIGH_PASS: sind = 1; break;
+    case fmsynth::NodeFilter::Type::RESONANT_LOW_PASS:  sind = 2; break;
+    case fmsynth::NodeFilter::Type::RESONANT_HIGH_PASS: sind = 3; break;
+    case fmsynth::NodeFilter::Type::BAND_PASS:          sind = 4; break;
+    case fmsynth::NodeFilter::Type::NOTCH:              sind = 5; break;
     }
   _ui_node_filter->_type->setCurrentIndex(sind);
-  SetNodeType("Filter", "Filter" + FilterTypeString(_type));
+  _ui_node_filter->_resonance->setEnabled(_type != fmsynth::NodeFilter::Type::LOW_PASS && _type != fmsynth::NodeFilter::Type::HIGH_PASS);
+
+  // The resonant filters share the icons of the one-pole filters, and the notch the icon of the band pass:
+  std::string icon;
+  switch(_type)
+    {
+    case fmsynth::NodeFilter::Type::LOW_PASS:
+    case fmsynth::NodeFilter::Type::RESONANT_LOW_PASS:  icon = "LowPass";  break;
+    case fmsynth::NodeFilter::Type::HIGH_PASS:
+    case fmsynth::NodeFilter::Type::RESONANT_HIGH_PASS: icon = "HighPass"; break;
+    case fmsynth::NodeFilter::Type::BAND_PASS:
+    case fmsynth::NodeFilter::Type::NOTCH:              icon = "BandPass"; break;
+    }
+  SetNodeType("Filter", "Filter" + icon);
 }
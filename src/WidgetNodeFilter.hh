@@ -32,6 +32,10 @@ private:
   fmsynth::NodeFilter::Type _type;
   fmsynth::NodeFilter *     _node_filter;
   Ui::NodeFilter *          _ui_node_filter;
+  // The values last posted to the node, or read from it:
+  fmsynth::NodeFilter::Type _filter_type;
+  double                    _filter_value;
+  double                    _filter_resonance;
 
   [[nodiscard]] std::string               FilterTypeString(fmsynth::NodeFilter::Type type) const;
   [[nodiscard]] fmsynth::NodeFilter::Type FilterTypeFromString(const std::string & string) const;
@@ -21,7 +21,12 @@
 WidgetNodeGrowth::WidgetNodeGrowth(QWidget * parent)
   : WidgetNode(parent, std::make_shared<fmsynth::NodeGrowth>(), false, true),
     _node_growth(dynamic_cast<fmsynth::NodeGrowth *>(GetNode())),
-    _ui_node_growth(new Ui::NodeGrowth)
+    _ui_node_growth(new Ui::NodeGrowth),
+    _start_value(_node_growth->GetStartValue()),
+    _growth_formula(_node_growth->GetGrowthFormula()),
+    _growth_amount(_node_growth->GetGrowthAmount()),
+    _end_action(_node_growth->GetEndAction()),
+    _end_value(_node_growth->GetEndValue())
 {
   SetNodeType("Growth");
   _ui_node->_input_amplitude->SetIsOptional();
@@ -48,12 +53,17 @@ WidgetNodeGrowth::WidgetNodeGrowth(QWidget * parent)
 void WidgetNodeGrowth::NodeToWidget()
 {
   WidgetNode::NodeToWidget();
-
-  _ui_node_growth->_start_value->SetConstantValue(_node_growth->ParamStartValue());
-  _ui_node_growth->_growth_formula->setCurrentIndex(static_cast<int>(_node_growth->ParamGrowthFormula()));
-  _ui_node_growth->_growth_amount->SetConstantValue(_node_growth->ParamGrowthAmount());
-  _ui_node_growth->_end_action->setCurrentIndex(static_cast<int>(_node_growth->ParamEndAction()));
-  _ui_node_growth->_end_value->SetConstantValue(_node_growth->ParamEndValue());
+  _start_value    = _node_growth->GetStartValue();
+  _growth_formula = _node_growth->GetGrowthFormula();
+  _growth_amount  = _node_growth->GetGrowthAmount();
+  _end_action     = _node_growth->GetEndAction();
+  _end_value      = _node_growth->GetEndValue();
+
+  _ui_node_growth->_start_value->SetConstantValue(_start_value);
+  _ui_node_growth->_growth_formula->setCurrentIndex(static_cast<int>(_growth_formula));
+  _ui_node_growth->_growth_amount->SetConstantValue(_growth_amount);
+  _ui_node_growth->_end_action->setCurrentIndex(static_cast<int>(_end_action));
+  _ui_node_growth->_end_value->SetConstantValue(_end_value);
 
   UpdateUiVisibility();
 }
@@ -62,17 +72,18 @@ void WidgetNodeGrowth::NodeToWidget()
 void WidgetNodeGrowth::WidgetToNode()
 {
   WidgetNode::WidgetToNode();
-  _node_growth->ParamStartValue()    = _ui_node_growth->_start_value->GetConstantValue();
-  _node_growth->ParamGrowthFormula() = static_cast<fmsynth::NodeGrowth::Formula>(_ui_node_growth->_growth_formula->currentIndex());
-  _node_growth->ParamGrowthAmount()  = _ui_node_growth->_growth_amount->GetConstantValue();
-  _node_growth->ParamEndAction()     = static_cast<fmsynth::NodeGrowth::EndAction>(_ui_node_growth->_end_action->currentIndex());
-  _node_growth->ParamEndValue()      = _ui_node_growth->_end_value->GetConstantValue();
+  SetNodeParameterIfChanged<&fmsynth::NodeGrowth::SetStartValue>(   _node_growth, _start_value,    _ui_node_growth->_start_value->GetConstantValue());
+  SetNodeParameterIfChanged<&fmsynth::NodeGrowth::SetGrowthFormula>(_node_growth, _growth_formula, static_cast<fmsynth::NodeGrowth::Formula>(_ui_node_growth->_growth_formula->currentIndex()));
+  SetNodeParameterIfChanged<&fmsynth::NodeGrowth::SetGrowthAmount>( _node_growth, _growth_amount,  _ui_node_growth->_growth_amount->GetConstantValue());
+  SetNodeParameterIfChanged<&fmsynth::NodeGrowth::SetEndAction>(    _node_growth, _end_action,     static_cast<fmsynth::NodeGrowth::EndAction>(_ui_node_growth->_end_action->currentIndex()));
+  SetNodeParameterIfChanged<&fmsynth::NodeGrowth::SetEndValue>(     _node_growth, _end_value,      _ui_node_growth->_end_value->GetConstantValue());
 }
 
 
 void WidgetNodeGrowth::UpdateUiVisibility()
 {
-  switch(_node_growth->ParamGrowthFormula())
+  // The widgets are read instead of the node, the changes may not have been applied to the node yet:
+  switch(static_cast<fmsynth::NodeGrowth::Formula>(_ui_node_growth->_growth_formula->currentIndex()))
     {
     case fmsynth::NodeGrowth::Formula::Linear:      _ui_node_growth->_growth_amount_label->setText("Growth / s"); break;
     case fmsynth::NodeGrowth::Formula::Logistic:    _ui_node_growth->_growth_amount_label->setText("Maximum");    break;
@@ -80,7 +91,7 @@ void WidgetNodeGrowth::UpdateUiVisibility()
     }
 
   bool end_value_visible = false;
-  switch(_node_growth->ParamEndAction())
+  switch(static_cast<fmsynth::NodeGrowth::EndAction>(_ui_node_growth->_end_action->currentIndex()))
     {
     case fmsynth::NodeGrowth::EndAction::NoEnd:                                      break;
     case fmsynth::NodeGrowth::EndAction::RepeatLast:       end_value_visible = true; break;
@@ -14,11 +14,7 @@
 
 
 #include "WidgetNode.hh"
-
-namespace fmsynth
-{
-  class NodeGrowth;
-}
+#include "NodeGrowth.hh"
 
 
 class WidgetNodeGrowth : public WidgetNode
@@ -30,8 +26,14 @@ public:
   void   WidgetToNode() override;
 
 private:
-  fmsynth::NodeGrowth * _node_growth;
-  Ui::NodeGrowth *      _ui_node_growth;
+  fmsynth::NodeGrowth *          _node_growth;
+  Ui::NodeGrowth *               _ui_node_growth;
+  // The values last posted to the node, or read from it:
+  fmsynth::ConstantValue         _start_value;
+  fmsynth::NodeGrowth::Formula   _growth_formula;
+  fmsynth::ConstantValue         _growth_amount;
+  fmsynth::NodeGrowth::EndAction _end_action;
+  fmsynth::ConstantValue         _end_value;
 
   void UpdateUiVisibility();
 };
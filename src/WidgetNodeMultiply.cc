@@ -21,7 +21,8 @@
 WidgetNodeMultiply::WidgetNodeMultiply(QWidget * parent)
   : WidgetNode(parent, std::make_shared<fmsynth::NodeMultiply>(), true, true),
     _node_multiply(dynamic_cast<fmsynth::NodeMultiply *>(GetNode())),
-    _ui_node_multiply(new Ui::NodeMultiply)
+    _ui_node_multiply(new Ui::NodeMultiply),
+    _multiplier(_node_multiply->GetMultiplier())
 {
   SetNodeType("Multiply");
   SetIsMultiInput(fmsynth::Node::Channel::Amplitude);
@@ -39,12 +40,13 @@ WidgetNodeMultiply::WidgetNodeMultiply(QWidget * parent)
 void WidgetNodeMultiply::NodeToWidget()
 {
   WidgetNode::NodeToWidget();
-  _ui_node_multiply->_value->setValue(_node_multiply->GetMultiplier());
+  _multiplier = _node_multiply->GetMultiplier();
+  _ui_node_multiply->_value->setValue(_multiplier);
 }
 
 
 void WidgetNodeMultiply::WidgetToNode()
 {
   WidgetNode::WidgetToNode();
-  _node_multiply->SetMultiplier(_ui_node_multiply->_value->value());
+  SetNodeParameterIfChanged<&fmsynth::NodeMultiply::SetMultiplier>(_node_multiply, _multiplier, _ui_node_multiply->_value->value());
 }
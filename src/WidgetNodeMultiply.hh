@@ -32,6 +32,7 @@ public:
 private:
   fmsynth::NodeMultiply * _node_multiply;
   Ui::NodeMultiply *      _ui_node_multiply;
+  double                  _multiplier; // The value last posted to the node, or read from it.
 };
 
 
@@ -23,7 +23,11 @@ WidgetNodeOscillator::WidgetNodeOscillator(QWidget * parent, fmsynth::NodeOscill
   : WidgetNode(parent, std::make_shared<fmsynth::NodeOscillator>(), true, true),
     _type(type),
     _node_oscillator(dynamic_cast<fmsynth::NodeOscillator *>(GetNode())),
-    _ui_node_oscillator(new Ui::NodeOscillator)
+    _ui_node_oscillator(new Ui::NodeOscillator),
+    _oscillator_type(_node_oscillator->GetType()),
+    _pulse_duty_cycle(_node_oscillator->GetPulseDutyCycle()),
+    _phase_accumulator(_node_oscillator->IsPhaseAccumulator()),
+    _wavetable(_node_oscillator->IsWavetable())
 {
   _ui_node->_input_aux->setToolTip("Pulse duty cycle");
   SetConnectorsRanges();
@@ -54,7 +58,9 @@ WidgetNodeOscillator::WidgetNodeOscillator(QWidget * parent, fmsynth::NodeOscill
   adjustSize();
   ListenWidgetChanges({
       _ui_node_oscillator->_type,
-      _ui_node_oscillator->_pulse_duty_cycle
+      _ui_node_oscillator->_pulse_duty_cycle,
+      _ui_node_oscillator->_phase_accumulator,
+      _ui_node_oscillator->_wavetable
     });
 }
 
@@ -62,16 +68,24 @@ WidgetNodeOscillator::WidgetNodeOscillator(QWidget * parent, fmsynth::NodeOscill
 void WidgetNodeOscillator::WidgetToNode()
 {
   WidgetNode::WidgetToNode();
-  _node_oscillator->SetType(_type);
-  _node_oscillator->SetPulseDutyCycle(_ui_node_oscillator->_pulse_duty_cycle->value());
+  SetNodeParameterIfChanged<&fmsynth::NodeOscillator::SetType>(_node_oscillator, _oscillator_type, _type);
+  SetNodeParameterIfChanged<&fmsynth::NodeOscillator::SetPulseDutyCycle>(_node_oscillator, _pulse_duty_cycle, _ui_node_oscillator->_pulse_duty_cycle->value());
+  SetNodeParameterIfChanged<&fmsynth::NodeOscillator::SetPhaseAccumulator>(_node_oscillator, _phase_accumulator, _ui_node_oscillator->_phase_accumulator->isChecked());
+  SetNodeParameterIfChanged<&fmsynth::NodeOscillator::SetWavetable>(_node_oscillator, _wavetable, _ui_node_oscillator->_wavetable->isChecked());
 }
 
 
 void WidgetNodeOscillator::NodeToWidget()
 {
   WidgetNode::NodeToWidget();
-  _type = _node_oscillator->GetType();
-  _ui_node_oscillator->_pulse_duty_cycle->setValue(_node_oscillator->GetPulseDutyCycle());
+  _oscillator_type   = _node_oscillator->GetType();
+  _pulse_duty_cycle  = _node_oscillator->GetPulseDutyCycle();
+  _phase_accumulator = _node_oscillator->IsPhaseAccumulator();
+  _wavetable         = _node_oscillator->IsWavetable();
+  _type = _oscillator_type;
+  _ui_node_oscillator->_pulse_duty_cycle->setValue(_pulse_duty_cycle);
+  _ui_node_oscillator->_phase_accumulator->setChecked(_phase_accumulator);
+  _ui_node_oscillator->_wavetable->setChecked(_wavetable);
   UpdateOscillatorType();
 }
 
@@ -30,6 +30,11 @@ private:
   fmsynth::NodeOscillator::Type _type;
   fmsynth::NodeOscillator *     _node_oscillator;
   Ui::NodeOscillator *          _ui_node_oscillator;
+  // The values last posted to the node, or read from it:
+  fmsynth::NodeOscillator::Type _oscillator_type;
+  double                        _pulse_duty_cycle;
+  bool                          _phase_accumulator;
+  bool                          _wavetable;
 
   [[nodiscard]] std::string                   OscillatorTypeString(fmsynth::NodeOscillator::Type type) const;
   [[nodiscard]] fmsynth::NodeOscillator::Type OscillatorTypeFromString(const std::string & string) const;
@@ -23,7 +23,9 @@
 WidgetNodeRangeConvert::WidgetNodeRangeConvert(QWidget * parent)
   : WidgetNode(parent, std::make_shared<fmsynth::NodeRangeConvert>(), true, true),
     _node_rangeconvert(dynamic_cast<fmsynth::NodeRangeConvert *>(GetNode())),
-    _ui_node_rangeconvert(new Ui::NodeRangeConvert)
+    _ui_node_rangeconvert(new Ui::NodeRangeConvert),
+    _from(_node_rangeconvert->GetFrom()),
+    _to(_node_rangeconvert->GetTo())
 {
   SetNodeType("RangeConvert");
   _ui_node->_title->setText("Range convert");
@@ -85,12 +87,12 @@ void WidgetNodeRangeConvert::UpdateRange(QWidget * custom, int index)
 void WidgetNodeRangeConvert::NodeToWidget()
 {
   WidgetNode::NodeToWidget();
-  auto & from = _node_rangeconvert->GetFrom();
-  _ui_node_rangeconvert->_customfrom_min->setText(QString::number(from.GetMin()));
-  _ui_node_rangeconvert->_customfrom_max->setText(QString::number(from.GetMax()));
-  auto & to = _node_rangeconvert->GetTo();
-  _ui_node_rangeconvert->_customto_min->setText(QString::number(to.GetMin()));
-  _ui_node_rangeconvert->_customto_max->setText(QString::number(to.GetMax()));
+  _from = _node_rangeconvert->GetFrom();
+  _ui_node_rangeconvert->_customfrom_min->setText(QString::number(_from.GetMin()));
+  _ui_node_rangeconvert->_customfrom_max->setText(QString::number(_from.GetMax()));
+  _to = _node_rangeconvert->GetTo();
+  _ui_node_rangeconvert->_customto_min->setText(QString::number(_to.GetMin()));
+  _ui_node_rangeconvert->_customto_max->setText(QString::number(_to.GetMax()));
 }
 
 
@@ -126,8 +128,10 @@ void WidgetNodeRangeConvert::WidgetToNode()
   
   auto from = GetRange(_ui_node_rangeconvert->_from, _ui_node_rangeconvert->_customfrom_min, _ui_node_rangeconvert->_customfrom_max);
   auto to   = GetRange(_ui_node_rangeconvert->_to,   _ui_node_rangeconvert->_customto_min,   _ui_node_rangeconvert->_customto_max);
-  _node_rangeconvert->SetFrom(from);
-  _node_rangeconvert->SetTo(to);
+  // The output range of the node is the range converted to:
+  auto Range = [](const fmsynth::Range & range) { return fmsynth::Input::GetValueRange(range.GetMin(), range.GetMax()); };
+  SetNodeParameterIfChanged<&fmsynth::NodeRangeConvert::SetFrom>(_node_rangeconvert, _from, from);
+  SetNodeParameterIfChanged<&fmsynth::NodeRangeConvert::SetTo>(_node_rangeconvert, _to, to, Range(to) != Range(_to));
 }
 
 
@@ -14,11 +14,7 @@
 
 
 #include "WidgetNode.hh"
-
-namespace fmsynth
-{
-  class NodeRangeConvert;
-}
+#include "NodeRangeConvert.hh"
 
 
 class WidgetNodeRangeConvert : public WidgetNode
@@ -35,6 +31,9 @@ public:
 private:
   fmsynth::NodeRangeConvert * _node_rangeconvert;
   Ui::NodeRangeConvert *      _ui_node_rangeconvert;
+  // The ranges last posted to the node, or read from it:
+  fmsynth::Range              _from;
+  fmsynth::Range              _to;
 
   void UpdateRange(QWidget * custom, int index);
 };
@@ -47,5 +47,5 @@ void WidgetNodeTimeScale::NodeToWidget()
 void WidgetNodeTimeScale::WidgetToNode()
 {
   WidgetNode::WidgetToNode();
-  _node_timescale->SetScale(_ui_node_timescale->_scale->value());
+  SetNodeParameter<&fmsynth::NodeTimeScale::SetScale>(_node_timescale, _ui_node_timescale->_scale->value());
 }
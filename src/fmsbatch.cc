@@ -0,0 +1,345 @@
+/*
+  libfmsynth
+  Copyright (C) 2021-2025  Steve Joni Yrjänä <joniyrjana@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Complete license can be found in the LICENSE file.
+*/
+
+#include "Blueprint.hh"
+#include "StdFormat.hh"
+#include "ThreadPool.hh"
+#include "Util.hh"
+#include "WavWriter.hh"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <vector>
+#include <cxxopts.hpp>
+
+
+struct Job
+{
+  std::string  filename;
+  std::string  output_filename;
+  unsigned int samples_per_second;
+};
+
+
+struct Result
+{
+  bool        ok           = false;
+  bool        finished     = false; // False if the blueprint was stopped at the maximum time.
+  std::string error;
+  size_t      frames       = 0;
+  double      load_time    = 0;
+  double      render_time  = 0;
+};
+
+
+struct Configuration
+{
+  bool                       verbose;
+  unsigned int               samples_per_second;
+  fmsynth::WavWriter::Format format;
+  std::string                output_directory;
+  unsigned int               threads;
+  double                     max_time;
+  std::vector<Job>           jobs;
+};
+
+
+// Matches the wildcards * and ? of the pattern:
+static bool IsMatch(const std::string & pattern, const std::string & name)
+{
+  size_t p = 0;
+  size_t n = 0;
+  size_t star = std::string::npos;
+  size_t star_n = 0;
+  while(n < name.size())
+    if(p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n]))
+      {
+        p++;
+        n++;
+      }
+    else if(p < pattern.size() && pattern[p] == '*')
+      {
+        star = p++;
+        star_n = n;
+      }
+    else if(star != std::string::npos)
+      {
+        p = star + 1;
+        n = ++star_n;
+      }
+    else
+      return false;
+  while(p < pattern.size() && pattern[p] == '*')
+    p++;
+  return p == pattern.size();
+}
+
+
+// The output goes next to the input, or into the output directory, with the extension changed to .wav:
+static std::string GetOutputFilename(const std::string & filename, const std::string & output_directory)
+{
+  std::filesystem::path fn{filename};
+  fn.replace_extension("wav");
+  if(!output_directory.empty())
+    fn = std::filesystem::path{output_directory} / fn.filename();
+  return fn.string();
+}
+
+
+// A directory adds all the .sbp files in it, and a filename with wildcards adds the files it matches:
+static bool AddFiles(const std::string & argument, std::vector<std::string> & filenames)
+{
+  std::filesystem::path path{argument};
+  std::error_code error;
+  std::vector<std::string> found;
+  if(std::filesystem::is_directory(path, error))
+    {
+      for(const auto & entry : std::filesystem::directory_iterator(path, error))
+        if(entry.is_regular_file() && entry.path().extension() == ".sbp")
+          found.push_back(entry.path().string());
+    }
+  else if(path.filename().string().find_first_of("*?") != std::string::npos)
+    {
+      auto directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path{"."};
+      for(const auto & entry : std::filesystem::directory_iterator(directory, error))
+        if(entry.is_regular_file() && IsMatch(path.filename().string(), entry.path().filename().string()))
+          found.push_back(entry.path().string());
+    }
+  else
+    found.push_back(argument);
+
+  if(error)
+    {
+      std::cerr << "Error, failed to read '" << argument << "': " << error.message() << "\n";
+      return false;
+    }
+  std::sort(found.begin(), found.end());
+  filenames.insert(filenames.end(), found.cbegin(), found.cend());
+  return true;
+}
+
+
+// Each line of the manifest has an input file, and optionally the output file and the samples per second.
+// The paths are relative to the directory of the manifest, empty lines and lines starting with # are skipped:
+static bool LoadManifest(const std::string & manifest, const Configuration & config, std::vector<Job> & jobs)
+{
+  std::ifstream file(manifest);
+  if(!file)
+    {
+      std::cerr << "Error, failed to open the manifest '" << manifest << "'.\n";
+      return false;
+    }
+
+  auto directory = std::filesystem::path{manifest}.parent_path();
+  std::string line;
+  for(unsigned int linenumber = 1; std::getline(file, line); linenumber++)
+    {
+      std::istringstream fields(line);
+      std::string input;
+      if(!(fields >> input) || input[0] == '#')
+        continue;
+
+      Job job { (directory / input).string(), "", config.samples_per_second };
+      std::string output;
+      if(fields >> output)
+        job.output_filename = (directory / output).string();
+      else
+        job.output_filename = GetOutputFilename(job.filename, config.output_directory);
+      if(!(fields >> std::ws).eof() && !(fields >> job.samples_per_second))
+        {
+          std::cerr << "Error, " << manifest << ":" << linenumber << ": the samples per second is not a number.\n";
+          return false;
+        }
+      jobs.push_back(job);
+    }
+  return true;
+}
+
+
+static std::optional<Configuration> ParseCommandline(int argc, char * argv[])
+{
+  Configuration rv;
+
+  cxxopts::Options options(argv[0], format("fmsbatch v{}\nWrite many .sbp files to .wav files at once.", PACKAGE_VERSION));
+  options.custom_help("[OPTION...] <filename|directory|pattern>...");
+  options.add_options()
+    ("v,verbose",            "Verbose mode.",           cxxopts::value<bool>()->default_value("false"))
+    ("s,samples-per-second", "Set samples per second.", cxxopts::value<unsigned int>()->default_value("44100"))
+    ("f,format",             "Sample format of the output: pcm16, pcm24 or float32.", cxxopts::value<std::string>()->default_value("pcm16"))
+    ("j,threads",            "Write this many files at once, 0 uses all the cores.", cxxopts::value<unsigned int>()->default_value("0"))
+    ("t,max-time",           "Stop the blueprints which have not finished after this many seconds.", cxxopts::value<double>()->default_value("60"))
+    ("m,manifest",           "Read the files from a manifest, each line has: input.sbp [output.wav [samples-per-second]]", cxxopts::value<std::string>())
+    ("o,output-directory",   "Write the files into this directory instead of next to the input files.", cxxopts::value<std::string>())
+    ("i,input",              "Input filenames.sbp, directories of them, or filename patterns with * and ?.", cxxopts::value<std::vector<std::string>>())
+    ("h,help",               "Print help (this text).")
+    ;
+  options.parse_positional({"input"});
+  auto cmdline = options.parse(argc, argv);
+
+  rv.verbose            = cmdline["verbose"].as<bool>();
+  rv.samples_per_second = cmdline["samples-per-second"].as<unsigned int>();
+  rv.threads            = cmdline["threads"].as<unsigned int>();
+  rv.max_time           = cmdline["max-time"].as<double>();
+
+  if(cmdline.count("help"))
+    {
+      std::cerr << options.help() << std::endl;
+      return std::nullopt;
+    }
+
+  auto format = fmsynth::WavWriter::GetFormatByName(cmdline["format"].as<std::string>());
+  if(!format.has_value())
+    {
+      std::cerr << argv[0] << ": Error, unknown format '" << cmdline["format"].as<std::string>() << "'.\n";
+      return std::nullopt;
+    }
+  rv.format             = format.value();
+
+  if(cmdline.count("output-directory") > 0)
+    rv.output_directory = cmdline["output-directory"].as<std::string>();
+
+  if(cmdline.count("manifest") > 0)
+    if(!LoadManifest(cmdline["manifest"].as<std::string>(), rv, rv.jobs))
+      return std::nullopt;
+
+  if(cmdline.count("input") > 0)
+    {
+      std::vector<std::string> filenames;
+      for(const auto & argument : cmdline["input"].as<std::vector<std::string>>())
+        if(!AddFiles(argument, filenames))
+          return std::nullopt;
+      for(const auto & filename : filenames)
+        rv.jobs.push_back(Job { filename, GetOutputFilename(filename, rv.output_directory), rv.samples_per_second });
+    }
+
+  if(rv.jobs.empty())
+    {
+      std::cerr << argv[0] << ": Error, no input files set.\n";
+      std::cerr << options.help() << std::endl;
+      return std::nullopt;
+    }
+
+  return rv;
+}
+
+
+static Result Write(const Job & job, const Configuration & config)
+{
+  Result rv;
+  std::chrono::steady_clock clock;
+  auto t_start = clock.now();
+
+  auto [json, error] = fmsynth::util::LoadJsonFile(job.filename);
+  if(!json)
+    {
+      rv.error = error;
+      return rv;
+    }
+  fmsynth::Blueprint blueprint{};
+  bool loadok = blueprint.Load(*json);
+  delete json;
+  if(!loadok)
+    {
+      rv.error = "failed to load the blueprint";
+      return rv;
+    }
+  if(blueprint.GetNodesByType("AudioDeviceOutput").empty())
+    {
+      rv.error = "no AudioDeviceOutput nodes present in the blueprint";
+      return rv;
+    }
+  blueprint.SetSamplesPerSecond(job.samples_per_second);
+  blueprint.SetBlockSize(fmsynth::Blueprint::MaxBlockSize);
+
+  auto t_loaded = clock.now();
+  rv.load_time = std::chrono::duration<double>(t_loaded - t_start).count();
+
+  fmsynth::WavWriter output_file{};
+  if(!output_file.Open(job.output_filename, job.samples_per_second, 1, config.format))
+    {
+      rv.error = format("failed to open '{}' for writing", job.output_filename);
+      return rv;
+    }
+
+  // Render and write one buffer at a time, the memory use does not depend on the length of the output:
+  auto max_frames = static_cast<size_t>(config.max_time * job.samples_per_second);
+  std::vector<double> buffer(fmsynth::Blueprint::MaxBlockSize);
+  while(!blueprint.IsFinished() && rv.frames < max_frames)
+    {
+      auto frames = blueprint.Render(buffer.data(), std::min(buffer.size(), max_frames - rv.frames));
+      output_file.Write(buffer.data(), frames);
+      rv.frames += frames;
+    }
+  rv.finished = blueprint.IsFinished();
+
+  if(!output_file.Close())
+    {
+      rv.error = format("failed to write '{}'", job.output_filename);
+      return rv;
+    }
+
+  rv.render_time = std::chrono::duration<double>(clock.now() - t_loaded).count();
+  rv.ok = true;
+  return rv;
+}
+
+
+int main(int argc, char * argv[])
+{
+  auto cmdconf = ParseCommandline(argc, argv);
+  if(!cmdconf.has_value())
+    return EXIT_FAILURE;
+  auto config = cmdconf.value();
+
+  // Each thread writes one file at a time, the wavetables are built once and shared by all the files:
+  fmsynth::ThreadPool pool(config.threads);
+  if(config.verbose)
+    std::cout << argv[0] << ": Writing " << config.jobs.size() << " files in " << pool.GetThreadCount() << " threads" << std::endl;
+
+  std::vector<Result> results(config.jobs.size());
+  std::chrono::steady_clock clock;
+  auto t_start = clock.now();
+  pool.Run(static_cast<unsigned int>(config.jobs.size()), [&config, &results](unsigned int i) { results[i] = Write(config.jobs[i], config); });
+  auto t = std::chrono::duration<double>(clock.now() - t_start).count();
+
+  unsigned int failed = 0;
+  double audio_time = 0;
+  for(size_t i = 0; i < results.size(); i++)
+    {
+      const auto & job = config.jobs[i];
+      const auto & result = results[i];
+      if(!result.ok)
+        {
+          failed++;
+          std::cerr << argv[0] << ": Error, '" << job.filename << "': " << result.error << ".\n";
+          continue;
+        }
+
+      auto seconds = static_cast<double>(result.frames) / job.samples_per_second;
+      audio_time += seconds;
+      if(!result.finished)
+        std::cerr << argv[0] << ": Warning, '" << job.filename << "' did not finish, it was stopped after " << config.max_time << "s.\n";
+      std::cout << argv[0] << ": '" << job.filename << "' -> '" << job.output_filename << "': " << seconds << "s of audio, load "
+                << result.load_time << "s, render " << result.render_time << "s, "
+                << seconds / std::max(result.render_time, 0.000001) << "x real time" << std::endl;
+    }
+
+  std::cout << argv[0] << ": Wrote " << results.size() - failed << " files, " << failed << " failed, "
+            << audio_time << "s of audio in " << t << "s, " << audio_time / std::max(t, 0.000001) << "x real time" << std::endl;
+
+  return failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
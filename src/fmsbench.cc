@@ -11,10 +11,18 @@
 */
 
 #include "Blueprint.hh"
+#include "ChunkedRenderer.hh"
+#include "Kernels.hh"
 #include "StdFormat.hh"
+#include "ThreadPool.hh"
 #include "Util.hh"
+#include "VoiceEngine.hh"
+#include "Wavetable.hh"
+#include <algorithm>
+#include <memory>
 #include <optional>
 #include <iostream>
+#include <vector>
 #include <cxxopts.hpp>
 
 
@@ -23,6 +31,13 @@ struct Configuration
   std::string  filename;
   double       time;
   unsigned int samples_per_second;
+  unsigned int block_size;
+  unsigned int control_period;
+  std::string  isa;
+  bool         load_scaling;
+  unsigned int voices;
+  unsigned int threads;
+  bool         time_parallel;
 };
 
 
@@ -36,11 +51,25 @@ static std::optional<Configuration> ParseCommandline(int argc, char * argv[])
     ("h,help",               "Print help (this text).")
     ("s,samples-per-second", "Set samples per second.", cxxopts::value<unsigned int>()->default_value("44100"))
     ("t,time",               "Set playback time in seconds.", cxxopts::value<double>()->default_value("300"))
+    ("b,block-size",         "Render in blocks of this many frames, 0 ticks one frame at a time.", cxxopts::value<unsigned int>()->default_value("256"))
+    ("c,control-period",     "Run the slowly varying modulating nodes once every this many frames when rendering in blocks.", cxxopts::value<unsigned int>()->default_value("1"))
+    ("j,threads",            "Run the independent nodes in this many threads when rendering in blocks, 0 uses all the cores.", cxxopts::value<unsigned int>()->default_value("1"))
+    ("p,time-parallel",      "Render consecutive chunks of time in the threads instead of the independent nodes, when the output depends on a limited history.")
+    ("v,voices",             "Play this many voices of the blueprint at once, triggering the voices again when they finish.", cxxopts::value<unsigned int>()->default_value("0"))
+    ("l,load-scaling",       "Benchmark loading generated blueprints of 1000 to 100000 nodes instead of a file.")
+    ("i,isa",                "Set the instruction set of the oscillator kernels: Reference, Generic, SSE2, AVX2, or AVX512.", cxxopts::value<std::string>()->default_value(fmsynth::kernels::IsaToName(fmsynth::kernels::GetBestIsa())))
     ;
 
   auto cmdline = options.parse(argc, argv);
   rv.samples_per_second = cmdline["samples-per-second"].as<unsigned int>();
   rv.time               = cmdline["time"].as<double>();
+  rv.block_size         = cmdline["block-size"].as<unsigned int>();
+  rv.control_period     = std::max(cmdline["control-period"].as<unsigned int>(), 1u);
+  rv.isa                = cmdline["isa"].as<std::string>();
+  rv.load_scaling       = cmdline.count("load-scaling") > 0;
+  rv.voices             = cmdline["voices"].as<unsigned int>();
+  rv.threads            = cmdline["threads"].as<unsigned int>();
+  rv.time_parallel      = cmdline.count("time-parallel") > 0;
 
   if(cmdline.count("help"))
     {
@@ -51,7 +80,7 @@ static std::optional<Configuration> ParseCommandline(int argc, char * argv[])
   if(argc >= 2)
     rv.filename = argv[1];
   
-  if(rv.filename.length() == 0)
+  if(rv.filename.length() == 0 && !rv.load_scaling)
     {
       std::cerr << argv[0] << ": Error, missing filename.\n";
       std::cerr << options.help() << std::endl;
@@ -62,6 +91,111 @@ static std::optional<Configuration> ParseCommandline(int argc, char * argv[])
 }
 
 
+// A chain of Add nodes starting from a Constant, each node takes its input from the four previous nodes:
+static json11::Json GenerateBlueprint(unsigned int node_count)
+{
+  const unsigned int inputs = 4;
+  json11::Json::array nodes;
+  json11::Json::array links;
+  for(unsigned int i = 0; i < node_count; i++)
+    {
+      auto id = std::to_string(i + 1);
+      if(i == 0)
+        nodes.push_back(json11::Json::object {
+            { "node_id",   id         },
+            { "node_type", "Constant" },
+            { "enabled",   true       },
+            { "constant",  json11::Json::object { { "value", 1 }, { "unit", 0 } } }
+          });
+      else
+        nodes.push_back(json11::Json::object {
+            { "node_id",   id    },
+            { "node_type", "Add" },
+            { "enabled",   true  }
+          });
+
+      for(unsigned int j = 1; j <= inputs && j <= i; j++)
+        links.push_back(json11::Json::object {
+            { "from",       std::to_string(i + 1 - j) },
+            { "to",         id                        },
+            { "to_channel", "Form"                    }
+          });
+    }
+  return json11::Json::object { { "nodes", nodes }, { "links", links } };
+}
+
+
+static void BenchmarkLoadScaling(const char * program_name)
+{
+  std::chrono::steady_clock clock;
+  for(unsigned int node_count : { 1000u, 10000u, 100000u })
+    {
+      auto json = GenerateBlueprint(node_count);
+
+      auto t_start = clock.now();
+      fmsynth::Blueprint blueprint;
+      [[maybe_unused]] auto loadok = blueprint.Load(json);
+      auto t = std::chrono::duration<double>(clock.now() - t_start).count();
+
+      std::cout << program_name << ": Load " << node_count << " nodes, " << json["links"].array_items().size() << " links: " << t << "s, "
+                << t / node_count * 1000000.0 << "us per node" << std::endl;
+    }
+}
+
+
+// Returns false if the output of the blueprint depends on all of its history:
+static bool BenchmarkTimeParallel(const char * program_name, const json11::Json & json, const Configuration & config)
+{
+  fmsynth::ThreadPool pool(config.threads);
+  fmsynth::ChunkedRenderer renderer(pool);
+  if(!renderer.Load(json, config.samples_per_second))
+    return false;
+
+  auto totalsamples = static_cast<size_t>(config.time * config.samples_per_second);
+  std::vector<double> buffer(renderer.GetChunkFrames() * pool.GetThreadCount());
+  std::chrono::steady_clock clock;
+  auto t_start = clock.now();
+  size_t done = 0;
+  while(!renderer.IsFinished() && done < totalsamples)
+    done += renderer.Render(buffer.data(), std::min(buffer.size(), totalsamples - done));
+  auto t = std::chrono::duration<double>(clock.now() - t_start).count();
+
+  std::cout << program_name << ": Playback " << config.time << "s (" << totalsamples << " samples) in chunks of " << renderer.GetChunkFrames() << " frames after "
+            << renderer.GetHistoryLength() << " frames of history in " << pool.GetThreadCount() << " threads: " << t << "s" << std::endl;
+  return true;
+}
+
+
+static bool BenchmarkVoices(const char * program_name, const json11::Json & json, const Configuration & config)
+{
+  fmsynth::VoiceEngine engine(config.voices);
+  if(!engine.Load(json, config.samples_per_second))
+    return false;
+  engine.SetControlPeriod(config.control_period);
+  engine.SetBlockSize(std::max(config.block_size, 1u));
+
+  auto totalsamples = static_cast<size_t>(config.time * config.samples_per_second);
+  std::vector<double> buffer(std::max(config.block_size, 1u));
+  std::chrono::steady_clock clock;
+  auto t_start = clock.now();
+  unsigned long triggered = 0;
+  for(size_t done = 0; done < totalsamples; done += buffer.size())
+    {
+      while(engine.GetActiveVoiceCount() < config.voices)
+        {
+          [[maybe_unused]] auto voice = engine.Trigger();
+          triggered++;
+        }
+      engine.Render(buffer.data(), std::min(buffer.size(), totalsamples - done));
+    }
+  auto t = std::chrono::duration<double>(clock.now() - t_start).count();
+
+  std::cout << program_name << ": Playback " << config.time << "s of " << config.voices << " voices (" << triggered << " triggered): " << t << "s, "
+            << config.time / t << "x real time" << std::endl;
+  return true;
+}
+
+
 int main(int argc, char * argv[])
 {
   auto cmdconf = ParseCommandline(argc, argv);
@@ -69,6 +203,25 @@ int main(int argc, char * argv[])
     return EXIT_FAILURE;
   auto config = cmdconf.value();
 
+  if(config.load_scaling)
+    {
+      BenchmarkLoadScaling(argv[0]);
+      return EXIT_SUCCESS;
+    }
+
+  {
+    using fmsynth::kernels::Isa;
+    bool isaok = false;
+    for(auto isa : { Isa::Reference, Isa::Generic, Isa::SSE2, Isa::AVX2, Isa::AVX512 })
+      if(fmsynth::kernels::IsaToName(isa) == config.isa)
+        isaok = fmsynth::kernels::SetIsa(isa);
+    if(!isaok)
+      {
+        std::cerr << argv[0] << ": Error, instruction set '" << config.isa << "' is not supported.\n";
+        return EXIT_FAILURE;
+      }
+  }
+
   auto [json, error] = fmsynth::util::LoadJsonFile(config.filename);
   if(!json)
     {
@@ -76,6 +229,16 @@ int main(int argc, char * argv[])
       return EXIT_FAILURE;
     }
 
+  if(config.voices > 0)
+    return BenchmarkVoices(argv[0], *json, config) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+  if(config.time_parallel && config.threads != 1 && config.block_size > 0)
+    {
+      if(BenchmarkTimeParallel(argv[0], *json, config))
+        return EXIT_SUCCESS;
+      std::cerr << argv[0] << ": Warning, the output depends on all of its history, running the independent nodes in the threads instead." << std::endl;
+    }
+
   std::chrono::steady_clock clock;
   auto t_start = clock.now();
 
@@ -88,15 +251,46 @@ int main(int argc, char * argv[])
 
   auto t = t_end - t_start;
   std::cout << argv[0] << ": Load '" << config.filename << "': " << std::chrono::duration<double>(t).count() << "s" << std::endl;
+  for(auto node : blueprint.GetUnscheduledNodes())
+    std::cerr << argv[0] << ": Warning, node " << node->GetId() << " (" << node->GetNodeType() << ") is not executed because it is in a cycle or gets input from one." << std::endl;
 
   auto totalsamples = static_cast<long>(config.time * config.samples_per_second);
 
   t_start = clock.now();
-  blueprint.Tick(totalsamples);
+  if(config.block_size > 0)
+    {
+      std::unique_ptr<fmsynth::ThreadPool> pool;
+      if(config.threads != 1)
+        {
+          pool = std::make_unique<fmsynth::ThreadPool>(config.threads);
+          blueprint.SetThreadPool(pool.get());
+        }
+      blueprint.SetControlPeriod(config.control_period);
+      auto program = blueprint.GetProgram();
+      size_t widest = 0;
+      for(const auto & level : program->GetLevels())
+        widest = std::max(widest, level.size());
+      std::cout << argv[0] << ": Program: " << program->GetSteps().size() << " steps in " << program->GetLevels().size() << " levels of up to " << widest << " steps, "
+                << program->GetControlSteps().size() << " control rate steps, "
+                << program->GetFoldedNodes().size() << " nodes folded into constants, "
+                << program->GetDeadNodes().size() << " unused nodes left out" << std::endl;
+      for(auto node : program->GetDeadNodes())
+        std::cout << argv[0] << ": Node " << program->GetNodeId(node) << " (" << program->GetNodeType(node) << ") is left out because it can not affect the output." << std::endl;
+
+      blueprint.SetBlockSize(config.block_size);
+      std::vector<double> buffer(blueprint.GetBlockSize());
+      long done = 0;
+      while(!blueprint.IsFinished() && done < totalsamples)
+        done += static_cast<long>(blueprint.Render(buffer.data(), std::min(buffer.size(), static_cast<size_t>(totalsamples - done))));
+    }
+  else
+    blueprint.Tick(totalsamples);
   t_end = clock.now();
 
   t = t_end - t_start;
   std::cout << argv[0] << ": Playback " << config.time << "s (" << totalsamples << " samples): " << std::chrono::duration<double>(t).count() << "s" << std::endl;
+  if(fmsynth::Wavetable::GetMemoryUsage() > 0)
+    std::cout << argv[0] << ": Wavetables: " << fmsynth::Wavetable::GetMemoryUsage() << " bytes" << std::endl;
   
   return EXIT_SUCCESS;
 }
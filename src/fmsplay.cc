@@ -16,24 +16,24 @@
 #include "RtAudio.hh"
 #include "StdFormat.hh"
 #include "Util.hh"
+#include "WavWriter.hh"
 #include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <latch>
 #include <optional>
 #include <cxxopts.hpp>
-#include <AudioFile.h>
 
 
 struct Configuration
 {
-  bool                verbose      = false;
-  bool                list_devices = false;
-  unsigned int        samples_per_second;
-  std::string         filename;
-  std::string         output_filename;
-  int                 output_device = -1;
-  AudioFile<double> * output_file   = nullptr;
+  bool                 verbose      = false;
+  bool                 list_devices = false;
+  unsigned int         samples_per_second;
+  std::string          filename;
+  std::string          output_filename;
+  int                  output_device = -1;
+  fmsynth::WavWriter * output_file   = nullptr;
 };
 
 static std::optional<Configuration> ParseCommandline(int argc, char * argv[])
@@ -156,9 +156,13 @@ int main(int argc, char * argv[])
         {
           if(config.verbose)
             std::cout << argv[0] << ": Writing to '" << config.output_filename << "'\n";
-          config.output_file = new AudioFile<double>();
+          config.output_file = new fmsynth::WavWriter();
           assert(config.output_file);
-          config.output_file->setSampleRate(config.samples_per_second);
+          if(!config.output_file->Open(config.output_filename, sample_rate))
+            {
+              std::cerr << argv[0] << ": Error, failed to open '" << config.output_filename << "' for writing." << std::endl;
+              return EXIT_FAILURE;
+            }
         }
       
       if(config.verbose)
@@ -187,14 +191,10 @@ int main(int argc, char * argv[])
   
       std::latch done{1};
 
-      adev.SetOnPostTick([&config, &adev, &done](double sample)
+      adev.SetOnPostTick([&config, &adev, &done](const double * samples, unsigned int frame_count)
       {
         if(config.output_file)
-          {
-            auto ind = config.output_file->samples[0u].size();
-            config.output_file->setNumSamplesPerChannel(static_cast<int>(ind + 1));
-            config.output_file->samples[0u][ind] = sample;
-          }
+          config.output_file->Write(samples, frame_count);
   
         if(adev.GetBlueprint()->IsFinished())
           done.count_down();
@@ -218,8 +218,11 @@ int main(int argc, char * argv[])
   
       done.wait();
   
-      if(config.output_file)
-        config.output_file->save(config.output_filename);
+      if(config.output_file && !config.output_file->Close())
+        {
+          std::cerr << argv[0] << ": Error, failed to write '" << config.output_filename << "'." << std::endl;
+          return EXIT_FAILURE;
+        }
     }
   
   return EXIT_SUCCESS;
@@ -11,25 +11,30 @@
 */
 
 #include "Blueprint.hh"
-#include "NodeAudioDeviceOutput.hh"
+#include "ChunkedRenderer.hh"
 #include "StdFormat.hh"
+#include "ThreadPool.hh"
 #include "Util.hh"
+#include "WavWriter.hh"
 #include <algorithm>
 #include <cassert>
 #include <filesystem>
 #include <iostream>
-#include <latch>
+#include <memory>
 #include <optional>
+#include <vector>
 #include <cxxopts.hpp>
-#include <AudioFile.h>
 
 
 struct Configuration
 {
-  bool         verbose      = false;
-  unsigned int samples_per_second;
-  std::string  filename;
-  std::string  output_filename;
+  bool                       verbose      = false;
+  unsigned int               samples_per_second;
+  fmsynth::WavWriter::Format format;
+  std::string                filename;
+  std::string                output_filename;
+  unsigned int               threads;
+  bool                       time_parallel;
 };
 
 static std::optional<Configuration> ParseCommandline(int argc, char * argv[])
@@ -41,6 +46,9 @@ static std::optional<Configuration> ParseCommandline(int argc, char * argv[])
   options.add_options()
     ("v,verbose",            "Verbose mode.",           cxxopts::value<bool>()->default_value("false"))
     ("s,samples-per-second", "Set samples per second.", cxxopts::value<unsigned int>()->default_value("44100"))
+    ("f,format",             "Sample format of the output: pcm16, pcm24 or float32.", cxxopts::value<std::string>()->default_value("pcm16"))
+    ("j,threads",            "Run the independent nodes in this many threads, 0 uses all the cores.", cxxopts::value<unsigned int>()->default_value("1"))
+    ("p,time-parallel",      "Render consecutive chunks of time in the threads when the output depends on a limited history.")
     ("i,input",              "Input filename.sbp",      cxxopts::value<std::string>())
     ("o,output",             "Output filename.wav",     cxxopts::value<std::string>())
     ("h,help",               "Print help (this text).")
@@ -50,6 +58,16 @@ static std::optional<Configuration> ParseCommandline(int argc, char * argv[])
   
   rv.verbose            = cmdline["verbose"].as<bool>();
   rv.samples_per_second = cmdline["samples-per-second"].as<unsigned int>();
+  rv.threads            = cmdline["threads"].as<unsigned int>();
+  rv.time_parallel      = cmdline.count("time-parallel") > 0;
+
+  auto format = fmsynth::WavWriter::GetFormatByName(cmdline["format"].as<std::string>());
+  if(!format.has_value())
+    {
+      std::cerr << argv[0] << ": Error, unknown format '" << cmdline["format"].as<std::string>() << "'.\n";
+      return std::nullopt;
+    }
+  rv.format             = format.value();
   
   if(cmdline.count("input") > 0)
     rv.filename         = cmdline["input"].as<std::string>();
@@ -103,7 +121,7 @@ int main(int argc, char * argv[])
   if(!loadok)
     return EXIT_FAILURE;
 
-  // Get list of AudioDeviceOutput nodes, and use the first one to obtain the samples:
+  // The output is the mix of the AudioDeviceOutput nodes:
   auto ados = blueprint.GetNodesByType("AudioDeviceOutput");
   if(ados.empty())
     {
@@ -112,33 +130,73 @@ int main(int argc, char * argv[])
     }
 
   blueprint.SetSamplesPerSecond(config.samples_per_second);
+
+  std::unique_ptr<fmsynth::ThreadPool> pool;
+  if(config.threads != 1)
+    {
+      pool = std::make_unique<fmsynth::ThreadPool>(config.threads);
+      if(config.verbose)
+        std::cout << argv[0] << ": Threads: " << pool->GetThreadCount() << std::endl;
+    }
+
+  std::unique_ptr<fmsynth::ChunkedRenderer> chunked;
+  if(config.time_parallel && pool)
+    {
+      chunked = std::make_unique<fmsynth::ChunkedRenderer>(*pool);
+      if(chunked->Load(*json, config.samples_per_second))
+        {
+          if(config.verbose)
+            std::cout << argv[0] << ": Rendering chunks of " << chunked->GetChunkFrames() << " frames, each after " << chunked->GetHistoryLength() << " frames of history" << std::endl;
+        }
+      else
+        {
+          std::cerr << argv[0] << ": Warning, the output depends on all of its history, rendering the nodes in the threads instead of the chunks of time.\n";
+          chunked.reset();
+        }
+    }
+
+  // The threads are woken up for each block, the longest blocks leave them the most work between the waits:
+  if(pool && !chunked)
+    {
+      blueprint.SetThreadPool(pool.get());
+      blueprint.SetBlockSize(fmsynth::Blueprint::MaxBlockSize);
+    }
       
   if(config.verbose)
     std::cout << argv[0] << ": Output file '" << config.output_filename << "'\n";
 
-  AudioFile<double> output_file{};
-  output_file.setSampleRate(config.samples_per_second);
-
-  // Setup callback for the AudioDeviceOutput node to save the sample:
-  double current_sample;
-  auto node = dynamic_cast<fmsynth::NodeAudioDeviceOutput *>(ados[0]);
-  node->SetOnPlaySample(
-                       [&current_sample](double sample)
-                       {
-                         current_sample = sample;
-                       }
-                       );
-
-  while(!blueprint.IsFinished())
+  fmsynth::WavWriter output_file{};
+  if(!output_file.Open(config.output_filename, config.samples_per_second, 1, config.format))
     {
-      blueprint.Tick(1); // Calls our callback, storing the sample to 'current_sample'.
+      std::cerr << argv[0] << ": Error, failed to open '" << config.output_filename << "' for writing.\n";
+      return EXIT_FAILURE;
+    }
 
-      auto ind = output_file.samples[0u].size();
-      output_file.setNumSamplesPerChannel(static_cast<int>(ind + 1));
-      output_file.samples[0u][ind] = current_sample;
+  // Render and write one buffer at a time, the memory use does not depend on the length of the output:
+  if(chunked)
+    {
+      std::vector<double> buffer(chunked->GetChunkFrames() * pool->GetThreadCount());
+      while(!chunked->IsFinished())
+        {
+          auto frames = chunked->Render(buffer.data(), buffer.size());
+          output_file.Write(buffer.data(), frames);
+        }
+    }
+  else
+    {
+      std::vector<double> buffer(fmsynth::Blueprint::MaxBlockSize);
+      while(!blueprint.IsFinished())
+        {
+          auto frames = blueprint.Render(buffer.data(), buffer.size());
+          output_file.Write(buffer.data(), frames);
+        }
     }
 
-  output_file.save(config.output_filename);
+  if(!output_file.Close())
+    {
+      std::cerr << argv[0] << ": Error, failed to write '" << config.output_filename << "'.\n";
+      return EXIT_FAILURE;
+    }
   
   return EXIT_SUCCESS;
 }